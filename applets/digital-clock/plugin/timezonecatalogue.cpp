@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "timezonecatalogue.h"
+#include "timezonesi18n.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimeZone>
+
+#include <KLocalizedString>
+
+#include <functional>
+
+// Bump whenever the contents of the cache file change
+static const quint32 s_cacheVersion = 1;
+
+namespace {
+
+QString cacheFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + QLatin1String("/plasma-digitalclock-timezones.cache");
+}
+
+QString tzdataVersion()
+{
+    // e.g. "# version 2020a", not every system ships this file
+    QString zoneInfoDir = QString::fromLocal8Bit(qgetenv("TZDIR"));
+    if (zoneInfoDir.isEmpty()) {
+        zoneInfoDir = QStringLiteral("/usr/share/zoneinfo");
+    }
+
+    QFile file(zoneInfoDir + QLatin1String("/tzdata.zi"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readLine().trimmed());
+}
+
+// Everything the translated catalogue depends on
+QString catalogueKey(const QList<QByteArray> &ids)
+{
+    QStringList key = KLocalizedString::languages();
+    key << QLocale().name() << QString::fromLatin1(qVersion()) << tzdataVersion();
+
+    QByteArray allIds;
+    for (const QByteArray &id : ids) {
+        allIds += id;
+        allIds += ' ';
+    }
+    key << QString::number(qHash(allIds));
+
+    return key.join(QLatin1Char('|'));
+}
+
+bool loadZones(const QString &key, QVector<TimeZoneData> &zones)
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version;
+    QString cachedKey;
+    stream >> version;
+    if (version != s_cacheVersion) {
+        return false;
+    }
+    stream >> cachedKey;
+    if (cachedKey != key) {
+        return false;
+    }
+
+    quint32 count;
+    stream >> count;
+    zones.reserve(count);
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        TimeZoneData data;
+        stream >> data.id >> data.region >> data.city >> data.comment >> data.searchText;
+        data.checked = false;
+        zones.append(data);
+    }
+
+    return stream.status() == QDataStream::Ok && quint32(zones.count()) == count;
+}
+
+void saveZones(const QString &key, const QVector<TimeZoneData> &zones)
+{
+    QDir().mkpath(QFileInfo(cacheFilePath()).absolutePath());
+
+    QSaveFile file(cacheFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_cacheVersion << key << quint32(zones.count());
+    for (const TimeZoneData &data : zones) {
+        stream << data.id << data.region << data.city << data.comment << data.searchText;
+    }
+    file.commit();
+}
+
+QVector<TimeZoneData> buildZones(const QList<QByteArray> &ids)
+{
+    TimezonesI18n timezonesI18n;
+
+    QStringList cities;
+    QHash<QString, QTimeZone> zonesByCity;
+
+    for (const QByteArray &id : ids) {
+        const QTimeZone zone(id);
+        const QStringList splitted = QString::fromUtf8(zone.id()).split(QStringLiteral("/"));
+
+        // CITY | COUNTRY | CONTINENT
+        const QString key = QStringLiteral("%1|%2|%3").arg(splitted.last(),
+                                                    QLocale::countryToString(zone.country()),
+                                                    splitted.first());
+
+        cities.append(key);
+        zonesByCity.insert(key, zone);
+    }
+    cities.sort(Qt::CaseInsensitive);
+
+    QVector<TimeZoneData> zones;
+    zones.reserve(cities.count());
+
+    for (const QString &key : qAsConst(cities)) {
+        const QTimeZone timeZone = zonesByCity.value(key);
+        QString comment = timeZone.comment();
+
+        if (!comment.isEmpty()) {
+            comment = i18n(comment.toUtf8());
+        }
+
+        const QStringList cityCountryContinent = key.split(QLatin1Char('|'));
+
+        TimeZoneData newData;
+        newData.id = timeZone.id();
+        newData.region = timeZone.country() == QLocale::AnyCountry ? QString()
+                                                                   : timezonesI18n.i18nContinents(cityCountryContinent.at(2)) + QLatin1Char('/') + timezonesI18n.i18nCountry(timeZone.country());
+        newData.city = timezonesI18n.i18nCity(cityCountryContinent.at(0));
+        newData.comment = comment;
+        newData.checked = false;
+        newData.searchText = TimeZoneCatalogue::searchText(newData.city + QLatin1Char('\n') + newData.region + QLatin1Char('\n') + newData.comment);
+        zones.append(newData);
+    }
+
+    return zones;
+}
+
+class CatalogueLoader : public QRunnable
+{
+public:
+    CatalogueLoader(TimeZoneCatalogue *catalogue, const std::function<void(const TimeZoneCatalogue::Zones &)> &callback)
+        : m_catalogue(catalogue)
+        , m_callback(callback)
+    {
+    }
+
+    void run() override
+    {
+        const QList<QByteArray> ids = QTimeZone::availableTimeZoneIds();
+        const QString key = catalogueKey(ids);
+
+        QVector<TimeZoneData> zones;
+        if (!loadZones(key, zones)) {
+            zones = buildZones(ids);
+            saveZones(key, zones);
+        }
+
+        const TimeZoneCatalogue::Zones result(new QVector<TimeZoneData>(std::move(zones)));
+        auto callback = m_callback;
+        QMetaObject::invokeMethod(m_catalogue, [callback, result] {
+            callback(result);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    TimeZoneCatalogue *m_catalogue;
+    std::function<void(const TimeZoneCatalogue::Zones &)> m_callback;
+};
+
+}
+
+TimeZoneCatalogue::TimeZoneCatalogue(QObject *parent)
+    : QObject(parent)
+{
+}
+
+TimeZoneCatalogue *TimeZoneCatalogue::self()
+{
+    static TimeZoneCatalogue *s_self = nullptr;
+    if (!s_self) {
+        // lives as long as the application, the loader reports back to it
+        s_self = new TimeZoneCatalogue(QCoreApplication::instance());
+    }
+    return s_self;
+}
+
+TimeZoneCatalogue::Zones TimeZoneCatalogue::zones()
+{
+    if (!m_zones && !m_loading) {
+        m_loading = true;
+        QThreadPool::globalInstance()->start(new CatalogueLoader(this, [this](const Zones &zones) {
+            setZones(zones);
+        }));
+    }
+    return m_zones;
+}
+
+void TimeZoneCatalogue::setZones(const Zones &zones)
+{
+    m_zones = zones;
+    m_loading = false;
+    emit loaded();
+}
+
+QString TimeZoneCatalogue::searchText(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString result;
+    result.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing) {
+            result.append(c);
+        }
+    }
+    return result.toCaseFolded();
+}
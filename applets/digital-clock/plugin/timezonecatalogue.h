@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026  agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TIMEZONECATALOGUE_H
+#define TIMEZONECATALOGUE_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "timezonedata.h"
+
+/**
+ * The localized list of all time zones, sorted by city.
+ *
+ * Translating and sorting several hundred zones is too slow for the GUI
+ * thread, so the list is built once on a worker thread and kept on disk
+ * for as long as the language and the time zone database stay the same.
+ */
+class TimeZoneCatalogue : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<const QVector<TimeZoneData>> Zones;
+
+    static TimeZoneCatalogue *self();
+
+    /**
+     * @return the time zones, or a null pointer while they are still
+     * being loaded, in which case loaded() will be emitted
+     */
+    Zones zones();
+
+    /**
+     * Folds case and strips accents so searches match regardless of them
+     */
+    static QString searchText(const QString &text);
+
+Q_SIGNALS:
+    void loaded();
+
+private:
+    explicit TimeZoneCatalogue(QObject *parent = nullptr);
+    void setZones(const Zones &zones);
+
+    Zones m_zones;
+    bool m_loading = false;
+};
+
+#endif // TIMEZONECATALOGUE_H
@@ -30,8 +30,8 @@ public:
     QString region;
     QString city;
     QString comment;
+    QString searchText; // city, region and comment, for filtering
     bool checked;
-    int offsetFromUtc;
 
 };
 
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "timezonemodel.h"
+#include "timezonecatalogue.h"
 #include "timezonesi18n.h"
 
 #include <QTimeZone>
@@ -28,7 +29,8 @@
 TimeZoneFilterProxy::TimeZoneFilterProxy(QObject *parent)
     : QSortFilterProxyModel(parent)
 {
-    m_stringMatcher.setCaseSensitivity(Qt::CaseInsensitive);
+    // both sides are case folded already
+    m_stringMatcher.setCaseSensitivity(Qt::CaseSensitive);
 }
 
 bool TimeZoneFilterProxy::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
@@ -37,22 +39,15 @@ bool TimeZoneFilterProxy::filterAcceptsRow(int source_row, const QModelIndex &so
         return true;
     }
 
-    const QString city = sourceModel()->index(source_row, 0, source_parent).data(TimeZoneModel::CityRole).toString();
-    const QString region = sourceModel()->index(source_row, 0, source_parent).data(TimeZoneModel::RegionRole).toString();
-    const QString comment = sourceModel()->index(source_row, 0, source_parent).data(TimeZoneModel::CommentRole).toString();
+    const QString searchText = sourceModel()->index(source_row, 0, source_parent).data(TimeZoneModel::SearchTextRole).toString();
 
-    if (m_stringMatcher.indexIn(city) != -1 || m_stringMatcher.indexIn(region) != -1 ||
-        m_stringMatcher.indexIn(comment) != -1) {
-        return true;
-    }
-
-    return false;
+    return m_stringMatcher.indexIn(searchText) != -1;
 }
 
 void TimeZoneFilterProxy::setFilterString(const QString &filterString)
 {
     m_filterString = filterString;
-    m_stringMatcher.setPattern(filterString);
+    m_stringMatcher.setPattern(TimeZoneCatalogue::searchText(filterString));
     emit filterStringChanged();
     invalidateFilter();
 }
@@ -60,9 +55,9 @@ void TimeZoneFilterProxy::setFilterString(const QString &filterString)
 //=============================================================================
 
 TimeZoneModel::TimeZoneModel(QObject *parent)
-    : QAbstractListModel(parent),
-      m_timezonesI18n(new TimezonesI18n(this))
+    : QAbstractListModel(parent)
 {
+    connect(TimeZoneCatalogue::self(), &TimeZoneCatalogue::loaded, this, &TimeZoneModel::update);
     update();
 }
 
@@ -79,7 +74,7 @@ int TimeZoneModel::rowCount(const QModelIndex &parent) const
 QVariant TimeZoneModel::data(const QModelIndex &index, int role) const
 {
     if (index.isValid()) {
-        TimeZoneData currentData = m_data.at(index.row());
+        const TimeZoneData &currentData = m_data.at(index.row());
 
         switch(role) {
         case TimeZoneIdRole:
@@ -92,6 +87,8 @@ QVariant TimeZoneModel::data(const QModelIndex &index, int role) const
             return currentData.comment;
         case CheckedRole:
             return currentData.checked;
+        case SearchTextRole:
+            return currentData.searchText;
         }
     }
 
@@ -110,7 +107,7 @@ bool TimeZoneModel::setData(const QModelIndex &index, const QVariant &value, int
 
         if (m_data[index.row()].checked) {
             m_selectedTimeZones.append(m_data[index.row()].id);
-            m_offsetData.insert(m_data[index.row()].id, m_data[index.row()].offsetFromUtc);
+            updateOffset(m_data[index.row()].id);
         } else {
             m_selectedTimeZones.removeAll(m_data[index.row()].id);
             m_offsetData.remove(m_data[index.row()].id);
@@ -127,71 +124,57 @@ bool TimeZoneModel::setData(const QModelIndex &index, const QVariant &value, int
 
 void TimeZoneModel::update()
 {
+    // Filled in once the catalogue has been loaded in the background
+    const TimeZoneCatalogue::Zones zones = TimeZoneCatalogue::self()->zones();
+    if (!zones) {
+        return;
+    }
+
     beginResetModel();
     m_data.clear();
+    m_data.reserve(zones->count() + 1);
 
-    QTimeZone localZone = QTimeZone(QTimeZone::systemTimeZoneId());
-    const QStringList data = QString::fromUtf8(localZone.id()).split(QLatin1Char('/'));
+    const QString systemTimeZoneId = QString::fromUtf8(QTimeZone::systemTimeZoneId());
 
     TimeZoneData local;
     local.id = QStringLiteral("Local");
     local.region = i18nc("This means \"Local Timezone\"", "Local");
-    local.city = m_timezonesI18n->i18nCity(data.last());
     local.comment = i18n("Your system time zone");
-    local.checked = false;
+    local.checked = m_selectedTimeZones.contains(local.id);
 
     m_data.append(local);
 
-    QStringList cities;
-    QHash<QString, QTimeZone> zonesByCity;
-
-    const QList<QByteArray> systemTimeZones = QTimeZone::availableTimeZoneIds();
-
-    for (auto it = systemTimeZones.constBegin(); it != systemTimeZones.constEnd(); ++it) {
-        const QTimeZone zone(*it);
-        const QStringList splitted = QString::fromUtf8(zone.id()).split(QStringLiteral("/"));
+    for (const TimeZoneData &zone : *zones) {
+        m_data.append(zone);
 
-        // CITY | COUNTRY | CONTINENT
-        const QString key = QStringLiteral("%1|%2|%3").arg(splitted.last(),
-                                                    QLocale::countryToString(zone.country()),
-                                                    splitted.first());
-
-        cities.append(key);
-        zonesByCity.insert(key, zone);
-    }
-    cities.sort(Qt::CaseInsensitive);
+        TimeZoneData &newData = m_data.last();
+        newData.checked = m_selectedTimeZones.contains(newData.id);
 
-    Q_FOREACH (const QString &key, cities) {
-        const QTimeZone timeZone = zonesByCity.value(key);
-        QString comment = timeZone.comment();
-
-        if (!comment.isEmpty()) {
-            comment = i18n(comment.toUtf8());
+        if (newData.id == systemTimeZoneId) {
+            m_data[0].city = newData.city;
         }
+    }
 
-        const QStringList cityCountryContinent = key.split(QLatin1Char('|'));
-
-        TimeZoneData newData;
-        newData.id = timeZone.id();
-        newData.region = timeZone.country() == QLocale::AnyCountry ? QString()
-                                                                   : m_timezonesI18n->i18nContinents(cityCountryContinent.at(2)) + QLatin1Char('/') + m_timezonesI18n->i18nCountry(timeZone.country());
-        newData.city = m_timezonesI18n->i18nCity(cityCountryContinent.at(0));
-        newData.comment = comment;
-        newData.checked = false;
-        newData.offsetFromUtc = timeZone.offsetFromUtc(QDateTime::currentDateTimeUtc());
-        m_data.append(newData);
+    // the system zone may be an alias or a zone the catalogue doesn't list
+    if (m_data[0].city.isEmpty()) {
+        TimezonesI18n timezonesI18n;
+        m_data[0].city = timezonesI18n.i18nCity(systemTimeZoneId.split(QLatin1Char('/')).last());
     }
 
+    m_data[0].searchText = TimeZoneCatalogue::searchText(m_data[0].city + QLatin1Char('\n') + local.region + QLatin1Char('\n') + local.comment);
+
     endResetModel();
 }
 
 void TimeZoneModel::setSelectedTimeZones(const QStringList &selectedTimeZones)
 {
     m_selectedTimeZones = selectedTimeZones;
+    for (const QString &id : selectedTimeZones) {
+        updateOffset(id);
+    }
     for (int i = 0; i < m_data.size(); i++) {
         if (m_selectedTimeZones.contains(m_data.at(i).id)) {
             m_data[i].checked = true;
-            m_offsetData.insert(m_data[i].id, m_data[i].offsetFromUtc);
 
             QModelIndex index = createIndex(i, 0);
             emit dataChanged(index, index);
@@ -203,12 +186,16 @@ void TimeZoneModel::setSelectedTimeZones(const QStringList &selectedTimeZones)
 
 void TimeZoneModel::selectLocalTimeZone()
 {
-    m_data[0].checked = true;
+    // Without data yet, update() picks it up from the selection
+    if (!m_data.isEmpty()) {
+        m_data[0].checked = true;
 
-    QModelIndex index = createIndex(0, 0);
-    emit dataChanged(index, index);
+        QModelIndex index = createIndex(0, 0);
+        emit dataChanged(index, index);
+    }
 
-    m_selectedTimeZones << m_data[0].id;
+    m_selectedTimeZones << QStringLiteral("Local");
+    updateOffset(m_selectedTimeZones.last());
     emit selectedTimeZonesChanged();
 }
 
@@ -230,3 +217,10 @@ void TimeZoneModel::sortTimeZones()
                   return m_offsetData.value(a) < m_offsetData.value(b);
               });
 }
+
+void TimeZoneModel::updateOffset(const QString &id)
+{
+    // Only needed for the few selected zones, and it changes with DST
+    const QTimeZone zone = id == QLatin1String("Local") ? QTimeZone::systemTimeZone() : QTimeZone(id.toUtf8());
+    m_offsetData.insert(id, zone.offsetFromUtc(QDateTime::currentDateTimeUtc()));
+}
@@ -26,8 +26,6 @@
 
 #include "timezonedata.h"
 
-class TimezonesI18n;
-
 class TimeZoneFilterProxy : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -44,7 +42,7 @@ Q_SIGNALS:
 
 private:
     QString m_filterString;
-    QStringMatcher m_stringMatcher;
+    QStringMatcher m_stringMatcher; // matches TimeZoneModel::SearchTextRole
 };
 
 //=============================================================================
@@ -63,7 +61,8 @@ public:
         RegionRole,
         CityRole,
         CommentRole,
-        CheckedRole
+        CheckedRole,
+        SearchTextRole // not exposed to QML
     };
 
     int rowCount(const QModelIndex &parent) const override;
@@ -83,11 +82,11 @@ protected:
 
 private:
     void sortTimeZones();
+    void updateOffset(const QString &id);
 
     QList<TimeZoneData> m_data;
     QHash<QString, int> m_offsetData; // used for sorting
     QStringList m_selectedTimeZones;
-    TimezonesI18n *m_timezonesI18n;
 };
 
 #endif // TIMEZONEMODEL_H
@@ -20,6 +20,7 @@
 #include <config-workspace.h>
 #include "appentry.h"
 #include "actionlist.h"
+#include "appscatalogue.h"
 #include "appsmodel.h"
 #include "containmentinterface.h"
 
@@ -28,7 +29,6 @@
 #include <QProcess>
 #include <QQmlPropertyMap>
 #include <QStandardPaths>
-#include <QFileInfo>
 #if HAVE_X11
 #include <QX11Info>
 #endif
@@ -50,79 +50,76 @@
 
 AppEntry::AppEntry(AbstractModel *owner, KService::Ptr service, NameFormat nameFormat)
 : AbstractEntry(owner)
-, m_service(service)
+, m_catalogue(AppsCatalogue::instance())
+, m_nameFormat(toNameFormat(nameFormat))
 {
-    if (m_service) {
-        init(nameFormat);
+    if (service) {
+        m_app = m_catalogue->app(service);
     }
 }
 
 AppEntry::AppEntry(AbstractModel *owner, const QString &id) : AbstractEntry(owner)
+, m_catalogue(AppsCatalogue::instance())
+, m_nameFormat(toNameFormat(owner->rootModel()->property("appNameFormat").toInt()))
 {
     const QUrl url(id);
+    KService::Ptr service;
 
     if (url.scheme() == QLatin1String("preferred")) {
-        m_service = defaultAppByName(url.host());
+        service = defaultAppByName(url.host());
         m_id = id;
         m_con = QObject::connect(KSycoca::self(), QOverload<>::of(&KSycoca::databaseChanged), owner, [this, owner, id](){
             KSharedConfig::openConfig()->reparseConfiguration();
-            m_service = defaultAppByName(QUrl(id).host());
-            if (m_service) {
-                init((NameFormat)owner->rootModel()->property("appNameFormat").toInt());
-                m_icon = QIcon();
+            const KService::Ptr service = defaultAppByName(QUrl(id).host());
+            if (service) {
+                m_nameFormat = toNameFormat(owner->rootModel()->property("appNameFormat").toInt());
+                m_app = m_catalogue->app(service);
                 Q_EMIT owner->layoutChanged();
             }
         });
     } else {
-        m_service = KService::serviceByStorageId(id);
+        service = KService::serviceByStorageId(id);
     }
 
-    if (m_service) {
-        init((NameFormat)owner->rootModel()->property("appNameFormat").toInt());
-    }
-}
-
-void AppEntry::init(NameFormat nameFormat)
-{
-    m_name = nameFromService(m_service, nameFormat);
-
-    if (nameFormat == GenericNameOnly) {
-        m_description = nameFromService(m_service, NameOnly);
-    } else {
-        m_description = nameFromService(m_service, GenericNameOnly);
+    if (service) {
+        m_app = m_catalogue->app(service);
     }
 }
 
 bool AppEntry::isValid() const
 {
-    return m_service;
+    return !m_app.isNull();
 }
 
 QIcon AppEntry::icon() const
 {
-    if (m_icon.isNull()) {
-        if (QFileInfo::exists(m_service->icon())) {
-            m_icon = QIcon(m_service->icon());
-        } else {
-            m_icon = QIcon::fromTheme(m_service->icon(), QIcon::fromTheme(QStringLiteral("unknown")));
-        }
+    if (!m_app) {
+        return QIcon();
     }
-    return m_icon;
+
+    if (m_app->icon.isNull()) {
+        m_app->icon = m_catalogue->icon(m_app->service->icon());
+    }
+    return m_app->icon;
 }
 
 QString AppEntry::name() const
 {
-    return m_name;
+    return m_app ? m_app->names[m_nameFormat] : QString();
 }
 
 QString AppEntry::description() const
 {
-    return m_description;
+    if (!m_app) {
+        return QString();
+    }
+
+    return m_app->names[m_nameFormat == GenericNameOnly ? NameOnly : GenericNameOnly];
 }
 
 KService::Ptr AppEntry::service() const
 {
-    return m_service;
+    return m_app ? m_app->service : KService::Ptr();
 }
 
 QString AppEntry::id() const
@@ -131,17 +128,17 @@ QString AppEntry::id() const
         return m_id;
     }
 
-    return m_service->storageId();
+    return service()->storageId();
 }
 
 QString AppEntry::menuId() const
 {
-    return m_service->menuId();
+    return service()->menuId();
 }
 
 QUrl AppEntry::url() const
 {
-    return QUrl::fromLocalFile(Kicker::resolvedServiceEntryPath(m_service));
+    return QUrl::fromLocalFile(Kicker::resolvedServiceEntryPath(service()));
 }
 
 bool AppEntry::hasActions() const
@@ -153,7 +150,7 @@ QVariantList AppEntry::actions() const
 {
     QVariantList actionList;
 
-    actionList << Kicker::jumpListActions(m_service);
+    actionList << Kicker::jumpListActions(service());
     if (!actionList.isEmpty()) {
         actionList << Kicker::createSeparatorActionItem();
     }
@@ -165,13 +162,13 @@ QVariantList AppEntry::actions() const
         systemImmutable = (appletInterface->property("immutability").toInt() == Plasma::Types::SystemImmutable);
     }
 
-    const QVariantList &addLauncherActions = Kicker::createAddLauncherActionList(appletInterface, m_service);
+    const QVariantList &addLauncherActions = Kicker::createAddLauncherActionList(appletInterface, service());
     if (!systemImmutable && !addLauncherActions.isEmpty()) {
         actionList << addLauncherActions
                    << Kicker::createSeparatorActionItem();
     }
 
-    const QVariantList &recentDocuments = Kicker::recentDocumentActions(m_service);
+    const QVariantList &recentDocuments = Kicker::recentDocumentActions(service());
     if (!recentDocuments.isEmpty()) {
         actionList << recentDocuments << Kicker::createSeparatorActionItem();
     }
@@ -182,10 +179,10 @@ QVariantList AppEntry::actions() const
         return actionList;
     }
 
-    if (m_service->isApplication()) {
+    if (service()->isApplication()) {
         actionList << Kicker::createSeparatorActionItem();
-        actionList << Kicker::editApplicationAction(m_service);
-        actionList << Kicker::appstreamActions(m_service);
+        actionList << Kicker::editApplicationAction(service());
+        actionList << Kicker::appstreamActions(service());
     }
 
     if (appletInterface) {
@@ -194,7 +191,7 @@ QVariantList AppEntry::actions() const
         if (appletConfig && appletConfig->contains(QLatin1String("hiddenApplications")) && qobject_cast<AppsModel *>(m_owner)) {
             const QStringList &hiddenApps = appletConfig->value(QLatin1String("hiddenApplications")).toStringList();
 
-            if (!hiddenApps.contains(m_service->menuId())) {
+            if (!hiddenApps.contains(service()->menuId())) {
                 QVariantMap hideAction = Kicker::createActionItem(i18n("Hide Application"), QStringLiteral("view-hidden"), QStringLiteral("hideApplication"));
                 actionList << hideAction;
             }
@@ -206,7 +203,7 @@ QVariantList AppEntry::actions() const
 
 bool AppEntry::run(const QString& actionId, const QVariant &argument)
 {
-    if (!m_service->isValid()) {
+    if (!service()->isValid()) {
         return false;
     }
 
@@ -219,13 +216,13 @@ bool AppEntry::run(const QString& actionId, const QVariant &argument)
         }
 #endif
 
-        auto *job = new KIO::ApplicationLauncherJob(m_service);
+        auto *job = new KIO::ApplicationLauncherJob(service());
         job->setUiDelegate(new KNotificationJobUiDelegate(KJobUiDelegate::AutoHandlingEnabled));
         job->setRunFlags(KIO::ApplicationLauncherJob::DeleteTemporaryFiles);
         job->setStartupId(KStartupInfo::createNewStartupIdForTimestamp(timeStamp));
         job->start();
 
-        KActivities::ResourceInstance::notifyAccessed(QUrl(QStringLiteral("applications:") + m_service->storageId()),
+        KActivities::ResourceInstance::notifyAccessed(QUrl(QStringLiteral("applications:") + service()->storageId()),
                 QStringLiteral("org.kde.plasma.kicker"));
 
         return true;
@@ -233,17 +230,17 @@ bool AppEntry::run(const QString& actionId, const QVariant &argument)
 
     QObject *appletInterface = m_owner->rootModel()->property("appletInterface").value<QObject *>();
 
-    if (Kicker::handleAddLauncherAction(actionId, appletInterface, m_service)) {
+    if (Kicker::handleAddLauncherAction(actionId, appletInterface, service())) {
         return true;
-    } else if (Kicker::handleEditApplicationAction(actionId, m_service)) {
+    } else if (Kicker::handleEditApplicationAction(actionId, service())) {
         return true;
     } else if (Kicker::handleAppstreamActions(actionId, argument)) {
         return true;
     } else if (actionId == QLatin1String("_kicker_jumpListAction")) {
-        return KRun::run(argument.toString(), {}, nullptr, m_service->name(), m_service->icon());
+        return KRun::run(argument.toString(), {}, nullptr, service()->name(), service()->icon());
     }
 
-    return Kicker::handleRecentDocumentAction(m_service, actionId, argument);
+    return Kicker::handleRecentDocumentAction(service(), actionId, argument);
 }
 
 QString AppEntry::nameFromService(const KService::Ptr service, NameFormat nameFormat)
@@ -266,6 +263,15 @@ QString AppEntry::nameFromService(const KService::Ptr service, NameFormat nameFo
     }
 }
 
+AppEntry::NameFormat AppEntry::toNameFormat(int format)
+{
+    if (format < NameOnly || format > GenericNameAndName) {
+        return GenericNameAndName;
+    }
+
+    return static_cast<NameFormat>(format);
+}
+
 KService::Ptr AppEntry::defaultAppByName(const QString& name)
 {
     if (name == QLatin1String("browser")) {
@@ -292,28 +298,29 @@ AppEntry::~AppEntry() {
 
 AppGroupEntry::AppGroupEntry(AppsModel *parentModel, KServiceGroup::Ptr group,
     bool paginate, int pageSize, bool flat, bool sorted, bool separators, int appNameFormat) : AbstractGroupEntry(parentModel),
-    m_group(group)
+    m_group(group),
+    m_parentModel(parentModel),
+    m_paginate(paginate),
+    m_pageSize(pageSize),
+    m_flat(flat),
+    m_sorted(sorted),
+    m_separators(separators),
+    m_appNameFormat(appNameFormat),
+    m_catalogue(AppsCatalogue::instance())
 {
-    AppsModel* model = new AppsModel(group->entryPath(), paginate, pageSize, flat,
-        sorted, separators, parentModel);
-    model->setAppNameFormat(appNameFormat);
-    m_childModel = model;
-
-    QObject::connect(parentModel, &AppsModel::cleared, model, &AppsModel::deleteLater);
-
-    QObject::connect(model, &AppsModel::countChanged,
-        [parentModel, this] { if (parentModel) { parentModel->entryChanged(this); } }
-    );
+}
 
-    QObject::connect(model, &AppsModel::hiddenEntriesChanged,
-        [parentModel, this] { if (parentModel) { parentModel->entryChanged(this); } }
-    );
+AppGroupEntry::~AppGroupEntry()
+{
+    if (m_childModel) {
+        m_childModel->deleteLater();
+    }
 }
 
 QIcon AppGroupEntry::icon() const
 {
     if (m_icon.isNull()) {
-        m_icon = QIcon::fromTheme(m_group->icon(), QIcon::fromTheme(QStringLiteral("unknown")));
+        m_icon = m_catalogue->icon(m_group->icon());
     }
     return m_icon;
 }
@@ -325,9 +332,70 @@ QString AppGroupEntry::name() const
 
 bool AppGroupEntry::hasChildren() const
 {
-    return m_childModel && m_childModel->count() > 0;
+    if (m_childModel) {
+        return m_childModel->count() > 0;
+    }
+
+    // childCount() also counts hidden and NoDisplay entries, ask what the
+    // child model would show instead.
+    if (m_parentModel) {
+        return m_parentModel->hasVisibleEntries(m_group->entryPath(), m_flat);
+    }
+
+    return m_group->childCount() > 0;
 }
 
 AbstractModel *AppGroupEntry::childModel() const {
+    // The submenu is only walked once somebody asks for it.
+    if (!m_childModel && m_parentModel) {
+        AppsModel *model = new AppsModel(m_group->entryPath(), m_paginate, m_pageSize, m_flat,
+            m_sorted, m_separators, m_parentModel);
+        model->setAppNameFormat(m_appNameFormat);
+        m_childModel = model;
+
+        AppsModel *parentModel = m_parentModel;
+        AppGroupEntry *entry = const_cast<AppGroupEntry *>(this);
+
+        QObject::connect(model, &AppsModel::countChanged,
+            [parentModel, entry] { if (parentModel) { parentModel->entryChanged(entry); } }
+        );
+
+        QObject::connect(model, &AppsModel::hiddenEntriesChanged,
+            [parentModel, entry] { if (parentModel) { parentModel->entryChanged(entry); } }
+        );
+    }
+
     return m_childModel;
 }
+
+bool AppGroupEntry::hasChildModel() const
+{
+    return !m_childModel.isNull();
+}
+
+KServiceGroup::Ptr AppGroupEntry::group() const
+{
+    return m_group;
+}
+
+QString AppGroupEntry::entryPath() const
+{
+    return m_group->entryPath();
+}
+
+bool AppGroupEntry::applySycocaChanges(KServiceGroup::Ptr group)
+{
+    const bool changed = (group->caption() != m_group->caption() || group->icon() != m_group->icon());
+
+    m_group = group;
+
+    if (changed) {
+        m_icon = QIcon();
+    }
+
+    if (m_childModel) {
+        m_childModel->applySycocaChanges();
+    }
+
+    return changed;
+}
@@ -21,6 +21,7 @@
 #define APPENTRY_H
 
 #include "abstractentry.h"
+#include "appscatalogue.h"
 
 #include <KService>
 #include <KServiceGroup>
@@ -62,16 +63,18 @@ class AppEntry : public AbstractEntry
         QString menuId() const;
 
         static QString nameFromService(const KService::Ptr service, NameFormat nameFormat);
+        /**
+         * @p format as a NameFormat. Values outside the enum get the
+         * GenericNameAndName formatting, as nameFromService() gives them.
+         */
+        static NameFormat toNameFormat(int format);
         static KService::Ptr defaultAppByName(const QString &name);
 
     private:
-        void init(NameFormat nameFormat);
-
         QString m_id;
-        QString m_name;
-        QString m_description;
-        mutable QIcon m_icon;
-        KService::Ptr m_service;
+        QSharedPointer<AppsCatalogue> m_catalogue;
+        QSharedPointer<AppsCatalogue::App> m_app;
+        NameFormat m_nameFormat;
         static MenuEntryEditor *m_menuEntryEditor;
         QMetaObject::Connection m_con;
 };
@@ -81,6 +84,7 @@ class AppGroupEntry : public AbstractGroupEntry
     public:
         AppGroupEntry(AppsModel *parentModel, KServiceGroup::Ptr group,
             bool paginate, int pageSize, bool flat, bool sorted, bool separators, int appNameFormat);
+        ~AppGroupEntry() override;
 
         QIcon icon() const override;
         QString name() const override;
@@ -88,10 +92,31 @@ class AppGroupEntry : public AbstractGroupEntry
         bool hasChildren() const override;
         AbstractModel *childModel() const override;
 
+        bool hasChildModel() const;
+
+        KServiceGroup::Ptr group() const;
+        QString entryPath() const;
+
+        /**
+         * Takes over @p group after a sycoca change and brings the child model
+         * up to date, if it has been created yet.
+         *
+         * @returns whether the caption or icon changed
+         */
+        bool applySycocaChanges(KServiceGroup::Ptr group);
+
     private:
         KServiceGroup::Ptr m_group;
+        QPointer<AppsModel> m_parentModel;
+        bool m_paginate;
+        int m_pageSize;
+        bool m_flat;
+        bool m_sorted;
+        bool m_separators;
+        int m_appNameFormat;
+        QSharedPointer<AppsCatalogue> m_catalogue;
         mutable QIcon m_icon;
-        QPointer<AbstractModel> m_childModel;
+        mutable QPointer<AppsModel> m_childModel;
 };
 
 #endif
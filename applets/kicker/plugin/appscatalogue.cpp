@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "appscatalogue.h"
+#include "appentry.h"
+
+#include <QFileInfo>
+#include <QTimer>
+
+#include <KSycoca>
+
+AppsCatalogue::AppsCatalogue() : QObject()
+, m_changeTimer(new QTimer(this))
+{
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(100);
+    connect(m_changeTimer, &QTimer::timeout, this, &AppsCatalogue::clear);
+
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
+}
+
+AppsCatalogue::~AppsCatalogue()
+{
+}
+
+QSharedPointer<AppsCatalogue> AppsCatalogue::instance()
+{
+    static QWeakPointer<AppsCatalogue> s_instance;
+
+    QSharedPointer<AppsCatalogue> catalogue = s_instance.toStrongRef();
+
+    if (!catalogue) {
+        catalogue.reset(new AppsCatalogue());
+        s_instance = catalogue;
+    }
+
+    return catalogue;
+}
+
+KServiceGroup::Ptr AppsCatalogue::group(const QString &entryPath)
+{
+    auto it = m_groups.constFind(entryPath);
+
+    if (it == m_groups.constEnd()) {
+        it = m_groups.insert(entryPath, entryPath.isEmpty() ? KServiceGroup::root() : KServiceGroup::group(entryPath));
+    }
+
+    return *it;
+}
+
+bool AppsCatalogue::hasSubGroups(const QString &entryPath)
+{
+    auto it = m_hasSubGroups.constFind(entryPath);
+
+    if (it != m_hasSubGroups.constEnd()) {
+        return *it;
+    }
+
+    bool hasSubGroups = false;
+    const KServiceGroup::Ptr serviceGroup = group(entryPath);
+
+    if (serviceGroup && serviceGroup->isValid()) {
+        foreach(KServiceGroup::Ptr subGroup, serviceGroup->groupEntries(KServiceGroup::ExcludeNoDisplay)) {
+            if (subGroup->childCount() > 0) {
+                hasSubGroups = true;
+
+                break;
+            }
+        }
+    }
+
+    m_hasSubGroups.insert(entryPath, hasSubGroups);
+
+    return hasSubGroups;
+}
+
+KServiceGroup::List AppsCatalogue::entries(const QString &entryPath, bool allowSeparators, bool sortByGenericName)
+{
+    const QString key = QString::number(allowSeparators) + QString::number(sortByGenericName) + entryPath;
+
+    auto it = m_entries.constFind(key);
+
+    if (it != m_entries.constEnd()) {
+        return *it;
+    }
+
+    KServiceGroup::List list;
+    const KServiceGroup::Ptr serviceGroup = group(entryPath);
+
+    if (serviceGroup && serviceGroup->isValid()) {
+        list = serviceGroup->entries(true /* sorted */, true /* excludeNoDisplay */,
+            allowSeparators, sortByGenericName);
+    }
+
+    m_entries.insert(key, list);
+
+    return list;
+}
+
+QSharedPointer<AppsCatalogue::App> AppsCatalogue::app(const KService::Ptr &service)
+{
+    auto it = m_apps.constFind(service->storageId());
+
+    if (it == m_apps.constEnd()) {
+        QSharedPointer<App> app(new App);
+        app->service = service;
+
+        for (int format = AppEntry::NameOnly; format <= AppEntry::GenericNameAndName; ++format) {
+            app->names[format] = AppEntry::nameFromService(service, static_cast<AppEntry::NameFormat>(format));
+        }
+
+        it = m_apps.insert(service->storageId(), app);
+    }
+
+    return *it;
+}
+
+QIcon AppsCatalogue::icon(const QString &iconName)
+{
+    auto it = m_icons.constFind(iconName);
+
+    if (it == m_icons.constEnd()) {
+        QIcon icon;
+
+        if (QFileInfo::exists(iconName)) {
+            icon = QIcon(iconName);
+        } else {
+            icon = QIcon::fromTheme(iconName, QIcon::fromTheme(QStringLiteral("unknown")));
+        }
+
+        it = m_icons.insert(iconName, icon);
+    }
+
+    return *it;
+}
+
+void AppsCatalogue::checkSycocaChanges(const QStringList &changes)
+{
+    if (changes.contains(QLatin1String("services")) || changes.contains(QLatin1String("apps")) || changes.contains(QLatin1String("xdgdata-apps"))) {
+        m_changeTimer->start();
+    }
+}
+
+void AppsCatalogue::clear()
+{
+    m_groups.clear();
+    m_hasSubGroups.clear();
+    m_entries.clear();
+    m_apps.clear();
+    m_icons.clear();
+
+    emit changed();
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef APPSCATALOGUE_H
+#define APPSCATALOGUE_H
+
+#include <QHash>
+#include <QIcon>
+#include <QObject>
+#include <QSharedPointer>
+
+#include <KService>
+#include <KServiceGroup>
+
+class QTimer;
+
+/**
+ * The application menu as read from sycoca, shared by all application
+ * models of the process.
+ *
+ * Kicker, Kickoff, the Application Dashboard and the Application Menu each
+ * keep their own model tree with its own presentation options. The rows of
+ * those trees are thin views on the records kept here: the menu walk, the
+ * services with their formatted names and the icons are only looked up once
+ * and dropped again once per sycoca change.
+ */
+class AppsCatalogue : public QObject
+{
+    Q_OBJECT
+
+    public:
+        /**
+         * What the entries of one application share, whichever model or
+         * applet they are shown in.
+         */
+        struct App {
+            KService::Ptr service;
+            /** The name in each AppEntry::NameFormat */
+            QString names[4];
+            /** Loaded on first use */
+            QIcon icon;
+        };
+
+        ~AppsCatalogue() override;
+
+        /**
+         * The catalogue of the process. It is created on first use and
+         * freed once the last model or entry holding it is gone.
+         */
+        static QSharedPointer<AppsCatalogue> instance();
+
+        /**
+         * The menu group at @p entryPath, the root menu for an empty path.
+         */
+        KServiceGroup::Ptr group(const QString &entryPath);
+
+        /**
+         * Whether the menu group at @p entryPath has submenus with entries.
+         */
+        bool hasSubGroups(const QString &entryPath);
+
+        /**
+         * The sorted, visible entries of the menu group at @p entryPath.
+         */
+        KServiceGroup::List entries(const QString &entryPath, bool allowSeparators, bool sortByGenericName);
+
+        /**
+         * The shared record of @p service, with its names formatted by
+         * AppEntry::nameFromService().
+         */
+        QSharedPointer<App> app(const KService::Ptr &service);
+
+        QIcon icon(const QString &iconName);
+
+    Q_SIGNALS:
+        /**
+         * Emitted once the applications changed in sycoca and the cached
+         * data was dropped.
+         */
+        void changed() const;
+
+    private Q_SLOTS:
+        void checkSycocaChanges(const QStringList &changes);
+        void clear();
+
+    private:
+        AppsCatalogue();
+
+        QHash<QString, KServiceGroup::Ptr> m_groups;
+        QHash<QString, bool> m_hasSubGroups;
+        QHash<QString, KServiceGroup::List> m_entries;
+        QHash<QString, QSharedPointer<App>> m_apps;
+        QHash<QString, QIcon> m_icons;
+        QTimer *m_changeTimer;
+};
+
+#endif
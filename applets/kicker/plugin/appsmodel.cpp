@@ -25,10 +25,10 @@
 #include <QCollator>
 #include <QDebug>
 #include <QQmlPropertyMap>
+#include <QSet>
 #include <QTimer>
 
 #include <KLocalizedString>
-#include <KSycoca>
 
 AppsModel::AppsModel(const QString &entryPath, bool paginate, int pageSize, bool flat,
     bool sorted, bool separators, QObject *parent)
@@ -45,7 +45,7 @@ AppsModel::AppsModel(const QString &entryPath, bool paginate, int pageSize, bool
 , m_description(i18n("Applications"))
 , m_entryPath(entryPath)
 , m_staticEntryList(false)
-, m_changeTimer(nullptr)
+, m_catalogue(AppsCatalogue::instance())
 , m_flat(flat)
 , m_sorted(sorted)
 , m_appNameFormat(AppEntry::NameOnly)
@@ -69,26 +69,25 @@ AppsModel::AppsModel(const QList<AbstractEntry *> entryList, bool deleteEntriesO
 , m_description(i18n("Applications"))
 , m_entryPath(QString())
 , m_staticEntryList(true)
-, m_changeTimer(nullptr)
+, m_catalogue(AppsCatalogue::instance())
 , m_flat(true)
 , m_sorted(true)
 , m_appNameFormat(AppEntry::NameOnly)
 {
+    QSet<QString> storageIds;
+
     foreach(AbstractEntry *suggestedEntry, entryList) {
-        bool found = false;
-
-        foreach (const AbstractEntry *entry, m_entryList) {
-            if (entry->type() == AbstractEntry::RunnableType
-                && static_cast<const AppEntry *>(entry)->service()->storageId()
-                == static_cast<const AppEntry *>(suggestedEntry)->service()->storageId()) {
-                found = true;
-                break;
+        if (suggestedEntry->type() == AbstractEntry::RunnableType) {
+            const QString &storageId = static_cast<const AppEntry *>(suggestedEntry)->service()->storageId();
+
+            if (storageIds.contains(storageId)) {
+                continue;
             }
-        }
 
-        if (!found) {
-            m_entryList << suggestedEntry;
+            storageIds.insert(storageId);
         }
+
+        m_entryList << suggestedEntry;
     }
 
     sortEntries();
@@ -99,6 +98,8 @@ AppsModel::~AppsModel()
     if (m_deleteEntriesOnDestruction) {
         qDeleteAll(m_entryList);
     }
+
+    qDeleteAll(m_staleEntries);
 }
 
 bool AppsModel::autoPopulate() const
@@ -154,7 +155,7 @@ QVariant AppsModel::data(const QModelIndex &index, int role) const
     } else if (role == Kicker::HasChildrenRole) {
         return entry->hasChildren();
     } else if (role == Kicker::HasActionListRole) {
-        const AppsModel *appsModel = qobject_cast<const AppsModel *>(entry->childModel());
+        const AppsModel *appsModel = qobject_cast<const AppsModel *>(childModelForActions(entry));
 
         return entry->hasActions() || (appsModel && !appsModel->hiddenEntries().isEmpty());
     } else if (role == Kicker::ActionListRole) {
@@ -166,7 +167,7 @@ QVariant AppsModel::data(const QModelIndex &index, int role) const
             actionList << unhideSiblingApplicationsAction;
         }
 
-        const AppsModel *appsModel = qobject_cast<const AppsModel *>(entry->childModel());
+        const AppsModel *appsModel = qobject_cast<const AppsModel *>(childModelForActions(entry));
 
         if (appsModel && !appsModel->hiddenEntries().isEmpty()) {
             QVariantMap unhideChildApplicationsAction = Kicker::createActionItem(i18n("Unhide Applications in '%1'", entry->name()), QStringLiteral("view-visible"), QStringLiteral("unhideChildApplications"));
@@ -302,7 +303,15 @@ AbstractModel *AppsModel::modelForRow(int row)
 int AppsModel::rowForModel(AbstractModel *model)
 {
     for (int i = 0; i < m_entryList.count(); ++i) {
-        if (m_entryList.at(i)->childModel() == model) {
+        const AbstractEntry *entry = m_entryList.at(i);
+        const AppGroupEntry *groupEntry = dynamic_cast<const AppGroupEntry *>(entry);
+
+        // A submenu nobody has asked for yet can't be the model we look for.
+        if (groupEntry && !groupEntry->hasChildModel()) {
+            continue;
+        }
+
+        if (entry->childModel() == model) {
             return i;
         }
     }
@@ -416,8 +425,8 @@ int AppsModel::appNameFormat() const
 
 void AppsModel::setAppNameFormat(int format)
 {
-    if (m_appNameFormat != (AppEntry::NameFormat)format) {
-        m_appNameFormat = (AppEntry::NameFormat)format;
+    if (m_appNameFormat != AppEntry::toNameFormat(format)) {
+        m_appNameFormat = AppEntry::toNameFormat(format);
 
         refresh();
 
@@ -487,17 +496,19 @@ void AppsModel::refreshInternal()
     }
 
     m_hiddenEntries.clear();
+    m_configuredHiddenApps = configuredHiddenApps();
     m_separatorCount = 0;
 
+    QSet<QString> storageIds;
+
     if (m_entryPath.isEmpty()) {
-        KServiceGroup::Ptr group = KServiceGroup::root();
-        if (!group) {
+        if (!m_catalogue->group(QString())) {
             return;
         }
 
         bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
 
-        KServiceGroup::List list = group->entries(true /* sorted */, true /* excludeNoDisplay */,
+        const KServiceGroup::List list = m_catalogue->entries(QString(),
             true /* allowSeparators */, sortByGenericName /* sortByGenericName */);
 
         for (KServiceGroup::List::ConstIterator it = list.constBegin(); it != list.constEnd(); it++) {
@@ -518,16 +529,8 @@ void AppsModel::refreshInternal()
                     continue;
                 }
 
-                bool found = false;
-
-                foreach (const AbstractEntry *entry, m_entryList) {
-                    if (entry->type() == AbstractEntry::RunnableType
-                        && static_cast<const AppEntry *>(entry)->service()->storageId() == service->storageId()) {
-                        found = true;
-                    }
-                }
-
-                if (!found) {
+                if (!storageIds.contains(service->storageId())) {
+                    storageIds.insert(service->storageId());
                     m_entryList << new AppEntry(this, service, m_appNameFormat);
                 }
              } else if (p->isType(KST_KServiceSeparator) && m_showSeparators && m_showTopLevelItems) {
@@ -555,15 +558,9 @@ void AppsModel::refreshInternal()
             sortEntries();
         }
 
-        m_changeTimer = new QTimer(this);
-        m_changeTimer->setSingleShot(true);
-        m_changeTimer->setInterval(100);
-        connect(m_changeTimer, SIGNAL(timeout()), this, SLOT(refresh()));
-
-        connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
+        watchSycoca();
     } else {
-        KServiceGroup::Ptr group = KServiceGroup::group(m_entryPath);
-        processServiceGroup(group);
+        processServiceGroup(m_entryPath, storageIds);
 
         if (m_entryList.count()) {
             while (m_entryList.last()->type() == AbstractEntry::SeparatorType) {
@@ -605,39 +602,245 @@ void AppsModel::refreshInternal()
     }
 }
 
-void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
+QList<AbstractEntry *> AppsModel::buildEntries()
 {
-    if (!group || !group->isValid()) {
+    const QList<AbstractEntry *> currentEntries = m_entryList;
+    m_entryList.clear();
+
+    AppsModel::refreshInternal();
+
+    const QList<AbstractEntry *> entries = m_entryList;
+    m_entryList = currentEntries;
+
+    return entries;
+}
+
+void AppsModel::applySycocaChanges()
+{
+    if (!m_complete || m_staticEntryList) {
+        return;
+    }
+
+    if (rootModel() == this && !m_appletInterface) {
+        return;
+    }
+
+    // Pages are cut from the whole list, regroup them from scratch.
+    if (m_paginate) {
+        refresh();
+
         return;
     }
 
-    bool hasSubGroups = false;
+    const QStringList hiddenEntries = m_hiddenEntries;
+    const int separatorCount = m_separatorCount;
+
+    applyEntries(0, m_entryList.count(), buildEntries());
+
+    if (m_entryPath.isEmpty() && favoritesModel()) {
+        favoritesModel()->refresh();
+    }
+
+    if (m_separatorCount != separatorCount) {
+        emit separatorCountChanged();
+    }
 
-    foreach(KServiceGroup::Ptr subGroup, group->groupEntries(KServiceGroup::ExcludeNoDisplay)) {
-        if (subGroup->childCount() > 0) {
-            hasSubGroups = true;
+    if (m_hiddenEntries != hiddenEntries) {
+        emit hiddenEntriesChanged();
+    }
+}
 
+static QString entryKey(const AbstractEntry *entry, const QString &previousKey)
+{
+    switch (entry->type()) {
+        case AbstractEntry::RunnableType:
+            return QLatin1String("app:") + static_cast<const AppEntry *>(entry)->service()->storageId();
+        case AbstractEntry::SeparatorType:
+            return QLatin1String("separator:") + previousKey;
+        default:
             break;
+    }
+
+    if (const AppGroupEntry *groupEntry = dynamic_cast<const AppGroupEntry *>(entry)) {
+        return QLatin1String("group:") + groupEntry->entryPath();
+    }
+
+    return QString();
+}
+
+static QStringList entryKeys(const QList<AbstractEntry *> &entries)
+{
+    QStringList keys;
+    keys.reserve(entries.count());
+
+    QString previousKey;
+
+    for (const AbstractEntry *entry : entries) {
+        previousKey = entryKey(entry, previousKey);
+        keys << previousKey;
+    }
+
+    return keys;
+}
+
+static bool hasUniqueKeys(const QStringList &keys, const QSet<QString> &keySet)
+{
+    return keySet.count() == keys.count() && !keySet.contains(QString());
+}
+
+void AppsModel::applyEntries(int offset, int count, const QList<AbstractEntry *> &entries)
+{
+    const int rowsBefore = m_entryList.count();
+
+    QStringList oldKeys = entryKeys(m_entryList.mid(offset, count));
+    const QStringList newKeys = entryKeys(entries);
+    const QSet<QString> oldKeySet(oldKeys.constBegin(), oldKeys.constEnd());
+    const QSet<QString> newKeySet(newKeys.constBegin(), newKeys.constEnd());
+
+    QList<AbstractEntry *> staleEntries;
+
+    // Entries we can't tell apart are not worth diffing.
+    bool reset = !hasUniqueKeys(oldKeys, oldKeySet) || !hasUniqueKeys(newKeys, newKeySet);
+
+    if (!reset) {
+        for (int last = count - 1; last >= 0; --last) {
+            if (newKeySet.contains(oldKeys.at(last))) {
+                continue;
+            }
+
+            int first = last;
+
+            while (first > 0 && !newKeySet.contains(oldKeys.at(first - 1))) {
+                --first;
+            }
+
+            beginRemoveRows(QModelIndex(), offset + first, offset + last);
+
+            for (int i = last; i >= first; --i) {
+                staleEntries << m_entryList.takeAt(offset + i);
+                oldKeys.removeAt(i);
+            }
+
+            endRemoveRows();
+
+            count -= last - first + 1;
+            last = first;
         }
+
+        QStringList keptKeys;
+
+        for (const QString &key : newKeys) {
+            if (oldKeySet.contains(key)) {
+                keptKeys << key;
+            }
+        }
+
+        reset = (keptKeys != oldKeys);
     }
 
-    bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
+    if (reset) {
+        beginResetModel();
 
-    KServiceGroup::List list = group->entries(true /* sorted */,
-        true /* excludeNoDisplay */,
-        (!m_flat || (m_flat && !hasSubGroups)) /* allowSeparators */,
-        sortByGenericName /* sortByGenericName */);
+        for (int i = 0; i < count; ++i) {
+            staleEntries << m_entryList.takeAt(offset);
+        }
 
-    QStringList hiddenApps;
+        for (int i = 0; i < entries.count(); ++i) {
+            m_entryList.insert(offset + i, entries.at(i));
+        }
 
-    QObject *appletInterface = rootModel()->property("appletInterface").value<QObject *>();
-    QQmlPropertyMap *appletConfig = nullptr;
-    if (appletInterface) {
-        appletConfig = qobject_cast<QQmlPropertyMap *>(appletInterface->property("configuration").value<QObject *>());
+        endResetModel();
+    } else {
+        int row = offset;
+
+        for (int i = 0; i < entries.count(); ++i) {
+            AbstractEntry *entry = entries.at(i);
+
+            if (!oldKeySet.contains(newKeys.at(i))) {
+                int last = i;
+
+                while (last + 1 < entries.count() && !oldKeySet.contains(newKeys.at(last + 1))) {
+                    ++last;
+                }
+
+                beginInsertRows(QModelIndex(), row, row + last - i);
+
+                for (int j = i; j <= last; ++j) {
+                    m_entryList.insert(row++, entries.at(j));
+                }
+
+                endInsertRows();
+
+                i = last;
+
+                continue;
+            }
+
+            AbstractEntry *current = m_entryList.at(row);
+            bool changed = false;
+
+            if (entry->type() == AbstractEntry::RunnableType) {
+                // The old entry may hold on to a service that is gone, take the new one.
+                const AppEntry *oldApp = static_cast<const AppEntry *>(current);
+                const AppEntry *newApp = static_cast<const AppEntry *>(entry);
+
+                changed = (oldApp->name() != newApp->name()
+                    || oldApp->description() != newApp->description()
+                    || oldApp->service()->icon() != newApp->service()->icon()
+                    || oldApp->url() != newApp->url());
+
+                m_entryList[row] = entry;
+                changePersistentIndex(createIndex(row, 0, current), createIndex(row, 0, entry));
+                staleEntries << current;
+            } else {
+                if (entry->type() == AbstractEntry::GroupType) {
+                    changed = static_cast<AppGroupEntry *>(current)->applySycocaChanges(
+                        static_cast<const AppGroupEntry *>(entry)->group());
+                }
+
+                staleEntries << entry;
+            }
+
+            if (changed) {
+                const QModelIndex idx = index(row, 0);
+                emit dataChanged(idx, idx);
+            }
+
+            ++row;
+        }
     }
-    if (appletConfig && appletConfig->contains(QLatin1String("hiddenApplications"))) {
-        hiddenApps = appletConfig->value(QLatin1String("hiddenApplications")).toStringList();
+
+    // Views may still be busy with the rows they just lost.
+    // Those still pending when the model goes away are deleted with it.
+    if (m_deleteEntriesOnDestruction && !staleEntries.isEmpty()) {
+        m_staleEntries << staleEntries;
+
+        QTimer::singleShot(0, this, [this] {
+            qDeleteAll(m_staleEntries);
+            m_staleEntries.clear();
+        });
+    }
+
+    if (m_entryList.count() != rowsBefore) {
+        emit countChanged();
     }
+}
+
+void AppsModel::processServiceGroup(const QString &entryPath, QSet<QString> &storageIds)
+{
+    const KServiceGroup::Ptr group = m_catalogue->group(entryPath);
+
+    if (!group || !group->isValid()) {
+        return;
+    }
+
+    bool hasSubGroups = m_catalogue->hasSubGroups(entryPath);
+
+    bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
+
+    const KServiceGroup::List list = m_catalogue->entries(entryPath,
+        (!m_flat || (m_flat && !hasSubGroups)) /* allowSeparators */,
+        sortByGenericName /* sortByGenericName */);
 
     for (KServiceGroup::List::ConstIterator it = list.constBegin();
         it != list.constEnd(); it++) {
@@ -650,23 +853,14 @@ void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
                 continue;
             }
 
-            if (hiddenApps.contains(service->menuId())) {
+            if (m_configuredHiddenApps.contains(service->menuId())) {
                 m_hiddenEntries << service->menuId();
 
                 continue;
             }
 
-            bool found = false;
-
-            foreach (const AbstractEntry *entry, m_entryList) {
-                if (entry->type() == AbstractEntry::RunnableType
-                    && static_cast<const AppEntry *>(entry)->service()->storageId() == service->storageId()) {
-                    found = true;
-                    break;
-                }
-            }
-
-            if (!found) {
+            if (!storageIds.contains(service->storageId())) {
+                storageIds.insert(service->storageId());
                 m_entryList << new AppEntry(this, service, m_appNameFormat);
             }
         } else if (p->isType(KST_KServiceSeparator) && m_showSeparators) {
@@ -689,8 +883,7 @@ void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
 
             if (m_flat) {
                 m_sorted = true;
-                const KServiceGroup::Ptr serviceGroup(static_cast<KServiceGroup*>(p.data()));
-                processServiceGroup(serviceGroup);
+                processServiceGroup(subGroup->entryPath(), storageIds);
             } else {
                 AppGroupEntry *groupEntry = new AppGroupEntry(this, subGroup, m_paginate, m_pageSize, m_flat,
                     m_sorted, m_showSeparators, m_appNameFormat);
@@ -700,6 +893,64 @@ void AppsModel::processServiceGroup(KServiceGroup::Ptr group)
     }
 }
 
+void AppsModel::collectApps(const QString &entryPath, QHash<QString, AbstractEntry *> &apps)
+{
+    bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
+
+    const KServiceGroup::List list = m_catalogue->entries(entryPath,
+        true /* allowSeparators */, sortByGenericName /* sortByGenericName */);
+
+    for (const KSycocaEntry::Ptr &p : list) {
+        if (p->isType(KST_KService)) {
+            const KService::Ptr service(static_cast<KService*>(p.data()));
+
+            if (service->noDisplay() || m_configuredHiddenApps.contains(service->menuId())
+                || apps.contains(service->menuId())) {
+                continue;
+            }
+
+            apps.insert(service->menuId(), new AppEntry(this, service, m_appNameFormat));
+        } else if (p->isType(KST_KServiceGroup)) {
+            const KServiceGroup::Ptr subGroup(static_cast<KServiceGroup*>(p.data()));
+
+            if (subGroup->childCount() > 0) {
+                collectApps(subGroup->entryPath(), apps);
+            }
+        }
+    }
+}
+
+bool AppsModel::hasVisibleEntries(const QString &entryPath, bool flat)
+{
+    bool sortByGenericName = (appNameFormat() == AppEntry::GenericNameOnly || appNameFormat() == AppEntry::GenericNameAndName);
+
+    const KServiceGroup::List list = m_catalogue->entries(entryPath,
+        true /* allowSeparators */, sortByGenericName /* sortByGenericName */);
+
+    for (const KSycocaEntry::Ptr &p : list) {
+        if (p->isType(KST_KService)) {
+            const KService::Ptr service(static_cast<KService*>(p.data()));
+
+            if (!service->noDisplay() && !m_configuredHiddenApps.contains(service->menuId())) {
+                return true;
+            }
+        } else if (p->isType(KST_KServiceGroup)) {
+            const KServiceGroup::Ptr subGroup(static_cast<KServiceGroup*>(p.data()));
+
+            if (subGroup->childCount() == 0) {
+                continue;
+            }
+
+            // A submenu gets a row of its own, flat models list its applications instead.
+            if (!flat || hasVisibleEntries(subGroup->entryPath(), flat)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 void AppsModel::sortEntries()
 {
     QCollator c;
@@ -714,11 +965,44 @@ void AppsModel::sortEntries()
         });
 }
 
-void AppsModel::checkSycocaChanges(const QStringList &changes)
+QStringList AppsModel::configuredHiddenApps()
 {
-    if (changes.contains(QLatin1String("services")) || changes.contains(QLatin1String("apps")) || changes.contains(QLatin1String("xdgdata-apps"))) {
-        m_changeTimer->start();
+    AbstractModel *root = rootModel();
+
+    if (!root) {
+        return QStringList();
+    }
+
+    QObject *appletInterface = root->property("appletInterface").value<QObject *>();
+    QQmlPropertyMap *appletConfig = nullptr;
+    if (appletInterface) {
+        appletConfig = qobject_cast<QQmlPropertyMap *>(appletInterface->property("configuration").value<QObject *>());
+    }
+    if (appletConfig && appletConfig->contains(QLatin1String("hiddenApplications"))) {
+        return appletConfig->value(QLatin1String("hiddenApplications")).toStringList();
     }
+
+    return QStringList();
+}
+
+AbstractModel *AppsModel::childModelForActions(const AbstractEntry *entry) const
+{
+    // Submenus are only walked on demand; with nothing hidden there is
+    // nothing to unhide in them either.
+    if (m_configuredHiddenApps.isEmpty()) {
+        const AppGroupEntry *groupEntry = dynamic_cast<const AppGroupEntry *>(entry);
+
+        if (groupEntry && !groupEntry->hasChildModel()) {
+            return nullptr;
+        }
+    }
+
+    return entry->childModel();
+}
+
+void AppsModel::watchSycoca()
+{
+    connect(m_catalogue.data(), &AppsCatalogue::changed, this, &AppsModel::applySycocaChanges, Qt::UniqueConnection);
 }
 
 void AppsModel::entryChanged(AbstractEntry *entry)
@@ -23,14 +23,13 @@
 
 #include "abstractmodel.h"
 #include "appentry.h"
+#include "appscatalogue.h"
 
 #include <QQmlParserStatus>
 
 #include <KServiceGroup>
 
 
-class QTimer;
-
 class AppsModel : public AbstractModel, public QQmlParserStatus
 {
     Q_OBJECT
@@ -100,6 +99,24 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
 
         void entryChanged(AbstractEntry *entry) override;
 
+        /**
+         * Brings the model up to date after a sycoca change, only touching the
+         * rows of applications and submenus that were added, removed or changed.
+         */
+        virtual void applySycocaChanges();
+
+        /**
+         * Replaces the @p count rows starting at @p offset with @p entries,
+         * keeping the rows and child models of entries present in both.
+         */
+        void applyEntries(int offset, int count, const QList<AbstractEntry *> &entries);
+
+        /**
+         * Whether a model for the menu group at @p entryPath would have rows,
+         * without creating it.
+         */
+        bool hasVisibleEntries(const QString &entryPath, bool flat);
+
         void classBegin() override;
         void componentComplete() override;
 
@@ -121,6 +138,14 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
 
     protected:
         void refreshInternal();
+        QList<AbstractEntry *> buildEntries();
+        /**
+         * Adds a new entry for every visible application in the menu group at
+         * @p entryPath and its submenus to @p apps, keyed by menu id and read
+         * straight from the catalogue. The caller owns the new entries.
+         */
+        void collectApps(const QString &entryPath, QHash<QString, AbstractEntry *> &apps);
+        AbstractModel *childModelForActions(const AbstractEntry *entry) const;
 
         bool m_complete;
 
@@ -129,29 +154,31 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
 
         QList<AbstractEntry *> m_entryList;
         bool m_deleteEntriesOnDestruction;
+        /** Replaced by a sycoca change, deleted on the next event loop pass */
+        QList<AbstractEntry *> m_staleEntries;
         int m_separatorCount;
         bool m_showSeparators;
         bool m_showTopLevelItems;
 
         QObject *m_appletInterface;
 
-    private Q_SLOTS:
-        void checkSycocaChanges(const QStringList &changes);
-
     private:
-        void processServiceGroup(KServiceGroup::Ptr group);
+        void watchSycoca();
+        void processServiceGroup(const QString &entryPath, QSet<QString> &storageIds);
         void sortEntries();
+        QStringList configuredHiddenApps();
 
         bool m_autoPopulate;
 
         QString m_description;
         QString m_entryPath;
         bool m_staticEntryList;
-        QTimer *m_changeTimer;
+        QSharedPointer<AppsCatalogue> m_catalogue;
         bool m_flat;
         bool m_sorted;
         AppEntry::NameFormat m_appNameFormat;
         QStringList m_hiddenEntries;
+        QStringList m_configuredHiddenApps;
         static MenuEntryEditor *m_menuEntryEditor;
 };
 
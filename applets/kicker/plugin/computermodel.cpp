@@ -168,8 +168,8 @@ int ComputerModel::appNameFormat() const
 
 void ComputerModel::setAppNameFormat(int format)
 {
-    if (m_appNameFormat != (AppEntry::NameFormat)format) {
-        m_appNameFormat = (AppEntry::NameFormat)format;
+    if (m_appNameFormat != AppEntry::toNameFormat(format)) {
+        m_appNameFormat = AppEntry::toNameFormat(format);
 
         m_systemAppsModel->refresh();
 
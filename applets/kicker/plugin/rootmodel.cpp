@@ -75,6 +75,9 @@ RootModel::RootModel(QObject *parent) : AppsModel(QString(), parent)
 , m_recentAppsModel(nullptr)
 , m_recentDocsModel(nullptr)
 , m_recentContactsModel(nullptr)
+, m_appsOffset(0)
+, m_appsCount(0)
+, m_rootSeparatorCount(0)
 {
 }
 
@@ -285,45 +288,16 @@ void RootModel::refresh()
     m_recentDocsModel = nullptr;
     m_recentContactsModel = nullptr;
 
-    if (m_showAllApps) {
-        QHash<QString, AbstractEntry *> appsHash;
-
-        std::function<void(AbstractEntry *)> processEntry = [&](AbstractEntry *entry) {
-            if (entry->type() == AbstractEntry::RunnableType) {
-                AppEntry *appEntry = static_cast<AppEntry*>(entry);
-                appsHash.insert(appEntry->service()->menuId(), appEntry);
-            } else if (entry->type() == AbstractEntry::GroupType) {
-                GroupEntry *groupEntry = static_cast<GroupEntry*>(entry);
-                AbstractModel *model = groupEntry->childModel();
-
-                if (!model) {
-                    return;
-                }
-
-                for (int i = 0; i < model->count(); ++i) {
-                    processEntry(static_cast<AbstractEntry*>(model->index(i, 0).internalPointer()));
-                }
-            }
-        };
-
-        for (AbstractEntry *entry : m_entryList) {
-            processEntry(entry);
-        }
+    m_appsOffset = 0;
+    m_appsCount = m_entryList.count();
+    m_allAppsModel = nullptr;
 
-        QList<AbstractEntry *> apps(appsHash.values());
-        QCollator c;
-
-        std::sort(apps.begin(), apps.end(),
-            [&c](AbstractEntry* a, AbstractEntry* b) {
-                if (a->type() != b->type()) {
-                    return a->type() > b->type();
-                } else {
-                    return c.compare(a->name(), b->name()) < 0;
-                }
-            });
+    if (m_showAllApps) {
+        const QList<AbstractEntry *> apps = allApps();
 
         if (!m_showAllAppsCategorized && !m_paginate) { // The app list built above goes into a model.
-            allModel = new AppsModel(apps, false, this);
+            allModel = new AppsModel(apps, true, this);
+            m_allAppsModel = allModel;
         } else if (m_paginate) { // We turn the apps list into a subtree of pages.
             m_favorites = new KAStatsFavoritesModel(this);
             emit favoritesModelChanged();
@@ -339,7 +313,7 @@ void RootModel::refresh()
 
                 if (at == (m_pageSize - 1)) {
                     at = 0;
-                    AppsModel *model = new AppsModel(page, false, this);
+                    AppsModel *model = new AppsModel(page, true, this);
                     groups.append(new GroupEntry(this, QString(), QString(), model));
                     page.clear();
                 } else {
@@ -348,7 +322,7 @@ void RootModel::refresh()
             }
 
             if (!page.isEmpty()) {
-                AppsModel *model = new AppsModel(page, false, this);
+                AppsModel *model = new AppsModel(page, true, this);
                 groups.append(new GroupEntry(this, QString(), QString(), model));
             }
 
@@ -359,28 +333,21 @@ void RootModel::refresh()
             QList<AbstractEntry *> groups;
             QHash<QString, QList<AbstractEntry *>> m_categoryHash;
 
-            foreach (const AbstractEntry *groupEntry, m_entryList) {
-                AbstractModel *model = groupEntry->childModel();
-
-                if (!model) continue;
-
-                for (int i = 0; i < model->count(); ++i) {
-                    AbstractEntry *appEntry = static_cast<AbstractEntry *>(model->index(i, 0).internalPointer());
-
-                    if (appEntry->name().isEmpty()) {
-                        continue;
-                    }
-
-                    const QChar &first = appEntry->name().at(0).toUpper();
-                    m_categoryHash[first.isDigit() ? QStringLiteral("0-9") : first].append(appEntry);
+            foreach (AbstractEntry *appEntry, apps) {
+                if (appEntry->name().isEmpty()) {
+                    delete appEntry;
+                    continue;
                 }
+
+                const QChar &first = appEntry->name().at(0).toUpper();
+                m_categoryHash[first.isDigit() ? QStringLiteral("0-9") : first].append(appEntry);
             }
 
             QHashIterator<QString, QList<AbstractEntry *>> i(m_categoryHash);
 
             while (i.hasNext()) {
                 i.next();
-                AppsModel *model = new AppsModel(i.value(), false, this);
+                AppsModel *model = new AppsModel(i.value(), true, this);
                 model->setDescription(i.key());
                 groups.append(new GroupEntry(this, i.key(), QString(), model));
             }
@@ -430,9 +397,14 @@ void RootModel::refresh()
         ++separatorPosition;
     }
 
+    m_appsOffset = separatorPosition;
+    m_rootSeparatorCount = 0;
+
     if (m_showSeparators && separatorPosition > 0) {
         m_entryList.insert(separatorPosition, new SeparatorEntry(this));
         ++m_separatorCount;
+        ++m_appsOffset;
+        ++m_rootSeparatorCount;
     }
 
     m_systemModel = new SystemModel(this);
@@ -451,3 +423,69 @@ void RootModel::refresh()
 
     emit refreshed();
 }
+
+void RootModel::applySycocaChanges()
+{
+    if (!m_complete) {
+        return;
+    }
+
+    // The grouped and paged variants of "All Applications" are regrouped from scratch.
+    if (m_showAllApps && !m_allAppsModel) {
+        refresh();
+
+        return;
+    }
+
+    const int separatorCount = m_separatorCount;
+    const QList<AbstractEntry *> entries = buildEntries();
+
+    m_separatorCount += m_rootSeparatorCount;
+
+    applyEntries(m_appsOffset, m_appsCount, entries);
+    m_appsCount = entries.count();
+
+    if (m_allAppsModel) {
+        m_allAppsModel->applyEntries(0, m_allAppsModel->count(), allApps());
+    }
+
+    m_favorites->refresh();
+
+    if (m_separatorCount != separatorCount) {
+        emit separatorCountChanged();
+    }
+}
+
+QList<AbstractEntry *> RootModel::allApps()
+{
+    QHash<QString, AbstractEntry *> appsHash;
+
+    // Read from the catalogue rather than from the submenu models, which
+    // would all have to be created for this.
+    for (AbstractEntry *entry : m_entryList.mid(m_appsOffset, m_appsCount)) {
+        if (entry->type() == AbstractEntry::RunnableType) {
+            const KService::Ptr service = static_cast<AppEntry *>(entry)->service();
+
+            if (!appsHash.contains(service->menuId())) {
+                appsHash.insert(service->menuId(), new AppEntry(this, service,
+                    static_cast<AppEntry::NameFormat>(appNameFormat())));
+            }
+        } else if (const AppGroupEntry *groupEntry = dynamic_cast<const AppGroupEntry *>(entry)) {
+            collectApps(groupEntry->entryPath(), appsHash);
+        }
+    }
+
+    QList<AbstractEntry *> apps(appsHash.values());
+    QCollator c;
+
+    std::sort(apps.begin(), apps.end(),
+        [&c](AbstractEntry* a, AbstractEntry* b) {
+            if (a->type() != b->type()) {
+                return a->type() > b->type();
+            } else {
+                return c.compare(a->name(), b->name()) < 0;
+            }
+        });
+
+    return apps;
+}
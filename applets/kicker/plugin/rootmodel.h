@@ -92,6 +92,8 @@ class RootModel : public AppsModel
         AbstractModel* favoritesModel() override;
         AbstractModel* systemFavoritesModel();
 
+        void applySycocaChanges() override;
+
     Q_SIGNALS:
         void refreshed() const;
         void systemFavoritesModelChanged() const;
@@ -108,6 +110,8 @@ class RootModel : public AppsModel
         void refresh() override;
 
     private:
+        QList<AbstractEntry *> allApps();
+
         KAStatsFavoritesModel *m_favorites;
         SystemModel *m_systemModel;
 
@@ -122,6 +126,11 @@ class RootModel : public AppsModel
         RecentUsageModel *m_recentAppsModel;
         RecentUsageModel *m_recentDocsModel;
         RecentContactsModel *m_recentContactsModel;
+
+        int m_appsOffset;
+        int m_appsCount;
+        int m_rootSeparatorCount;
+        QPointer<AppsModel> m_allAppsModel;
 };
 
 #endif
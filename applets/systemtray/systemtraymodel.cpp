@@ -21,6 +21,7 @@
 #include "debug.h"
 
 #include <QQuickItem>
+#include <QSignalBlocker>
 
 #include <Plasma/Applet>
 #include <Plasma/DataContainer>
@@ -231,6 +232,20 @@ void PlasmoidModel::removeApplet(Plasma::Applet *applet)
 
 StatusNotifierModel::StatusNotifierModel(QObject *parent) : BaseModel(parent)
 {
+    const QHash<int, QByteArray> roles = roleNames();
+    for (Role role : {Role::AttentionIconName, Role::AttentionMovieName, Role::Category, Role::IconName,
+                      Role::IconThemePath, Role::Id, Role::ItemIsMenu, Role::OverlayIconName, Role::Status,
+                      Role::Title, Role::ToolTipSubTitle, Role::ToolTipTitle, Role::WindowId}) {
+        const int roleId = static_cast<int>(role);
+        m_passThroughRoles.append(qMakePair(roleId, QString::fromLatin1(roles.value(roleId))));
+    }
+
+    // Items tend to change several properties in a row, e.g. when
+    // animating their icon; collect everything that arrives in a frame
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(16);
+    connect(&m_updateTimer, &QTimer::timeout, this, &StatusNotifierModel::applyPendingUpdates);
+
     m_dataEngine = dataEngine(QStringLiteral("statusnotifieritem"));
 
     connect(m_dataEngine, &Plasma::DataEngine::sourceAdded, this, &StatusNotifierModel::addSource);
@@ -285,9 +300,14 @@ void StatusNotifierModel::addSource(const QString &source)
 void StatusNotifierModel::removeSource(const QString &source)
 {
     m_dataEngine->disconnectSource(source, this);
-    if (m_sources.contains(source)) {
-        removeRow(m_sources.indexOf(source));
-        m_sources.removeAll(source);
+
+    if (m_pendingData.remove(source)) {
+        m_pendingSources.removeOne(source);
+    }
+
+    QStandardItem *dataItem = m_items.take(source);
+    if (dataItem) {
+        removeRow(dataItem->row());
     }
 
     QHash<QString, Plasma::Service *>::iterator it = m_services.find(source);
@@ -299,72 +319,115 @@ void StatusNotifierModel::removeSource(const QString &source)
 
 void StatusNotifierModel::dataUpdated(const QString &sourceName, const Plasma::DataEngine::Data &data)
 {
-    QStandardItem *dataItem;
-    if (m_sources.contains(sourceName)) {
-        dataItem = item(m_sources.indexOf(sourceName));
-    } else {
+    if (!m_pendingData.contains(sourceName)) {
+        m_pendingSources.append(sourceName);
+    }
+    m_pendingData.insert(sourceName, data);
+
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+void StatusNotifierModel::applyPendingUpdates()
+{
+    const QStringList sources = m_pendingSources;
+    const QHash<QString, Plasma::DataEngine::Data> pendingData = m_pendingData;
+    m_pendingSources.clear();
+    m_pendingData.clear();
+
+    for (const QString &source : sources) {
+        applyUpdate(source, pendingData.value(source));
+    }
+}
+
+static bool isSameData(const QVariant &a, const QVariant &b)
+{
+    // QIcon has no comparison, but the engine hands out the same icon
+    // again as long as the image didn't change
+    if (a.userType() == qMetaTypeId<QIcon>() && b.userType() == qMetaTypeId<QIcon>()) {
+        return a.value<QIcon>().cacheKey() == b.value<QIcon>().cacheKey();
+    }
+    return a == b;
+}
+
+void StatusNotifierModel::applyUpdate(const QString &sourceName, const Plasma::DataEngine::Data &data)
+{
+    const QMap<int, QVariant> roles = itemData(sourceName, data);
+
+    QStandardItem *dataItem = m_items.value(sourceName);
+    if (!dataItem) {
         dataItem = new QStandardItem();
-        dataItem->setData(QStringLiteral("StatusNotifier"), static_cast<int>(BaseModel::BaseRole::ItemType));
-        dataItem->setData(true, static_cast<int>(BaseModel::BaseRole::CanRender));
+        for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+            dataItem->setData(it.value(), it.key());
+        }
+        m_items.insert(sourceName, dataItem);
+        appendRow(dataItem);
+        return;
     }
 
-    dataItem->setData(data.value("Title"), Qt::DisplayRole);
+    QVector<int> changedRoles;
+    {
+        // announced below in one go, with only the roles that actually changed
+        const QSignalBlocker blocker(this);
+        for (auto it = roles.constBegin(); it != roles.constEnd(); ++it) {
+            if (!isSameData(dataItem->data(it.key()), it.value())) {
+                dataItem->setData(it.value(), it.key());
+                changedRoles.append(it.key());
+            }
+        }
+    }
+
+    if (!changedRoles.isEmpty()) {
+        const QModelIndex index = dataItem->index();
+        emit dataChanged(index, index, changedRoles);
+    }
+}
+
+QMap<int, QVariant> StatusNotifierModel::itemData(const QString &sourceName, const Plasma::DataEngine::Data &data) const
+{
+    QMap<int, QVariant> roles;
+
+    roles.insert(static_cast<int>(BaseModel::BaseRole::ItemType), QStringLiteral("StatusNotifier"));
+    roles.insert(static_cast<int>(BaseModel::BaseRole::CanRender), true);
+
+    roles.insert(Qt::DisplayRole, data.value("Title"));
     QVariant icon = data.value("Icon");
     if (icon.isValid() && icon.canConvert<QIcon>() && !icon.value<QIcon>().isNull()) {
-        dataItem->setData(icon, Qt::DecorationRole);
-        dataItem->setData(icon, static_cast<int>(Role::Icon));
+        roles.insert(Qt::DecorationRole, icon);
+        roles.insert(static_cast<int>(Role::Icon), icon);
     } else {
-        dataItem->setData(data.value("IconName"), Qt::DecorationRole);
-        dataItem->setData(QVariant(), static_cast<int>(Role::Icon));
+        roles.insert(Qt::DecorationRole, data.value("IconName"));
+        roles.insert(static_cast<int>(Role::Icon), QVariant());
     }
     QVariant attentionIcon = data.value("AttentionIcon");
     if (attentionIcon.isValid() && attentionIcon.canConvert<QIcon>() && !attentionIcon.value<QIcon>().isNull()) {
-        dataItem->setData(attentionIcon, static_cast<int>(Role::AttentionIcon));
+        roles.insert(static_cast<int>(Role::AttentionIcon), attentionIcon);
     } else {
-        dataItem->setData(QVariant(), static_cast<int>(Role::AttentionIcon));
+        roles.insert(static_cast<int>(Role::AttentionIcon), QVariant());
     }
 
-    dataItem->setData(data.value("Id"), static_cast<int>(BaseModel::BaseRole::ItemId));
+    roles.insert(static_cast<int>(BaseModel::BaseRole::ItemId), data.value("Id"));
     QVariant category = data.value("Category");
-    dataItem->setData(category.isNull() ? QStringLiteral("UnknownCategory") : data.value("Category"), static_cast<int>(BaseModel::BaseRole::Category));
+    roles.insert(static_cast<int>(BaseModel::BaseRole::Category), category.isNull() ? QStringLiteral("UnknownCategory") : data.value("Category"));
 
     QString status = data.value("Status").toString();
     if (status == QLatin1String("Active")) {
-        dataItem->setData(Plasma::Types::ItemStatus::ActiveStatus, static_cast<int>(BaseModel::BaseRole::Status));
+        roles.insert(static_cast<int>(BaseModel::BaseRole::Status), Plasma::Types::ItemStatus::ActiveStatus);
     } else if (status == QLatin1String("NeedsAttention")) {
-        dataItem->setData(Plasma::Types::ItemStatus::NeedsAttentionStatus, static_cast<int>(BaseModel::BaseRole::Status));
+        roles.insert(static_cast<int>(BaseModel::BaseRole::Status), Plasma::Types::ItemStatus::NeedsAttentionStatus);
     } else if (status == QLatin1String("Passive")) {
-        dataItem->setData(Plasma::Types::ItemStatus::PassiveStatus, static_cast<int>(BaseModel::BaseRole::Status));
+        roles.insert(static_cast<int>(BaseModel::BaseRole::Status), Plasma::Types::ItemStatus::PassiveStatus);
     } else {
-        dataItem->setData(Plasma::Types::ItemStatus::UnknownStatus, static_cast<int>(BaseModel::BaseRole::Status));
-    }
-
-    dataItem->setData(sourceName, static_cast<int>(Role::DataEngineSource));
-    updateItemData(dataItem, data, Role::AttentionIconName);
-    updateItemData(dataItem, data, Role::AttentionMovieName);
-    updateItemData(dataItem, data, Role::Category);
-    updateItemData(dataItem, data, Role::IconName);
-    updateItemData(dataItem, data, Role::IconThemePath);
-    updateItemData(dataItem, data, Role::Id);
-    updateItemData(dataItem, data, Role::ItemIsMenu);
-    updateItemData(dataItem, data, Role::OverlayIconName);
-    updateItemData(dataItem, data, Role::Status);
-    updateItemData(dataItem, data, Role::Title);
-    updateItemData(dataItem, data, Role::ToolTipSubTitle);
-    updateItemData(dataItem, data, Role::ToolTipTitle);
-    updateItemData(dataItem, data, Role::WindowId);
-
-    if (!m_sources.contains(sourceName)) {
-        m_sources.append(sourceName);
-        appendRow(dataItem);
+        roles.insert(static_cast<int>(BaseModel::BaseRole::Status), Plasma::Types::ItemStatus::UnknownStatus);
     }
-}
 
-void StatusNotifierModel::updateItemData(QStandardItem *dataItem,
-                                         const Plasma::DataEngine::Data &data, const Role role)
-{
-    int roleId = static_cast<int>(role);
-    dataItem->setData(data.value(roleNames().value(roleId)), roleId);
+    roles.insert(static_cast<int>(Role::DataEngineSource), sourceName);
+    for (const auto &role : m_passThroughRoles) {
+        roles.insert(role.first, data.value(role.second));
+    }
+
+    return roles;
 }
 
 SystemTrayModel::SystemTrayModel(QObject *parent) : KConcatenateRowsProxyModel(parent)
@@ -21,6 +21,7 @@
 #define SYSTEMTRAYMODEL_H
 
 #include <QStandardItemModel>
+#include <QTimer>
 
 #include <KItemModels/KConcatenateRowsProxyModel>
 #include <Plasma/DataEngineConsumer>
@@ -117,11 +118,20 @@ public slots:
     void dataUpdated(const QString &sourceName, const Plasma::DataEngine::Data &data);
 
 private:
-    void updateItemData(QStandardItem *dataItem, const Plasma::DataEngine::Data &data, const Role role);
+    void applyPendingUpdates();
+    void applyUpdate(const QString &sourceName, const Plasma::DataEngine::Data &data);
+    QMap<int, QVariant> itemData(const QString &sourceName, const Plasma::DataEngine::Data &data) const;
 
     Plasma::DataEngine *m_dataEngine = nullptr;
-    QStringList m_sources;
+    QHash<QString, QStandardItem *> m_items;
     QHash<QString, Plasma::Service *> m_services;
+    // role, data engine key of the roles that are passed through as they are
+    QVector<QPair<int, QString>> m_passThroughRoles;
+
+    // updates of one frame, applied together
+    QHash<QString, Plasma::DataEngine::Data> m_pendingData;
+    QStringList m_pendingSources;
+    QTimer m_updateTimer;
 };
 
 class SystemTrayModel : public KConcatenateRowsProxyModel
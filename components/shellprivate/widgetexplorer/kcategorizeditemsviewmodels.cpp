@@ -60,9 +60,21 @@ int AbstractItem::running() const
 
 bool AbstractItem::matches(const QString &pattern) const
 {
-    return
-        name().contains(pattern, Qt::CaseInsensitive) ||
-        description().contains(pattern, Qt::CaseInsensitive);
+    return searchText().contains(pattern);
+}
+
+QString AbstractItem::searchText() const
+{
+    if (m_searchText.isNull()) {
+        m_searchText = (name() + QLatin1Char('\n') + description()).toCaseFolded();
+    }
+
+    return m_searchText;
+}
+
+void AbstractItem::setSearchText(const QString &text)
+{
+    m_searchText = text.toCaseFolded();
 }
 
 // DefaultFilterModel
@@ -134,7 +146,8 @@ QVariantHash DefaultFilterModel::get(int row) const
 // DefaultItemFilterProxyModel
 
 DefaultItemFilterProxyModel::DefaultItemFilterProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent),
+      m_narrowSearch(false)
 {
 }
 
@@ -147,7 +160,14 @@ void DefaultItemFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel
         return;
     }
 
+    resetSearchCache();
+
     QSortFilterProxyModel::setSourceModel(model);
+    // new items never were looked at by the previous search
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &DefaultItemFilterProxyModel::resetSearchCache);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset,
+            this, &DefaultItemFilterProxyModel::resetSearchCache);
     connect(this, &QAbstractItemModel::modelReset,
             this, &DefaultItemFilterProxyModel::countChanged);
     connect(this, &QAbstractItemModel::rowsInserted,
@@ -182,9 +202,31 @@ bool DefaultItemFilterProxyModel::filterAcceptsRow(int sourceRow,
     AbstractItem *item = (AbstractItem *) model->itemFromIndex(index);
     //qDebug() << "ITEM " << (item ? "IS NOT " : "IS") << " NULL\n";
 
+    // Search first, so the matches remembered cover all items no matter the filter
     return item &&
-        (m_filter.first.isEmpty() || item->passesFiltering(m_filter)) &&
-        (m_searchPattern.isEmpty() || item->matches(m_searchPattern));
+        (m_searchPattern.isEmpty() || matchesSearch(item)) &&
+        (m_filter.first.isEmpty() || item->passesFiltering(m_filter));
+}
+
+bool DefaultItemFilterProxyModel::matchesSearch(const AbstractItem *item) const
+{
+    if (m_narrowSearch && !m_previousSearchMatches.contains(item)) {
+        return false;
+    }
+
+    if (!item->matches(m_foldedSearchPattern)) {
+        return false;
+    }
+
+    m_searchMatches.insert(item);
+    return true;
+}
+
+void DefaultItemFilterProxyModel::resetSearchCache()
+{
+    m_narrowSearch = false;
+    m_previousSearchMatches.clear();
+    m_searchMatches.clear();
 }
 
 QVariantHash DefaultItemFilterProxyModel::get(int row) const
@@ -210,7 +252,19 @@ bool DefaultItemFilterProxyModel::lessThan(const QModelIndex &left,
 
 void DefaultItemFilterProxyModel::setSearchTerm(const QString &pattern)
 {
+    const QString foldedPattern = pattern.toCaseFolded();
+
+    // Typing on can only drop items, so only the previous matches need to be looked at again
+    m_narrowSearch = !m_foldedSearchPattern.isEmpty() && foldedPattern.startsWith(m_foldedSearchPattern);
+    if (m_narrowSearch) {
+        m_previousSearchMatches.swap(m_searchMatches);
+    } else {
+        m_previousSearchMatches.clear();
+    }
+    m_searchMatches.clear();
+
     m_searchPattern = pattern;
+    m_foldedSearchPattern = foldedPattern;
     invalidateFilter();
     emit searchTermChanged(pattern);
 }
@@ -22,6 +22,7 @@
 
 #include <QIcon>
 #include <QPair>
+#include <QSet>
 #include <QStandardItem>
 #include <QSortFilterProxyModel>
 
@@ -64,11 +65,18 @@ public:
 
     /**
      * Returns if the item contains string specified by pattern.
-     * Default implementation checks whether name or description contain the
+     * The pattern is expected to be case folded already.
+     * Default implementation checks whether the searchText() contains the
      * string (not needed to be exactly that string)
      */
     virtual bool matches(const QString &pattern) const;
 
+    /**
+     * Returns the case folded name and description the default
+     * matches() looks through
+     */
+    QString searchText() const;
+
     /**
      * sets the number of running applets for the item
      */
@@ -78,7 +86,16 @@ public:
      * Returns if the item passes the filter specified
      */
     virtual bool passesFiltering(const Filter &filter) const = 0;
+
+protected:
+    /**
+     * Sets the text searched by the default matches(), otherwise built
+     * from name() and description() on first use
+     */
+    void setSearchText(const QString &text);
+
 private:
+    mutable QString m_searchText;
 };
 
 /**
@@ -166,8 +183,18 @@ Q_SIGNALS:
     void countChanged();
 
 private:
+    bool matchesSearch(const AbstractItem *item) const;
+    void resetSearchCache();
+
     Filter m_filter;
     QString m_searchPattern;
+    QString m_foldedSearchPattern;
+
+    // Items matching the current search pattern, and those that matched the
+    // previous one while the current pattern only extends it.
+    mutable QSet<const AbstractItem *> m_searchMatches;
+    QSet<const AbstractItem *> m_previousSearchMatches;
+    bool m_narrowSearch;
 };
 
 } //end of namespace
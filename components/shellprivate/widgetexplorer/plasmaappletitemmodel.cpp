@@ -70,6 +70,16 @@ PlasmaAppletItem::PlasmaAppletItem(const KPluginInfo& info):
     setData(info.email(), PlasmaAppletItemModel::EmailRole);
     setData(0, PlasmaAppletItemModel::RunningRole);
     setData(m_local, PlasmaAppletItemModel::LocalRole);
+
+    // the search index, so typing in the search field does not go through KPluginInfo
+    setSearchText(info.name() + QLatin1Char('\n') + info.comment());
+    if (m_info.service()) {
+        const QStringList keywords = m_info.property(QStringLiteral("Keywords")).toStringList();
+        m_keywords.reserve(keywords.count());
+        for (const QString &keyword : keywords) {
+            m_keywords << keyword.toCaseFolded();
+        }
+    }
 }
 
 QString PlasmaAppletItem::pluginName() const
@@ -131,12 +141,9 @@ void PlasmaAppletItem::setRunning(int count)
 
 bool PlasmaAppletItem::matches(const QString &pattern) const
 {
-    if (m_info.service()) {
-        const QStringList keywords = m_info.property(QStringLiteral("Keywords")).toStringList();
-        foreach (const QString &keyword, keywords) {
-            if (keyword.startsWith(pattern, Qt::CaseInsensitive)) {
-                return true;
-            }
+    for (const QString &keyword : m_keywords) {
+        if (keyword.startsWith(pattern)) {
+            return true;
         }
     }
 
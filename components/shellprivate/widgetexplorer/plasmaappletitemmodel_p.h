@@ -59,6 +59,7 @@ private:
     KPluginInfo m_info;
     QString m_screenshot;
     QString m_icon;
+    QStringList m_keywords;
     int m_runningCount;
     bool m_local;
 };
@@ -163,7 +163,34 @@ void Multiplexer::playerUpdated(const QString &name, const Plasma::DataEngine::D
 {
     Q_UNUSED(name);
     Q_UNUSED(newData);
-    evaluatePlayer(qobject_cast<PlayerContainer *>(sender()));
+
+    PlayerContainer *container = qobject_cast<PlayerContainer *>(sender());
+    if (needsEvaluation(container)) {
+        evaluatePlayer(container);
+    }
+}
+
+bool Multiplexer::needsEvaluation(PlayerContainer *container) const
+{
+    const QString name = container->objectName();
+    if (name == m_activeName) {
+        return true;
+    }
+
+    // Other players only matter once they change their state or start proxying,
+    // e.g. not for every position or metadata change of a background browser tab
+    const auto proxyPid = container->data().value(QStringLiteral("Metadata")).toMap().value(QStringLiteral("kde:pid")).toUInt();
+    if (proxyPid && !m_proxies.contains(proxyPid)) {
+        return true;
+    }
+
+    const QString status = container->data().value(QStringLiteral("PlaybackStatus")).toString();
+    if (status == QLatin1String("Playing")) {
+        return !m_playing.contains(name);
+    } else if (status == QLatin1String("Paused")) {
+        return !m_paused.contains(name);
+    }
+    return !m_stopped.contains(name);
 }
 
 PlayerContainer *Multiplexer::firstPlayerFromHash(const QHash<QString, PlayerContainer *> &hash, PlayerContainer **proxyCandidate) const
@@ -234,13 +261,26 @@ void Multiplexer::setBestActive()
 
 void Multiplexer::replaceData(const Plasma::DataEngine::Data &data)
 {
-    removeAllData();
+    const QString sourceNameKey = QStringLiteral("Source Name");
+    const Plasma::DataEngine::Data current = this->data();
+
+    // Only touch what changed, so an unchanged player doesn't cause an update
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (it.key() != sourceNameKey && !data.contains(it.key())) {
+            setData(it.key(), QVariant());
+        }
+    }
 
     Plasma::DataEngine::Data::const_iterator it = data.constBegin();
     while (it != data.constEnd()) {
-        setData(it.key(), it.value());
+        if (current.value(it.key()) != it.value()) {
+            setData(it.key(), it.value());
+        }
         ++it;
     }
-    setData(QStringLiteral("Source Name"), m_activeName);
+
+    if (current.value(sourceNameKey) != m_activeName) {
+        setData(sourceNameKey, m_activeName);
+    }
 }
 
@@ -47,6 +47,7 @@ private Q_SLOTS:
 
 private:
     void evaluatePlayer(PlayerContainer *container);
+    bool needsEvaluation(PlayerContainer *container) const;
     void setBestActive();
     void replaceData(const Plasma::DataEngine::Data &data);
     PlayerContainer *firstPlayerFromHash(const QHash<QString, PlayerContainer *> &hash, PlayerContainer **proxyCandidate) const;
@@ -144,6 +144,10 @@ PlayerContainer::PlayerContainer(const QString& busAddress, QObject* parent)
     connect(m_playerIface, &OrgMprisMediaPlayer2PlayerInterface::Seeked,
             this,          &PlayerContainer::seeked);
 
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(0);
+    connect(&m_updateTimer, &QTimer::timeout, this, &PlayerContainer::checkForUpdate);
+
     refresh();
 }
 
@@ -254,8 +258,9 @@ void PlayerContainer::copyProperty(const QString& propName, const QVariant& _val
 
         } else if (propName == QLatin1String("PlaybackStatus")) {
 
+            // the player knows best where it stopped or started again
             if (data().contains(QLatin1String("Position")) && data().contains(QLatin1String("PlaybackStatus"))) {
-                updatePosition();
+                fetchPosition();
             }
 
             // update the effective rate
@@ -352,6 +357,19 @@ void PlayerContainer::getPropsFinished(QDBusPendingCallWatcher* watcher)
 }
 
 void PlayerContainer::updatePosition()
+{
+    // Seeked, PlaybackStatus and Rate changes keep the last known
+    // position accurate, no need to ask the player every time
+    if (data().contains(QLatin1String("Position")) && data().contains(QLatin1String(POS_UPD_STRING))) {
+        recalculatePosition();
+        scheduleUpdate();
+        return;
+    }
+
+    fetchPosition();
+}
+
+void PlayerContainer::fetchPosition()
 {
     QDBusPendingCall async = m_propsIface->Get(OrgMprisMediaPlayer2PlayerInterface::staticInterfaceName(), QStringLiteral("Position"));
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(async, this);
@@ -374,7 +392,7 @@ void PlayerContainer::getPositionFinished(QDBusPendingCallWatcher* watcher)
 
     setData(QStringLiteral("Position"), propsReply.value().toLongLong());
     setData(POS_UPD_STRING, QDateTime::currentDateTimeUtc());
-    checkForUpdate();
+    scheduleUpdate();
 }
 
 void PlayerContainer::propertiesChanged(
@@ -388,14 +406,23 @@ void PlayerContainer::propertiesChanged(
     if (!invalidatedProperties.isEmpty()) {
         refresh();
     }
-    checkForUpdate();
+    scheduleUpdate();
 }
 
 void PlayerContainer::seeked(qlonglong position)
 {
     setData(QStringLiteral("Position"), position);
     setData(POS_UPD_STRING, QDateTime::currentDateTimeUtc());
-    checkForUpdate();
+    scheduleUpdate();
+}
+
+void PlayerContainer::scheduleUpdate()
+{
+    // players tend to send several PropertiesChanged in a row, e.g. for
+    // the metadata and the playback status of a new track
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
 }
 
 void PlayerContainer::recalculatePosition()
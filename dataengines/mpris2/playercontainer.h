@@ -22,6 +22,7 @@
 
 #include <Plasma/DataContainer>
 #include <QFlags>
+#include <QTimer>
 
 class OrgFreedesktopDBusPropertiesInterface;
 class OrgMprisMediaPlayer2Interface;
@@ -64,6 +65,11 @@ public:
     };
 
     void refresh();
+    /**
+     * Brings the Position up to date. It is extrapolated from the last
+     * known position and the playback rate, the player is only asked
+     * when nothing is known yet.
+     */
     void updatePosition();
 
 Q_SIGNALS:
@@ -82,7 +88,9 @@ private Q_SLOTS:
 private:
     void copyProperty(const QString& propName, const QVariant& value, QVariant::Type expType, UpdateType updType);
     void updateFromMap(const QVariantMap& map, UpdateType updType);
+    void fetchPosition();
     void recalculatePosition();
+    void scheduleUpdate();
 
     Caps                                   m_caps;
     int                                    m_fetchesPending;
@@ -91,6 +99,8 @@ private:
     OrgMprisMediaPlayer2Interface         *m_rootIface;
     OrgMprisMediaPlayer2PlayerInterface   *m_playerIface;
     double                                 m_currentRate;
+    // collects the changes of one event loop iteration into one update
+    QTimer                                 m_updateTimer;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(PlayerContainer::Caps)
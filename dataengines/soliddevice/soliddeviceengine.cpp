@@ -27,11 +27,12 @@
 #include <QApplication>
 #include <QDebug>
 #include <KFormat>
-#include <KIO/FileSystemFreeSpaceJob>
 #include <KNotification>
 
 #include <Plasma/DataContainer>
 
+#include <freespacemonitor.h>
+
 //TODO: implement in libsolid2
 namespace
 {
@@ -60,10 +61,18 @@ SolidDeviceEngine::SolidDeviceEngine(QObject* parent, const QVariantList& args)
     setMinimumPollingInterval(1000);
     connect(this, &Plasma::DataEngine::sourceRemoved,
             this, &SolidDeviceEngine::sourceWasRemoved);
+
+    connect(FreeSpaceMonitor::self(), &FreeSpaceMonitor::freeSpaceChanged,
+            this, &SolidDeviceEngine::freeSpaceChanged);
+    connect(FreeSpaceMonitor::self(), &FreeSpaceMonitor::notResponding,
+            this, &SolidDeviceEngine::fileSystemNotResponding);
 }
 
 SolidDeviceEngine::~SolidDeviceEngine()
 {
+    for (const QString &path : qAsConst(m_watchedPaths)) {
+        FreeSpaceMonitor::self()->unwatch(path);
+    }
 }
 
 Plasma::Service* SolidDeviceEngine::serviceForSource(const QString& source)
@@ -115,6 +124,7 @@ bool SolidDeviceEngine::sourceRequestEvent(const QString &name)
 
 void SolidDeviceEngine::sourceWasRemoved(const QString &source)
 {
+    stopWatchingStorageSpace(source);
     m_devicemap.remove(source);
     m_predicatemap.remove(source);
 }
@@ -546,46 +556,62 @@ bool SolidDeviceEngine::updateStorageSpace(const QString &udi)
 
     Solid::StorageAccess *storageaccess = device.as<Solid::StorageAccess>();
     if (!storageaccess || !storageaccess->isAccessible()) {
+        stopWatchingStorageSpace(udi);
         return false;
     }
 
-    QString path = storageaccess->filePath();
-    if (!m_paths.contains(path)) {
-        QTimer *timer = new QTimer(this);
-        timer->setSingleShot(true);
-        connect(timer, &QTimer::timeout, [path]() {
-            KNotification::event(KNotification::Error, i18n("Filesystem is not responding"),
-                                 i18n("Filesystem mounted at '%1' is not responding", path));
-        });
-
-        m_paths.insert(path);
+    // The monitor checks the file system in the background and tells us
+    // about changes, polling only hands out what it already knows.
+    const QString path = storageaccess->filePath();
+    const QString watchedPath = m_watchedPaths.value(udi);
+    if (watchedPath != path) {
+        stopWatchingStorageSpace(udi);
+        m_watchedPaths.insert(udi, path);
+        FreeSpaceMonitor::self()->watch(path);
+    }
 
-        // create job
-        KIO::FileSystemFreeSpaceJob *job = KIO::fileSystemFreeSpace(QUrl::fromLocalFile(path));
+    const FreeSpaceMonitor::Info info = FreeSpaceMonitor::self()->info(path);
+    if (info.valid) {
+        setStorageSpaceData(udi, info.size, info.available);
+    }
 
-        // delete later timer
-        connect(job, &KIO::FileSystemFreeSpaceJob::result, timer, &QTimer::deleteLater);
+    return false;
+}
 
-        // collect and process info
-        connect(job, &KIO::FileSystemFreeSpaceJob::result, this,
-                [this, timer, path, udi](KIO::Job *job, KIO::filesize_t size, KIO::filesize_t available) {
-            timer->stop();
+void SolidDeviceEngine::stopWatchingStorageSpace(const QString &udi)
+{
+    const QString path = m_watchedPaths.take(udi);
+    if (!path.isEmpty()) {
+        FreeSpaceMonitor::self()->unwatch(path);
+    }
+}
 
-            if (!job->error()) {
-                setData(udi, I18N_NOOP("Free Space"), QVariant(available).toDouble());
-                setData(udi, I18N_NOOP("Free Space Text"), KFormat().formatByteSize(available));
-                setData(udi, I18N_NOOP("Size"), QVariant(size).toDouble());
-                setData(udi, I18N_NOOP("Size Text"), KFormat().formatByteSize(size));
-            }
+void SolidDeviceEngine::setStorageSpaceData(const QString &udi, quint64 size, quint64 available)
+{
+    setData(udi, I18N_NOOP("Free Space"), QVariant(available).toDouble());
+    setData(udi, I18N_NOOP("Free Space Text"), KFormat().formatByteSize(available));
+    setData(udi, I18N_NOOP("Size"), QVariant(size).toDouble());
+    setData(udi, I18N_NOOP("Size Text"), KFormat().formatByteSize(size));
+}
 
-            m_paths.remove(path);
-        });
+void SolidDeviceEngine::freeSpaceChanged(const QString &path, quint64 size, quint64 available)
+{
+    for (auto it = m_watchedPaths.constBegin(), end = m_watchedPaths.constEnd(); it != end; ++it) {
+        if (it.value() == path) {
+            setStorageSpaceData(it.key(), size, available);
+        }
+    }
+}
 
-        // start timer: after 15 seconds we will get an error
-        timer->start(15000);
+void SolidDeviceEngine::fileSystemNotResponding(const QString &path)
+{
+    const auto paths = m_watchedPaths.values();
+    if (!paths.contains(path)) {
+        return;
     }
 
-    return false;
+    KNotification::event(KNotification::Error, i18n("Filesystem is not responding"),
+                         i18n("Filesystem mounted at '%1' is not responding", path));
 }
 
 bool SolidDeviceEngine::updateHardDiskTemperature(const QString &udi)
@@ -697,6 +723,7 @@ void SolidDeviceEngine::deviceRemoved(const QString& udi)
         }
     }
 
+    stopWatchingStorageSpace(udi);
     m_devicemap.remove(udi);
     removeSource(udi);
 }
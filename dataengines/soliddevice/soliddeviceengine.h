@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QMap>
 #include <QPair>
 
@@ -35,7 +36,6 @@
 #include "devicesignalmapmanager.h"
 #include "devicesignalmapper.h"
 #include "hddtemp.h"
-#include <KIO/FileSystemFreeSpaceJob>
 
 enum State {
     Idle = 0,
@@ -69,6 +69,8 @@ protected:
 private:
     bool populateDeviceData(const QString &name);
     bool updateStorageSpace(const QString &udi);
+    void stopWatchingStorageSpace(const QString &udi);
+    void setStorageSpaceData(const QString &udi, quint64 size, quint64 available);
     bool updateHardDiskTemperature(const QString &udi);
     bool updateEmblems(const QString &udi);
     bool updateInUse(const QString &udi);
@@ -81,8 +83,8 @@ private:
     QMap<QString, Solid::Device> m_devicemap;
     //udi, corresponding encrypted container udi;
     QMap<QString, QString> m_encryptedContainerMap;
-    //path, for pending file system free space jobs
-    QSet<QString> m_paths;
+    //udi, mount point whose free space is being watched
+    QHash<QString, QString> m_watchedPaths;
     DeviceSignalMapManager *m_signalmanager;
 
     HddTemp *m_temperature;
@@ -97,6 +99,8 @@ private Q_SLOTS:
     void setUnmountingState(const QString &udi);
     void setIdleState(Solid::ErrorType error, QVariant errorData, const QString &udi);
     void deviceChanged(const QMap<QString,int> & props);
+    void freeSpaceChanged(const QString &path, quint64 size, quint64 available);
+    void fileSystemNotResponding(const QString &path);
 };
 
 #endif
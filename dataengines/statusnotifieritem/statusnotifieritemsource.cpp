@@ -36,12 +36,33 @@
 #include <QImage>
 #include <QMenu>
 #include <QPixmap>
-#include <QSysInfo>
 
-#include <netinet/in.h>
+#include <QCache>
+#include <QtEndian>
 
 #include <dbusmenuimporter.h>
 
+namespace {
+
+// Decoded pixmap icons, shared by all items and keyed by their raw data:
+// items keep sending the same few images, e.g. when blinking or when their
+// tooltip repeats the icon. The cost is in KiB.
+typedef QCache<quint64, QIcon> IconCache;
+Q_GLOBAL_STATIC_WITH_ARGS(IconCache, iconCache, (8 * 1024))
+
+quint64 imageVectorKey(const KDbusImageVector &vector)
+{
+    uint low = uint(vector.size());
+    uint high = ~low;
+    for (const KDbusImageStruct &image : vector) {
+        low = qHashBits(image.data.constData(), image.data.size(), low ^ qHash(image.width));
+        high = qHashBits(image.data.constData(), image.data.size(), high ^ qHash(image.height));
+    }
+    return (quint64(high) << 32) | low;
+}
+
+}
+
 class PlasmaDBusMenuImporter : public DBusMenuImporter
 {
 public:
@@ -64,6 +85,9 @@ StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId
     : Plasma::DataContainer(parent),
       m_customIconLoader(nullptr),
       m_menuImporter(nullptr),
+      m_pendingFetches(0),
+      m_fetchFailed(false),
+      m_fullRefresh(true),
       m_refreshing(false),
       m_needsReRefreshing(false),
       m_titleUpdate(true),
@@ -129,8 +153,8 @@ StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId
     if (m_valid) {
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewTitle, this, &StatusNotifierItemSource::refreshTitle);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewIcon, this, &StatusNotifierItemSource::refreshIcons);
-        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewAttentionIcon, this, &StatusNotifierItemSource::refreshIcons);
-        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewOverlayIcon, this, &StatusNotifierItemSource::refreshIcons);
+        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewAttentionIcon, this, &StatusNotifierItemSource::refreshAttentionIcon);
+        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewOverlayIcon, this, &StatusNotifierItemSource::refreshOverlayIcon);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewToolTip, this, &StatusNotifierItemSource::refreshToolTip);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewStatus, this, &StatusNotifierItemSource::syncStatus);
         refresh();
@@ -165,18 +189,35 @@ void StatusNotifierItemSource::syncStatus(QString status)
 void StatusNotifierItemSource::refreshTitle()
 {
     m_titleUpdate = true;
+    m_pendingParts |= TitlePart;
     refresh();
 }
 
 void StatusNotifierItemSource::refreshIcons()
 {
     m_iconUpdate = true;
+    m_pendingParts |= IconPart;
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshAttentionIcon()
+{
+    m_iconUpdate = true;
+    m_pendingParts |= AttentionIconPart;
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshOverlayIcon()
+{
+    m_iconUpdate = true;
+    m_pendingParts |= OverlayIconPart;
     refresh();
 }
 
 void StatusNotifierItemSource::refreshToolTip()
 {
     m_tooltipUpdate = true;
+    m_pendingParts |= ToolTipPart;
     refresh();
 }
 
@@ -195,45 +236,143 @@ void StatusNotifierItemSource::performRefresh()
     }
 
     m_refreshing = true;
-    QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
-                                                          m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
 
-    message << m_statusNotifierItemInterface->interface();
-    QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, &StatusNotifierItemSource::refreshCallback);
+    // The first refresh fetches everything, afterwards only the properties
+    // announced by the New* signals are requested again
+    QStringList names;
+    if (!m_fullRefresh) {
+        if (m_pendingParts & TitlePart) {
+            names << QStringLiteral("Title");
+        }
+        if (m_pendingParts & IconPart) {
+            names << QStringLiteral("IconName") << QStringLiteral("IconPixmap");
+        }
+        if (m_pendingParts & AttentionIconPart) {
+            names << QStringLiteral("AttentionIconName") << QStringLiteral("AttentionIconPixmap")
+                  << QStringLiteral("AttentionMovieName");
+        }
+        if (m_pendingParts & OverlayIconPart) {
+            names << QStringLiteral("OverlayIconName") << QStringLiteral("OverlayIconPixmap");
+        }
+        if (m_pendingParts & ToolTipPart) {
+            names << QStringLiteral("ToolTip");
+        }
+        // items like libappindicator ones move their theme path along with a new icon
+        if (m_pendingParts & (IconPart | AttentionIconPart | OverlayIconPart)) {
+            names << QStringLiteral("IconThemePath");
+        }
+        if (names.isEmpty()) {
+            m_refreshing = false;
+            return;
+        }
+        // some items only export their menu after they got registered
+        if (!m_menuImporter) {
+            names << QStringLiteral("Menu");
+        }
+    }
+
+    m_fetchingParts = m_fullRefresh ? AllParts : m_pendingParts;
+    m_pendingParts = RefreshParts();
+
+    // when several signals came in at once one GetAll is cheaper than
+    // a call for each of their properties
+    if (m_fullRefresh || names.count() > 4) {
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
+
+        message << m_statusNotifierItemInterface->interface();
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &StatusNotifierItemSource::refreshCallback);
+        return;
+    }
+
+    m_fetchedProperties.clear();
+    m_pendingFetches = names.count();
+    m_fetchFailed = false;
+    for (const QString &name : qAsConst(names)) {
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+
+        message << m_statusNotifierItemInterface->interface() << name;
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        watcher->setProperty("propertyName", name);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &StatusNotifierItemSource::propertyCallback);
+    }
 }
 
-/**
-  \todo add a smart pointer to guard call and to automatically delete it at the end of the function
-  */
 void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<QVariantMap> reply = *call;
+    call->deleteLater();
+
+    if (!reply.isError()) {
+        m_fullRefresh = false;
+    }
+    finishRefresh(!reply.isError(), reply.isError() ? QVariantMap() : reply.argumentAt<0>(), m_fetchingParts);
+}
+
+void StatusNotifierItemSource::propertyCallback(QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<QDBusVariant> reply = *call;
+    call->deleteLater();
+
+    if (reply.isError()) {
+        // optional properties an item doesn't implement are simply left empty,
+        // like GetAll would do
+        const QDBusError::ErrorType type = reply.error().type();
+        if (type != QDBusError::InvalidArgs && type != QDBusError::UnknownProperty) {
+            m_fetchFailed = true;
+        }
+    } else {
+        m_fetchedProperties.insert(call->property("propertyName").toString(), reply.value().variant());
+    }
+
+    if (--m_pendingFetches > 0) {
+        return;
+    }
+
+    const QVariantMap properties = m_fetchedProperties;
+    m_fetchedProperties.clear();
+    finishRefresh(!m_fetchFailed, properties, m_fetchingParts);
+}
+
+void StatusNotifierItemSource::finishRefresh(bool success, const QVariantMap &properties, RefreshParts parts)
 {
     m_refreshing = false;
     if (m_needsReRefreshing) {
         m_needsReRefreshing = false;
+        // what was just fetched is dropped, so fetch it again
+        m_pendingParts |= parts;
         performRefresh();
-        call->deleteLater();
         return;
     }
 
-    QDBusPendingReply<QVariantMap> reply = *call;
-    if (reply.isError()) {
-        m_valid = false;
+    if (success) {
+        applyProperties(properties, parts);
     } else {
-        // record what has changed
-        setData(QStringLiteral("TitleChanged"), m_titleUpdate);
-        m_titleUpdate = false;
-        setData(QStringLiteral("IconsChanged"), m_iconUpdate);
-        m_iconUpdate = false;
-        setData(QStringLiteral("ToolTipChanged"), m_tooltipUpdate);
-        m_tooltipUpdate = false;
-        setData(QStringLiteral("StatusChanged"), m_statusUpdate);
-        m_statusUpdate = false;
-
-        //IconThemePath (handle this one first, because it has an impact on
-        //others)
-        QVariantMap properties = reply.argumentAt<0>();
+        m_valid = false;
+    }
+
+    checkForUpdate();
+}
+
+void StatusNotifierItemSource::applyProperties(const QVariantMap &properties, RefreshParts parts)
+{
+    // record what has changed
+    setData(QStringLiteral("TitleChanged"), m_titleUpdate);
+    m_titleUpdate = false;
+    setData(QStringLiteral("IconsChanged"), m_iconUpdate);
+    m_iconUpdate = false;
+    setData(QStringLiteral("ToolTipChanged"), m_tooltipUpdate);
+    m_tooltipUpdate = false;
+    setData(QStringLiteral("StatusChanged"), m_statusUpdate);
+    m_statusUpdate = false;
+
+    //IconThemePath (handle this one first, because it has an impact on
+    //others), fetched with every icon part
+    if (parts == AllParts || properties.contains(QStringLiteral("IconThemePath"))) {
         QString path = properties[QStringLiteral("IconThemePath")].toString();
 
         if (!path.isEmpty() && path != data()[QStringLiteral("IconThemePath")].toString()) {
@@ -255,131 +394,136 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
             m_customIconLoader->addAppDir(appName.size() ? appName : QStringLiteral("unused"), path);
         }
         setData(QStringLiteral("IconThemePath"), path);
+    }
 
+    if (parts == AllParts) {
         setData(QStringLiteral("Category"), properties[QStringLiteral("Category")]);
         setData(QStringLiteral("Status"), properties[QStringLiteral("Status")]);
-        setData(QStringLiteral("Title"), properties[QStringLiteral("Title")]);
         setData(QStringLiteral("Id"), properties[QStringLiteral("Id")]);
         setData(QStringLiteral("WindowId"), properties[QStringLiteral("WindowId")]);
         setData(QStringLiteral("ItemIsMenu"), properties[QStringLiteral("ItemIsMenu")]);
+    }
 
-        //Attention Movie
-        setData(QStringLiteral("AttentionMovieName"), properties[QStringLiteral("AttentionMovieName")]);
+    if (parts & TitlePart) {
+        setData(QStringLiteral("Title"), properties[QStringLiteral("Title")]);
+    }
 
-        QIcon overlay;
-        QStringList overlayNames;
-
-        //Icon
-        {
-            KDbusImageVector image;
-            QIcon icon;
-            QString iconName;
-
-            properties[QStringLiteral("OverlayIconPixmap")].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                QString iconName = properties[QStringLiteral("OverlayIconName")].toString();
-                setData(QStringLiteral("OverlayIconName"), iconName);
-                if (!iconName.isEmpty()) {
-                    overlayNames << iconName;
-                    overlay = QIcon(new KIconEngine(iconName, iconLoader()));
-                }
-            } else {
-                overlay = imageVectorToPixmap(image);
+    if (parts & OverlayIconPart) {
+        KDbusImageVector image;
+        properties[QStringLiteral("OverlayIconPixmap")].value<QDBusArgument>() >> image;
+        m_overlay = QIcon();
+        m_overlayNames.clear();
+        if (image.isEmpty()) {
+            QString iconName = properties[QStringLiteral("OverlayIconName")].toString();
+            setData(QStringLiteral("OverlayIconName"), iconName);
+            if (!iconName.isEmpty()) {
+                m_overlayNames << iconName;
+                m_overlay = QIcon(new KIconEngine(iconName, iconLoader()));
             }
+        } else {
+            m_overlay = imageVectorToPixmap(image);
+        }
+    }
 
-            properties[QStringLiteral("IconPixmap")].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                iconName = properties[QStringLiteral("IconName")].toString();
-                if (!iconName.isEmpty()) {
-                    icon = QIcon(new KIconEngine(iconName, iconLoader(), overlayNames));
-
-                    if (overlayNames.isEmpty() && !overlay.isNull()) {
-                        overlayIcon(&icon, &overlay);
-                    }
-                }
-            } else {
-                icon = imageVectorToPixmap(image);
-                if (!icon.isNull() && !overlay.isNull()) {
-                    overlayIcon(&icon, &overlay);
-                }
-            }
-            setData(QStringLiteral("Icon"), icon);
-            setData(QStringLiteral("IconName"), iconName);
+    //Icon
+    if (parts & IconPart) {
+        KDbusImageVector image;
+        properties[QStringLiteral("IconPixmap")].value<QDBusArgument>() >> image;
+        if (image.isEmpty()) {
+            m_iconName = properties[QStringLiteral("IconName")].toString();
+            m_iconPixmap = QIcon();
+        } else {
+            m_iconName.clear();
+            m_iconPixmap = imageVectorToPixmap(image);
         }
+    }
+    if (parts & (IconPart | OverlayIconPart)) {
+        setData(QStringLiteral("Icon"), composeIcon(m_iconName, m_iconPixmap));
+        setData(QStringLiteral("IconName"), m_iconName);
+    }
 
-        //Attention icon
-        {
-            KDbusImageVector image;
-            QIcon attentionIcon;
+    //Attention icon
+    if (parts & AttentionIconPart) {
+        //Attention Movie
+        setData(QStringLiteral("AttentionMovieName"), properties[QStringLiteral("AttentionMovieName")]);
 
-            properties[QStringLiteral("AttentionIconPixmap")].value<QDBusArgument>() >> image;
-            if (image.isEmpty()) {
-                QString iconName = properties[QStringLiteral("AttentionIconName")].toString();
-                setData(QStringLiteral("AttentionIconName"), iconName);
-                if (!iconName.isEmpty()) {
-                    attentionIcon = QIcon(new KIconEngine(iconName, iconLoader(), overlayNames));
+        KDbusImageVector image;
+        properties[QStringLiteral("AttentionIconPixmap")].value<QDBusArgument>() >> image;
+        if (image.isEmpty()) {
+            m_attentionIconName = properties[QStringLiteral("AttentionIconName")].toString();
+            m_attentionIconPixmap = QIcon();
+            setData(QStringLiteral("AttentionIconName"), m_attentionIconName);
+        } else {
+            m_attentionIconName.clear();
+            m_attentionIconPixmap = imageVectorToPixmap(image);
+        }
+    }
+    if (parts & (AttentionIconPart | OverlayIconPart)) {
+        setData(QStringLiteral("AttentionIcon"), composeIcon(m_attentionIconName, m_attentionIconPixmap));
+    }
 
-                    if (overlayNames.isEmpty() && !overlay.isNull()) {
-                        overlayIcon(&attentionIcon, &overlay);
-                    }
-                }
+    //ToolTip
+    if (parts & ToolTipPart) {
+        KDbusToolTipStruct toolTip;
+        properties[QStringLiteral("ToolTip")].value<QDBusArgument>() >> toolTip;
+        if (toolTip.title.isEmpty()) {
+            setData(QStringLiteral("ToolTipTitle"), QString());
+            setData(QStringLiteral("ToolTipSubTitle"), QString());
+            setData(QStringLiteral("ToolTipIcon"), QString());
+        } else {
+            QIcon toolTipIcon;
+            if (toolTip.image.size() == 0) {
+                toolTipIcon = QIcon(new KIconEngine(toolTip.icon, iconLoader()));
             } else {
-                attentionIcon = imageVectorToPixmap(image);
-                if (!attentionIcon.isNull() && !overlay.isNull()) {
-                    overlayIcon(&attentionIcon, &overlay);
-                }
+                toolTipIcon = imageVectorToPixmap(toolTip.image);
             }
-            setData(QStringLiteral("AttentionIcon"), attentionIcon);
-        }
-
-        //ToolTip
-        {
-            KDbusToolTipStruct toolTip;
-            properties[QStringLiteral("ToolTip")].value<QDBusArgument>() >> toolTip;
-            if (toolTip.title.isEmpty()) {
-                setData(QStringLiteral("ToolTipTitle"), QString());
-                setData(QStringLiteral("ToolTipSubTitle"), QString());
+            setData(QStringLiteral("ToolTipTitle"), toolTip.title);
+            setData(QStringLiteral("ToolTipSubTitle"), toolTip.subTitle);
+            if (toolTipIcon.isNull() || toolTipIcon.availableSizes().isEmpty()) {
                 setData(QStringLiteral("ToolTipIcon"), QString());
             } else {
-                QIcon toolTipIcon;
-                if (toolTip.image.size() == 0) {
-                    toolTipIcon = QIcon(new KIconEngine(toolTip.icon, iconLoader()));
-                } else {
-                    toolTipIcon = imageVectorToPixmap(toolTip.image);
-                }
-                setData(QStringLiteral("ToolTipTitle"), toolTip.title);
-                setData(QStringLiteral("ToolTipSubTitle"), toolTip.subTitle);
-                if (toolTipIcon.isNull() || toolTipIcon.availableSizes().isEmpty()) {
-                    setData(QStringLiteral("ToolTipIcon"), QString());
-                } else {
-                    setData(QStringLiteral("ToolTipIcon"), toolTipIcon);
-                }
+                setData(QStringLiteral("ToolTipIcon"), toolTipIcon);
             }
         }
+    }
 
-        //Menu
-        if (!m_menuImporter) {
-            QString menuObjectPath = properties[QStringLiteral("Menu")].value<QDBusObjectPath>().path();
-            if (!menuObjectPath.isEmpty()) {
-                if (menuObjectPath == QLatin1String("/NO_DBUSMENU")) {
-                    // This is a hack to make it possible to disable DBusMenu in an
-                    // application. The string "/NO_DBUSMENU" must be the same as in
-                    // KStatusNotifierItem::setContextMenu().
-                    qWarning() << "DBusMenu disabled for this application";
-                } else {
-                    m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
-                    connect(m_menuImporter, &PlasmaDBusMenuImporter::menuUpdated, this, [this](QMenu *menu) {
-                        if (menu == m_menuImporter->menu()) {
-                            contextMenuReady();
-                        }
-                    });
-                }
+    //Menu
+    if (!m_menuImporter) {
+        QString menuObjectPath = properties[QStringLiteral("Menu")].value<QDBusObjectPath>().path();
+        if (!menuObjectPath.isEmpty()) {
+            if (menuObjectPath == QLatin1String("/NO_DBUSMENU")) {
+                // This is a hack to make it possible to disable DBusMenu in an
+                // application. The string "/NO_DBUSMENU" must be the same as in
+                // KStatusNotifierItem::setContextMenu().
+                qWarning() << "DBusMenu disabled for this application";
+            } else {
+                m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
+                connect(m_menuImporter, &PlasmaDBusMenuImporter::menuUpdated, this, [this](QMenu *menu) {
+                    if (menu == m_menuImporter->menu()) {
+                        contextMenuReady();
+                    }
+                });
             }
         }
     }
+}
 
-    checkForUpdate();
-    call->deleteLater();
+QIcon StatusNotifierItemSource::composeIcon(const QString &name, const QIcon &pixmapIcon)
+{
+    QIcon icon;
+    if (!name.isEmpty()) {
+        icon = QIcon(new KIconEngine(name, iconLoader(), m_overlayNames));
+
+        if (m_overlayNames.isEmpty() && !m_overlay.isNull()) {
+            overlayIcon(&icon, &m_overlay);
+        }
+    } else if (!pixmapIcon.isNull()) {
+        icon = pixmapIcon;
+        if (!m_overlay.isNull()) {
+            overlayIcon(&icon, &m_overlay);
+        }
+    }
+    return icon;
 }
 
 void StatusNotifierItemSource::contextMenuReady()
@@ -389,39 +533,34 @@ void StatusNotifierItemSource::contextMenuReady()
 
 QPixmap StatusNotifierItemSource::KDbusImageStructToPixmap(const KDbusImageStruct &image) const
 {
-    //swap from network byte order if we are little endian
-    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-        uint *uintBuf = (uint *) image.data.data();
-        for (uint i = 0; i < image.data.size()/sizeof(uint); ++i) {
-            *uintBuf = ntohl(*uintBuf);
-            ++uintBuf;
-        }
-    }
-    if (image.width == 0 || image.height == 0) {
+    if (image.width <= 0 || image.height <= 0
+        || image.data.size() / 4 < image.width * image.height) {
         return QPixmap();
     }
 
-    //avoid a deep copy of the image data
-    //we need to keep a reference to the image.data alive for the lifespan of the image, even if the image is copied
-    //we create a new QByteArray with a shallow copy of the original data on the heap, then delete this in the QImage cleanup
-    auto dataRef = new QByteArray(image.data);
-
-    QImage iconImage(reinterpret_cast<const uchar*>(dataRef->data()), image.width, image.height, QImage::Format_ARGB32,
-            [](void* ptr) {
-                delete static_cast<QByteArray*>(ptr);
-            },
-            dataRef);
+    //the data comes in network byte order, convert it straight into the image
+    //qFromBigEndian on a whole buffer uses the SIMD byte swap of QtCore
+    QImage iconImage(image.width, image.height, QImage::Format_ARGB32);
+    qFromBigEndian<quint32>(image.data.constData(), image.width * image.height, iconImage.bits());
     return QPixmap::fromImage(iconImage);
 }
 
 QIcon StatusNotifierItemSource::imageVectorToPixmap(const KDbusImageVector &vector) const
 {
+    const quint64 key = imageVectorKey(vector);
+    if (const QIcon *cached = iconCache()->object(key)) {
+        return *cached;
+    }
+
     QIcon icon;
+    int bytes = 0;
 
     for (int i = 0; i<vector.size(); ++i) {
         icon.addPixmap(KDbusImageStructToPixmap(vector[i]));
+        bytes += vector[i].data.size();
     }
 
+    iconCache()->insert(key, new QIcon(icon), bytes / 1024 + 1);
     return icon;
 }
 
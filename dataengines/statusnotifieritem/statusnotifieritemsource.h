@@ -56,15 +56,30 @@ private Q_SLOTS:
     void contextMenuReady();
     void refreshTitle();
     void refreshIcons();
+    void refreshAttentionIcon();
+    void refreshOverlayIcon();
     void refreshToolTip();
     void refresh();
     void performRefresh();
     void syncStatus(QString);
     void refreshCallback(QDBusPendingCallWatcher *);
+    void propertyCallback(QDBusPendingCallWatcher *);
     void activateCallback(QDBusPendingCallWatcher *);
 
 private:
+    enum RefreshPart {
+        TitlePart = 0x1,
+        IconPart = 0x2,
+        AttentionIconPart = 0x4,
+        OverlayIconPart = 0x8,
+        ToolTipPart = 0x10,
+        AllParts = 0xff
+    };
+    Q_DECLARE_FLAGS(RefreshParts, RefreshPart)
 
+    void finishRefresh(bool success, const QVariantMap &properties, RefreshParts parts);
+    void applyProperties(const QVariantMap &properties, RefreshParts parts);
+    QIcon composeIcon(const QString &name, const QIcon &pixmapIcon);
     QPixmap KDbusImageStructToPixmap(const KDbusImageStruct &image) const;
     QIcon imageVectorToPixmap(const KDbusImageVector &vector) const;
     void overlayIcon(QIcon *icon, QIcon *overlay);
@@ -77,6 +92,19 @@ private:
     KIconLoader *m_customIconLoader;
     DBusMenuImporter *m_menuImporter;
     org::kde::StatusNotifierItem *m_statusNotifierItemInterface;
+    QVariantMap m_fetchedProperties;
+    RefreshParts m_pendingParts;
+    RefreshParts m_fetchingParts;
+    // the icons as sent, kept to decorate them again when only one of them changed
+    QString m_iconName;
+    QIcon m_iconPixmap;
+    QString m_attentionIconName;
+    QIcon m_attentionIconPixmap;
+    QIcon m_overlay;
+    QStringList m_overlayNames;
+    int m_pendingFetches;
+    bool m_fetchFailed : 1;
+    bool m_fullRefresh : 1;
     bool m_refreshing : 1;
     bool m_needsReRefreshing : 1;
     bool m_titleUpdate : 1;
@@ -98,6 +98,7 @@ void TimeEngine::init()
 void TimeEngine::clockSkewed()
 {
     qCDebug(DATAENGINE_TIME) << "Time engine Clock skew signaled";
+    TimeSource::resetCaches();
     updateAllSources();
     forceImmediateUpdateOfAllVisualizations();
 }
@@ -105,6 +106,7 @@ void TimeEngine::clockSkewed()
 void TimeEngine::tzConfigChanged()
 {
     qCDebug(DATAENGINE_TIME) << "Local timezone changed signaled";
+    TimeSource::resetCaches();
     TimeSource *s = qobject_cast<TimeSource *>(containerForSource(QStringLiteral("Local")));
 
     if (s) {
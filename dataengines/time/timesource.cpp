@@ -26,17 +26,93 @@
 
 #include "timesource.h"
 
+#include <QCache>
 #include <QDateTime>
+#include <QHash>
 
 #include <KLocalizedString>
 
 #include "solarsystem.h"
 
+#include <limits>
+
 //timezone is defined in msvc
 #ifdef timezone
 #undef timezone
 #endif
 
+namespace {
+
+// Offset and abbreviation of a zone, they only change at its transitions
+struct ZoneState {
+    qint64 validFrom = 0; // ms since epoch
+    qint64 validUntil = -1;
+    int offset = 0;
+    QString abbreviation;
+};
+
+// shared by all sources of a zone, e.g. every clock showing "Local"
+typedef QHash<QByteArray, ZoneState> ZoneStates;
+Q_GLOBAL_STATIC(ZoneStates, s_zoneStates)
+
+const ZoneState &zoneState(const QTimeZone &tz, const QDateTime &utc)
+{
+    ZoneState &state = (*s_zoneStates())[tz.id()];
+
+    const qint64 now = utc.toMSecsSinceEpoch();
+    if (now >= state.validFrom && now < state.validUntil) {
+        return state;
+    }
+
+    state.offset = tz.offsetFromUtc(utc);
+    state.abbreviation = tz.abbreviation(utc);
+    state.validFrom = now;
+
+    const QTimeZone::OffsetData next = tz.nextTransition(utc);
+    state.validUntil = next.atUtc.isValid() ? next.atUtc.toMSecsSinceEpoch()
+                                            : std::numeric_limits<qint64>::max();
+    return state;
+}
+
+}
+
+enum SolarSystemData {
+    SolarPosition,
+    DailySolarPosition,
+    MoonPosition,
+    DailyMoonPosition
+};
+
+struct SolarSystemKey {
+    SolarSystemData data;
+    qint64 time; // minutes since epoch for positions, julian day for dailies
+    double latitude;
+    double longitude;
+    int offset;
+
+    bool operator==(const SolarSystemKey &other) const
+    {
+        return data == other.data && time == other.time && latitude == other.latitude
+               && longitude == other.longitude && offset == other.offset;
+    }
+};
+
+static uint qHash(const SolarSystemKey &key, uint seed = 0)
+{
+    return ::qHash(key.time, seed) ^ ::qHash(key.latitude, seed) ^ ::qHash(key.longitude, seed)
+           ^ uint(key.offset) ^ (uint(key.data) << 28);
+}
+
+// The same location is usually asked for by several sources, and the
+// calculations are expensive compared to the rest of a tick
+typedef QCache<SolarSystemKey, QVariantMap> SolarSystemCache;
+Q_GLOBAL_STATIC_WITH_ARGS(SolarSystemCache, s_solarSystemCache, (64))
+
+static QDateTime startOfMinute(const QDateTime &dt)
+{
+    return dt.addMSecs(-(dt.time().second() * 1000 + dt.time().msec()));
+}
+
 TimeSource::TimeSource(const QString &name, QObject *parent)
     : Plasma::DataContainer(parent),
       m_offset(0),
@@ -97,19 +173,23 @@ TimeSource::~TimeSource()
     delete m_sun;
 }
 
+void TimeSource::resetCaches()
+{
+    s_zoneStates()->clear();
+    s_solarSystemCache()->clear();
+}
+
 void TimeSource::updateTime()
 {
-    QDateTime timeZoneDateTime = QDateTime::currentDateTime().toTimeZone(m_tz);
+    const QDateTime utc = QDateTime::currentDateTimeUtc();
 
-    int offset = m_tz.offsetFromUtc(timeZoneDateTime);
-    if (m_offset != offset) {
-        m_offset = offset;
-    }
+    const ZoneState &zone = zoneState(m_tz, utc);
+    m_offset = zone.offset;
 
     setData(I18N_NOOP("Offset"), m_offset);
+    setData(I18N_NOOP("Timezone Abbreviation"), zone.abbreviation);
 
-    QString abbreviation = m_tz.abbreviation(timeZoneDateTime);
-    setData(I18N_NOOP("Timezone Abbreviation"), abbreviation);
+    const QDateTime timeZoneDateTime = utc.toTimeZone(m_tz);
 
     QDateTime dt;
     if (m_userDateTime) {
@@ -213,49 +293,84 @@ Moon* TimeSource::moon()
     return m_moon;
 }
 
+void TimeSource::setCachedData(const SolarSystemKey &key, const std::function<void(QVariantMap &)> &calculate)
+{
+    SolarSystemCache *cache = s_solarSystemCache();
+
+    QVariantMap *values = cache->object(key);
+    if (!values) {
+        values = new QVariantMap;
+        calculate(*values);
+        cache->insert(key, values);
+    }
+
+    for (auto it = values->constBegin(), end = values->constEnd(); it != end; ++it) {
+        setData(it.key(), it.value());
+    }
+}
+
 void TimeSource::addMoonPositionData(const QDateTime &dt)
 {
-    Moon* m = moon();
-    m->calcForDateTime(dt, m_offset);
-    setData(QStringLiteral("Moon Azimuth"), m->azimuth());
-    setData(QStringLiteral("Moon Zenith"), 90 - m->altitude());
-    setData(QStringLiteral("Moon Corrected Elevation"), m->calcElevation());
-    setData(QStringLiteral("MoonPhaseAngle"), m->phase());
+    // cached per minute, the moon barely moves in between
+    const QDateTime minute = startOfMinute(dt);
+    const SolarSystemKey key{MoonPosition, minute.toMSecsSinceEpoch() / 60000, m_latitude, m_longitude, m_offset};
+
+    setCachedData(key, [this, &minute](QVariantMap &values) {
+        Moon* m = moon();
+        m->calcForDateTime(minute, m_offset);
+        values.insert(QStringLiteral("Moon Azimuth"), m->azimuth());
+        values.insert(QStringLiteral("Moon Zenith"), 90 - m->altitude());
+        values.insert(QStringLiteral("Moon Corrected Elevation"), m->calcElevation());
+        values.insert(QStringLiteral("MoonPhaseAngle"), m->phase());
+    });
 }
 
 void TimeSource::addDailyMoonPositionData(const QDateTime &dt)
 {
-    Moon* m = moon();
-    QList< QPair<QDateTime, QDateTime> > times = m->timesForAngles(
-            QList<double>() << -0.833, dt, m_offset);
-    setData(QStringLiteral("Moonrise"), times[0].first);
-    setData(QStringLiteral("Moonset"), times[0].second);
-    m->calcForDateTime(QDateTime(dt.date(), QTime(12,0)), m_offset);
-    setData(QStringLiteral("MoonPhase"),  int(m->phase() / 360.0 * 29.0));
+    const SolarSystemKey key{DailyMoonPosition, dt.date().toJulianDay(), m_latitude, m_longitude, m_offset};
+
+    setCachedData(key, [this, &dt](QVariantMap &values) {
+        Moon* m = moon();
+        QList< QPair<QDateTime, QDateTime> > times = m->timesForAngles(
+                QList<double>() << -0.833, dt, m_offset);
+        values.insert(QStringLiteral("Moonrise"), times[0].first);
+        values.insert(QStringLiteral("Moonset"), times[0].second);
+        m->calcForDateTime(QDateTime(dt.date(), QTime(12,0)), m_offset);
+        values.insert(QStringLiteral("MoonPhase"),  int(m->phase() / 360.0 * 29.0));
+    });
 }
 
 void TimeSource::addSolarPositionData(const QDateTime &dt)
 {
-    Sun* s = sun();
-    s->calcForDateTime(dt, m_offset);
-    setData(QStringLiteral("Azimuth"), s->azimuth());
-    setData(QStringLiteral("Zenith"), 90.0 - s->altitude());
-    setData(QStringLiteral("Corrected Elevation"), s->calcElevation());
+    // cached per minute, the sun moves by a quarter of a degree in that time
+    const QDateTime minute = startOfMinute(dt);
+    const SolarSystemKey key{SolarPosition, minute.toMSecsSinceEpoch() / 60000, m_latitude, m_longitude, m_offset};
+
+    setCachedData(key, [this, &minute](QVariantMap &values) {
+        Sun* s = sun();
+        s->calcForDateTime(minute, m_offset);
+        values.insert(QStringLiteral("Azimuth"), s->azimuth());
+        values.insert(QStringLiteral("Zenith"), 90.0 - s->altitude());
+        values.insert(QStringLiteral("Corrected Elevation"), s->calcElevation());
+    });
 }
 
 void TimeSource::addDailySolarPositionData(const QDateTime &dt)
 {
-    Sun* s = sun();
-    QList< QPair<QDateTime, QDateTime> > times = s->timesForAngles(
-            QList<double>() << -0.833 << -6.0 << -12.0 << -18.0, dt, m_offset);
-
-    setData(QStringLiteral("Sunrise"), times[0].first);
-    setData(QStringLiteral("Sunset"), times[0].second);
-    setData(QStringLiteral("Civil Dawn"), times[1].first);
-    setData(QStringLiteral("Civil Dusk"), times[1].second);
-    setData(QStringLiteral("Nautical Dawn"), times[2].first);
-    setData(QStringLiteral("Nautical Dusk"), times[2].second);
-    setData(QStringLiteral("Astronomical Dawn"), times[3].first);
-    setData(QStringLiteral("Astronomical Dusk"), times[3].second);
+    const SolarSystemKey key{DailySolarPosition, dt.date().toJulianDay(), m_latitude, m_longitude, m_offset};
+
+    setCachedData(key, [this, &dt](QVariantMap &values) {
+        Sun* s = sun();
+        QList< QPair<QDateTime, QDateTime> > times = s->timesForAngles(
+                QList<double>() << -0.833 << -6.0 << -12.0 << -18.0, dt, m_offset);
+
+        values.insert(QStringLiteral("Sunrise"), times[0].first);
+        values.insert(QStringLiteral("Sunset"), times[0].second);
+        values.insert(QStringLiteral("Civil Dawn"), times[1].first);
+        values.insert(QStringLiteral("Civil Dusk"), times[1].second);
+        values.insert(QStringLiteral("Nautical Dawn"), times[2].first);
+        values.insert(QStringLiteral("Nautical Dusk"), times[2].second);
+        values.insert(QStringLiteral("Astronomical Dawn"), times[3].first);
+        values.insert(QStringLiteral("Astronomical Dusk"), times[3].second);
+    });
 }
-
@@ -23,8 +23,11 @@
 #include <Plasma/DataContainer>
 #include <QTimeZone>
 
+#include <functional>
+
 class Sun;
 class Moon;
+struct SolarSystemKey;
 
 class TimeSource : public Plasma::DataContainer
 {
@@ -36,12 +39,19 @@ public:
     void setTimeZone(const QString &name);
     void updateTime();
 
+    /**
+     * Forgets the time zone and solar system data shared by all sources,
+     * for when the system time or time zone changed.
+     */
+    static void resetCaches();
+
 private:
     QString parseName(const QString &name);
     void addMoonPositionData(const QDateTime &dt);
     void addDailyMoonPositionData(const QDateTime &dt);
     void addSolarPositionData(const QDateTime &dt);
     void addDailySolarPositionData(const QDateTime &dt);
+    void setCachedData(const SolarSystemKey &key, const std::function<void(QVariantMap &)> &calculate);
     Sun* sun();
     Moon* moon();
 
@@ -26,11 +26,12 @@
 #include <KService>
 
 #include <KIO/ApplicationLauncherJob>
-#include <KIO/FileSystemFreeSpaceJob>
 #include <KIO/OpenUrlJob>
 
 #include <chrono>
 
+#include <freespacemonitor.h>
+
 #include "settings.h"
 
 FreeSpaceNotifier::FreeSpaceNotifier(const QString &path, const KLocalizedString &notificationText, QObject *parent)
@@ -38,94 +39,104 @@ FreeSpaceNotifier::FreeSpaceNotifier(const QString &path, const KLocalizedString
     , m_path(path)
     , m_notificationText(notificationText)
 {
-    connect(&m_timer, &QTimer::timeout, this, &FreeSpaceNotifier::checkFreeDiskSpace);
-    m_timer.start(std::chrono::minutes(1));
+    // The monitor checks more often while the disk is filling up
+    // and only reports back when the free space changed
+    connect(FreeSpaceMonitor::self(), &FreeSpaceMonitor::freeSpaceChanged, this, &FreeSpaceNotifier::checkFreeDiskSpace);
+    FreeSpaceMonitor::self()->watch(m_path);
+    m_watching = true;
 }
 
 FreeSpaceNotifier::~FreeSpaceNotifier()
 {
+    stopWatching();
+
     if (m_notification) {
         m_notification->close();
     }
 }
 
-void FreeSpaceNotifier::checkFreeDiskSpace()
+void FreeSpaceNotifier::stopWatching()
+{
+    if (m_watching) {
+        FreeSpaceMonitor::self()->unwatch(m_path);
+        m_watching = false;
+    }
+}
+
+void FreeSpaceNotifier::checkFreeDiskSpace(const QString &path, quint64 size, quint64 available)
 {
+    if (path != m_path) {
+        return;
+    }
+
     if (!FreeSpaceNotifierSettings::enableNotification()) {
         // do nothing if notifying is disabled;
-        // also stop the timer that probably got us here in the first place
-        m_timer.stop();
+        // also stop watching, which probably got us here in the first place
+        stopWatching();
         return;
     }
 
-    auto *job = KIO::fileSystemFreeSpace(QUrl::fromLocalFile(m_path));
-    connect(job, &KIO::FileSystemFreeSpaceJob::result, this, [this](KIO::Job* job, KIO::filesize_t size, KIO::filesize_t available) {
-        if (job->error()) {
-            return;
-        }
-
-        const int limit = FreeSpaceNotifierSettings::minimumSpace(); // MiB
-        const qint64 avail = available / (1024 * 1024); // to MiB
-
-        if (avail >= limit) {
-            if (m_notification) {
-                m_notification->close();
-            }
-            return;
-        }
+    const int limit = FreeSpaceNotifierSettings::minimumSpace(); // MiB
+    const qint64 avail = available / (1024 * 1024); // to MiB
 
-        const int availPercent = int(100 * available / size);
-        const QString text = m_notificationText.subs(avail).subs(availPercent).toString();
-
-        // Make sure the notification text is always up to date whenever we checked free space
+    if (avail >= limit) {
         if (m_notification) {
-            m_notification->setText(text);
+            m_notification->close();
         }
+        return;
+    }
 
-        // User freed some space, warn if it goes low again
-        if (m_lastAvail > -1 && avail > m_lastAvail) {
-            m_lastAvail = avail;
-            return;
-        }
+    const int availPercent = size > 0 ? int(100 * available / size) : 0;
+    const QString text = m_notificationText.subs(avail).subs(availPercent).toString();
 
-        // Always warn the first time or when available space dropped to half of the previous time
-        const bool warn = (m_lastAvail < 0 || avail < m_lastAvail / 2);
-        if (!warn) {
-            return;
-        }
+    // Make sure the notification text is always up to date whenever we checked free space
+    if (m_notification) {
+        m_notification->setText(text);
+    }
 
+    // User freed some space, warn if it goes low again
+    if (m_lastAvail > -1 && avail > m_lastAvail) {
         m_lastAvail = avail;
+        return;
+    }
 
-        if (!m_notification) {
-            m_notification = new KNotification(QStringLiteral("freespacenotif"));
-            m_notification->setComponentName(QStringLiteral("freespacenotifier"));
-            m_notification->setText(text);
-
-            QStringList actions = {i18n("Configure Warning...")};
+    // Always warn the first time or when available space dropped to half of the previous time
+    const bool warn = (m_lastAvail < 0 || avail < m_lastAvail / 2);
+    if (!warn) {
+        return;
+    }
 
-            auto filelight = filelightService();
-            if (filelight) {
-                actions.prepend(i18n("Open in Filelight"));
-            } else {
-                // Do we really want the user opening Root in a file manager?
-                actions.prepend(i18n("Open in File Manager"));
-            }
+    m_lastAvail = avail;
 
-            m_notification->setActions(actions);
+    if (!m_notification) {
+        m_notification = new KNotification(QStringLiteral("freespacenotif"));
+        m_notification->setComponentName(QStringLiteral("freespacenotifier"));
+        m_notification->setText(text);
 
-            connect(m_notification, QOverload<uint>::of(&KNotification::activated), this, [this](uint actionId) {
-                if (actionId == 1) {
-                    exploreDrive();
-                // TODO once we have "configure" action support in KNotification, wire it up instead of a button
-                } else if (actionId == 2) {
-                    emit configureRequested();
-                }
-            });
+        QStringList actions = {i18n("Configure Warning...")};
 
-            connect(m_notification, &KNotification::closed, this, &FreeSpaceNotifier::onNotificationClosed);
-            m_notification->sendEvent();
+        auto filelight = filelightService();
+        if (filelight) {
+            actions.prepend(i18n("Open in Filelight"));
+        } else {
+            // Do we really want the user opening Root in a file manager?
+            actions.prepend(i18n("Open in File Manager"));
         }
-    });
+
+        m_notification->setActions(actions);
+
+        connect(m_notification, QOverload<uint>::of(&KNotification::activated), this, [this](uint actionId) {
+            if (actionId == 1) {
+                exploreDrive();
+            // TODO once we have "configure" action support in KNotification, wire it up instead of a button
+            } else if (actionId == 2) {
+                emit configureRequested();
+            }
+        });
+
+        connect(m_notification, &KNotification::closed, this, &FreeSpaceNotifier::onNotificationClosed);
+        m_notification->sendEvent();
+    }
 }
 
 KService::Ptr FreeSpaceNotifier::filelightService() const
@@ -41,7 +41,8 @@ signals:
     void configureRequested();
 
 private:
-    void checkFreeDiskSpace();
+    void checkFreeDiskSpace(const QString &path, quint64 size, quint64 available);
+    void stopWatching();
     void resetLastAvailable();
 
     KService::Ptr filelightService() const;
@@ -51,7 +52,7 @@ private:
     QString m_path;
     KLocalizedString m_notificationText;
 
-    QTimer m_timer;
+    bool m_watching = false;
     QTimer *m_lastAvailTimer = nullptr;
     QPointer<KNotification> m_notification;
     qint64 m_lastAvail = -1; // used to suppress repeated warnings when available space hasn't changed
@@ -93,6 +93,7 @@ void Menu::start(uint id)
             for (auto menu : menus) {
                 m_menus[menu.id].append(menus);
             }
+            m_actionIndexDirty = true;
 
             // LibreOffice on startup fails to give us some menus right away, we'll also subscribe in onMenuChanged() if necessary
             if (menus.isEmpty()) {
@@ -217,6 +218,7 @@ QVariantMap Menu::getItem(int subscription, int sectionId, int index) const
 void Menu::onMenuChanged(const GMenuChangeList &changes)
 {
     const bool hadMenu = !m_menus.isEmpty();
+    m_actionIndexDirty = true;
 
     QVector<uint> dirtyMenus;
     QVector<uint> dirtyItems;
@@ -302,53 +304,44 @@ void Menu::onMenuChanged(const GMenuChangeList &changes)
     emit menusChanged(dirtyMenus);
 }
 
-void Menu::actionsChanged(const QStringList &dirtyActions, const QString &prefix)
+void Menu::updateActionIndex()
 {
-    auto forEachMenuItem = [this](const std::function<bool(int subscription, int section, int index, const QVariantMap &item)> &cb) {
-        for (auto it = m_menus.constBegin(), end = m_menus.constEnd(); it != end; ++it) {
-            const int subscription = it.key();
-
-            for (const auto &menu : it.value()) {
-                const int section = menu.section;
+    if (!m_actionIndexDirty) {
+        return;
+    }
 
-                int count = 0;
+    m_itemsForAction.clear();
+    for (auto it = m_menus.constBegin(), end = m_menus.constEnd(); it != end; ++it) {
+        const int subscription = it.key();
 
-                const auto items = menu.items;
-                for (const auto &item : items) {
-                    ++count; // 0 is a menu, entries start at 1
+        for (const auto &menu : it.value()) {
+            int count = 0;
+            for (const auto &item : menu.items) {
+                ++count; // 0 is a menu, entries start at 1
 
-                    if (!cb(subscription, section, count, item)) {
-                        goto loopExit; // hell yeah
-                        break;
-                    }
+                const QString actionName = Utils::itemActionName(item);
+                if (!actionName.isEmpty()) {
+                    m_itemsForAction[actionName].append(Utils::treeStructureToInt(subscription, menu.section, count));
                 }
             }
         }
+    }
 
-        loopExit: // loop exit
-        return;
-    };
+    m_actionIndexDirty = false;
+}
+
+void Menu::actionsChanged(const QStringList &dirtyActions, const QString &prefix)
+{
+    updateActionIndex();
 
     // now find in which menus these actions are and emit a change accordingly
     QVector<uint> dirtyItems;
 
     for (const QString &action : dirtyActions) {
-        const QString prefixedAction = prefix + action;
-
-        forEachMenuItem([ &prefixedAction, &dirtyItems](int subscription, int section, int index, const QVariantMap &item) {
-            const QString actionName = Utils::itemActionName(item);
-
-            if (actionName == prefixedAction) {
-                dirtyItems.append(Utils::treeStructureToInt(subscription, section, index));
-                return false; // break
-            }
-
-            return true; // continue
-        });
+        dirtyItems += m_itemsForAction.value(prefix + action);
     }
 
     if (!dirtyItems.isEmpty()) {
         emit itemsChanged(dirtyItems);
     }
 }
-
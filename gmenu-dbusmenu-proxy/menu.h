@@ -70,11 +70,17 @@ private:
 
     void menuChanged(const GMenuChangeList &changes);
 
+    void updateActionIndex();
+
     // QSet?
     QList<uint> m_subscriptions; // keeps track of which menu trees we're subscribed to
 
     QHash<uint, GMenuItemList> m_menus;
 
+    // which items trigger a given action, rebuilt lazily after the menus changed
+    QHash<QString, QVector<uint>> m_itemsForAction;
+    bool m_actionIndexDirty = true;
+
     QString m_serviceName;
     QString m_objectPath;
 
@@ -33,6 +33,7 @@
 #include <QHash>
 #include <QStandardPaths>
 #include <QTimer>
+#include <QVector>
 
 #include <KConfigGroup>
 #include <KDirWatch>
@@ -58,6 +59,16 @@ static const QByteArray s_gtkMenuBarObjectPath = QByteArrayLiteral("_GTK_MENUBAR
 // that's the generic app menu with Help and Options and will be used if window doesn't have a fully-blown menu bar
 static const QByteArray s_gtkAppMenuObjectPath = QByteArrayLiteral("_GTK_APP_MENU_OBJECT_PATH");
 
+// everything onWindowAdded needs to know, read in one go
+static const QList<QByteArray> s_gtkMenuProperties = {
+    s_gtkUniqueBusName,
+    s_gtkApplicationObjectPath,
+    s_unityObjectPath,
+    s_gtkWindowObjectPath,
+    s_gtkMenuBarObjectPath,
+    s_gtkAppMenuObjectPath
+};
+
 static const QByteArray s_kdeNetWmAppMenuServiceName = QByteArrayLiteral("_KDE_NET_WM_APPMENU_SERVICE_NAME");
 static const QByteArray s_kdeNetWmAppMenuObjectPath = QByteArrayLiteral("_KDE_NET_WM_APPMENU_OBJECT_PATH");
 
@@ -131,10 +142,7 @@ bool MenuProxy::init()
     connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &MenuProxy::onWindowAdded);
     connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &MenuProxy::onWindowRemoved);
 
-    const auto windows = KWindowSystem::windows();
-    for (WId id : windows) {
-        onWindowAdded(id);
-    }
+    addWindows(KWindowSystem::windows());
 
     if (m_windows.isEmpty()) {
         qCDebug(DBUSMENUPROXY) << "Up and running but no windows with menus in sight";
@@ -275,37 +283,59 @@ void MenuProxy::addOrRemoveAppMenuGtkModule(QStringList &list)
 
 void MenuProxy::onWindowAdded(WId id)
 {
-    if (m_windows.contains(id)) {
+    addWindows({id});
+}
+
+void MenuProxy::addWindows(const QList<WId> &ids)
+{
+    QList<WId> newIds;
+    newIds.reserve(ids.count());
+    for (WId id : ids) {
+        if (!m_windows.contains(id)) {
+            newIds.append(id);
+        }
+    }
+
+    if (newIds.isEmpty()) {
         return;
     }
 
-    KWindowInfo info(id, NET::WMWindowType);
+    const auto properties = getWindowPropertyStrings(newIds, s_gtkMenuProperties);
+    for (WId id : qAsConst(newIds)) {
+        addWindow(id, properties.value(id));
+    }
+}
 
-    NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                                            NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                                            NET::OverrideMask | NET::TopMenuMask |
-                                            NET::UtilityMask | NET::SplashMask);
+void MenuProxy::addWindow(WId id, const WindowProperties &properties)
+{
+    const QString serviceName = QString::fromUtf8(properties.value(s_gtkUniqueBusName));
 
-    // Only top level windows typically have a menu bar, dialogs, such as settings don't
-    if (wType != NET::Normal) {
-        qCDebug(DBUSMENUPROXY) << "Ignoring window" << id << "of type" << wType;
+    if (serviceName.isEmpty()) {
         return;
     }
 
-    const QString serviceName = QString::fromUtf8(getWindowPropertyString(id, s_gtkUniqueBusName));
+    const QString applicationObjectPath = QString::fromUtf8(properties.value(s_gtkApplicationObjectPath));
+    const QString unityObjectPath = QString::fromUtf8(properties.value(s_unityObjectPath));
+    const QString windowObjectPath = QString::fromUtf8(properties.value(s_gtkWindowObjectPath));
 
-    if (serviceName.isEmpty()) {
+    const QString applicationMenuObjectPath = QString::fromUtf8(properties.value(s_gtkAppMenuObjectPath));
+    const QString menuBarObjectPath = QString::fromUtf8(properties.value(s_gtkMenuBarObjectPath));
+
+    if (applicationMenuObjectPath.isEmpty() && menuBarObjectPath.isEmpty()) {
         return;
     }
 
-    const QString applicationObjectPath = QString::fromUtf8(getWindowPropertyString(id, s_gtkApplicationObjectPath));
-    const QString unityObjectPath = QString::fromUtf8(getWindowPropertyString(id, s_unityObjectPath));
-    const QString windowObjectPath = QString::fromUtf8(getWindowPropertyString(id, s_gtkWindowObjectPath));
+    // Only checked for windows announcing a GTK menu, saves a round trip for all the others
+    KWindowInfo info(id, NET::WMWindowType);
 
-    const QString applicationMenuObjectPath = QString::fromUtf8(getWindowPropertyString(id, s_gtkAppMenuObjectPath));
-    const QString menuBarObjectPath = QString::fromUtf8(getWindowPropertyString(id, s_gtkMenuBarObjectPath));
+    NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
+                                            NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+                                            NET::OverrideMask | NET::TopMenuMask |
+                                            NET::UtilityMask | NET::SplashMask);
 
-    if (applicationMenuObjectPath.isEmpty() && menuBarObjectPath.isEmpty()) {
+    // Only top level windows typically have a menu bar, dialogs, such as settings don't
+    if (wType != NET::Normal) {
+        qCDebug(DBUSMENUPROXY) << "Ignoring window" << id << "of type" << wType;
         return;
     }
 
@@ -338,35 +368,53 @@ void MenuProxy::onWindowRemoved(WId id)
     delete m_windows.take(id);
 }
 
-QByteArray MenuProxy::getWindowPropertyString(WId id, const QByteArray &name)
+QHash<WId, MenuProxy::WindowProperties> MenuProxy::getWindowPropertyStrings(const QList<WId> &ids, const QList<QByteArray> &names)
 {
-    QByteArray value;
-
-    auto atom = getAtom(name);
-    if (atom == XCB_ATOM_NONE) {
-        return value;
-    }
+    QHash<WId, WindowProperties> result;
 
     // GTK properties aren't XCB_ATOM_STRING but a custom one
-    auto utf8StringAtom = getAtom(QByteArrayLiteral("UTF8_STRING"));
+    const QByteArray utf8String = QByteArrayLiteral("UTF8_STRING");
+    internAtoms(QList<QByteArray>(names) << utf8String);
+    const xcb_atom_t utf8StringAtom = getAtom(utf8String);
+
+    // send all requests first and only then wait for the replies,
+    // so all windows and properties cost a single round trip
+    struct Request {
+        WId id;
+        QByteArray name;
+        xcb_get_property_cookie_t cookie;
+    };
+    QVector<Request> requests;
+    requests.reserve(ids.count() * names.count());
 
     static const long MAX_PROP_SIZE = 10000;
-    auto propertyCookie = xcb_get_property(m_xConnection, false, id, atom, utf8StringAtom, 0, MAX_PROP_SIZE);
-    QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter> propertyReply(xcb_get_property_reply(m_xConnection, propertyCookie, nullptr));
-    if (propertyReply.isNull()) {
-        qCWarning(DBUSMENUPROXY) << "XCB property reply for atom" << name << "on" << id << "was null";
-        return value;
+    for (WId id : ids) {
+        for (const QByteArray &name : names) {
+            const xcb_atom_t atom = m_atoms.value(name, XCB_ATOM_NONE);
+            if (atom == XCB_ATOM_NONE) {
+                continue;
+            }
+            requests.append({id, name, xcb_get_property(m_xConnection, false, id, atom, utf8StringAtom, 0, MAX_PROP_SIZE)});
+        }
     }
 
-    if (propertyReply->type == utf8StringAtom && propertyReply->format == 8 && propertyReply->value_len > 0) {
-        const char *data = (const char *) xcb_get_property_value(propertyReply.data());
-        int len = propertyReply->value_len;
-        if (data) {
-            value = QByteArray(data, data[len - 1] ? len : len - 1);
+    for (const Request &request : qAsConst(requests)) {
+        QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter> propertyReply(xcb_get_property_reply(m_xConnection, request.cookie, nullptr));
+        if (propertyReply.isNull()) {
+            qCWarning(DBUSMENUPROXY) << "XCB property reply for atom" << request.name << "on" << request.id << "was null";
+            continue;
+        }
+
+        if (propertyReply->type == utf8StringAtom && propertyReply->format == 8 && propertyReply->value_len > 0) {
+            const char *data = (const char *) xcb_get_property_value(propertyReply.data());
+            int len = propertyReply->value_len;
+            if (data) {
+                result[request.id].insert(request.name, QByteArray(data, data[len - 1] ? len : len - 1));
+            }
         }
     }
 
-    return value;
+    return result;
 }
 
 void MenuProxy::writeWindowProperty(WId id, const QByteArray &name, const QByteArray &value)
@@ -386,19 +434,28 @@ void MenuProxy::writeWindowProperty(WId id, const QByteArray &name, const QByteA
 
 xcb_atom_t MenuProxy::getAtom(const QByteArray &name)
 {
-    static QHash<QByteArray, xcb_atom_t> s_atoms;
-
-    auto atom = s_atoms.value(name, XCB_ATOM_NONE);
+    auto atom = m_atoms.value(name, XCB_ATOM_NONE);
     if (atom == XCB_ATOM_NONE) {
-        const xcb_intern_atom_cookie_t atomCookie = xcb_intern_atom(m_xConnection, false, name.length(), name.constData());
-        QScopedPointer<xcb_intern_atom_reply_t, QScopedPointerPodDeleter> atomReply(xcb_intern_atom_reply(m_xConnection, atomCookie, nullptr));
-        if (!atomReply.isNull()) {
-            atom = atomReply->atom;
-            if (atom != XCB_ATOM_NONE) {
-                s_atoms.insert(name, atom);
-            }
-        }
+        internAtoms({name});
+        atom = m_atoms.value(name, XCB_ATOM_NONE);
     }
 
     return atom;
 }
+
+void MenuProxy::internAtoms(const QList<QByteArray> &names)
+{
+    QVector<QPair<QByteArray, xcb_intern_atom_cookie_t>> cookies;
+    for (const QByteArray &name : names) {
+        if (!m_atoms.contains(name)) {
+            cookies.append(qMakePair(name, xcb_intern_atom(m_xConnection, false, name.length(), name.constData())));
+        }
+    }
+
+    for (const auto &cookie : qAsConst(cookies)) {
+        QScopedPointer<xcb_intern_atom_reply_t, QScopedPointerPodDeleter> atomReply(xcb_intern_atom_reply(m_xConnection, cookie.second, nullptr));
+        if (!atomReply.isNull() && atomReply->atom != XCB_ATOM_NONE) {
+            m_atoms.insert(cookie.first, atomReply->atom);
+        }
+    }
+}
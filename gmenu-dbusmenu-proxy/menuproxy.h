@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QByteArray>
 #include <QHash>
+#include <QList>
 #include <QWindow> // for WId
 
 #include <xcb/xcb_atom.h>
@@ -61,9 +62,17 @@ private:
 
     xcb_connection_t *m_xConnection;
 
-    QByteArray getWindowPropertyString(WId id, const QByteArray &name);
+    using WindowProperties = QHash<QByteArray, QByteArray>;
+
+    void addWindows(const QList<WId> &ids);
+    void addWindow(WId id, const WindowProperties &properties);
+
+    QHash<WId, WindowProperties> getWindowPropertyStrings(const QList<WId> &ids, const QList<QByteArray> &names);
     void writeWindowProperty(WId id, const QByteArray &name, const QByteArray &value);
     xcb_atom_t getAtom(const QByteArray &name);
+    void internAtoms(const QList<QByteArray> &names);
+
+    QHash<QByteArray, xcb_atom_t> m_atoms;
 
     QHash<WId, Window *> m_windows;
 
@@ -238,6 +238,7 @@ void Window::menuItemsChanged(const QVector<uint> &itemIds)
     }
 
     DBusMenuItemList items;
+    QSet<int> invalidatedLayouts;
 
     for (uint id : itemIds) {
         const auto newItem = m_currentMenu->getItem(id);
@@ -248,9 +249,33 @@ void Window::menuItemsChanged(const QVector<uint> &itemIds)
             gMenuToDBusMenuProperties(newItem)
         };
         items.append(dBusItem);
+
+        m_itemProperties.insert(dBusItem.id, dBusItem.properties);
+
+        // an item that now references another section changes the structure
+        if (newItem.contains(QStringLiteral(":section"))) {
+            int subscription;
+            int sectionId;
+            int index;
+            Utils::intToTreeStructure(dBusItem.id, subscription, sectionId, index);
+            invalidateSection(subscription, sectionId, invalidatedLayouts);
+            continue;
+        }
+
+        for (auto &layout : m_layouts) {
+            for (auto &child : layout.item.children) {
+                if (child.id == dBusItem.id) {
+                    child.properties = dBusItem.properties;
+                }
+            }
+        }
     }
 
     emit ItemsPropertiesUpdated(items, {});
+
+    for (int parent : qAsConst(invalidatedLayouts)) {
+        emitLayoutUpdated(parent);
+    }
 }
 
 void Window::menuChanged(const QVector<uint> &menuIds)
@@ -259,13 +284,26 @@ void Window::menuChanged(const QVector<uint> &menuIds)
         return;
     }
 
+    QSet<int> invalidatedLayouts;
     for (uint menu : menuIds) {
-        emit LayoutUpdated(3 /*revision*/, menu);
+        int subscription;
+        int sectionId;
+        int index;
+        Utils::intToTreeStructure(menu, subscription, sectionId, index);
+        invalidateSection(subscription, sectionId, invalidatedLayouts);
+        invalidatedLayouts.insert(menu);
+    }
+
+    for (int parent : qAsConst(invalidatedLayouts)) {
+        emitLayoutUpdated(parent);
     }
 }
 
 void Window::onMenuSubscribed(uint id)
 {
+    // new sections may be aliased from layouts we already translated
+    invalidateLayouts();
+
     // When it was a delayed GetLayout request, send the reply now
     const auto pendingReplies = m_pendingGetLayouts.values(id);
     if (!pendingReplies.isEmpty()) {
@@ -283,10 +321,49 @@ void Window::onMenuSubscribed(uint id)
         }
         m_pendingGetLayouts.remove(id);
     } else {
-        emit LayoutUpdated(2 /*revision*/, id);
+        emitLayoutUpdated(id);
+    }
+}
+
+void Window::invalidateLayouts()
+{
+    m_layouts.clear();
+    m_itemProperties.clear();
+}
+
+void Window::invalidateSection(int subscription, int sectionId, QSet<int> &invalidatedLayouts)
+{
+    const int section = Utils::treeStructureToInt(subscription, sectionId, 0);
+
+    for (auto it = m_layouts.begin(); it != m_layouts.end();) {
+        if (it->sections.contains(section)) {
+            invalidatedLayouts.insert(it.key());
+            it = m_layouts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // the items of the section may have moved, their ids are no longer valid
+    for (auto it = m_itemProperties.begin(); it != m_itemProperties.end();) {
+        int itemSubscription;
+        int itemSectionId;
+        int index;
+        Utils::intToTreeStructure(it.key(), itemSubscription, itemSectionId, index);
+        if (itemSubscription == subscription && itemSectionId == sectionId) {
+            it = m_itemProperties.erase(it);
+        } else {
+            ++it;
+        }
     }
 }
 
+void Window::emitLayoutUpdated(int parent)
+{
+    ++m_revision;
+    emit LayoutUpdated(m_revision, parent);
+}
+
 bool Window::getAction(const QString &name, GMenuAction &action) const
 {
     QString lookupName;
@@ -382,7 +459,8 @@ void Window::updateWindowProperties()
 
     if (m_currentMenu != oldMenu) {
         // update entire menu now
-        emit LayoutUpdated(4 /*revision*/, 0);
+        invalidateLayouts();
+        emitLayoutUpdated(0);
     }
 
     emit requestWriteWindowProperties();
@@ -420,9 +498,31 @@ void Window::Event(int id, const QString &eventId, const QDBusVariant &data, uin
 
 DBusMenuItemList Window::GetGroupProperties(const QList<int> &ids, const QStringList &propertyNames)
 {
-    Q_UNUSED(ids);
-    Q_UNUSED(propertyNames);
-    return DBusMenuItemList();
+    DBusMenuItemList items;
+    if (!m_currentMenu) {
+        return items;
+    }
+
+    items.reserve(ids.count());
+    for (int id : ids) {
+        const QVariantMap source = m_currentMenu->getItem(id);
+        if (source.isEmpty()) {
+            continue;
+        }
+
+        QVariantMap properties = cachedProperties(id, source);
+        if (!propertyNames.isEmpty()) {
+            for (auto it = properties.begin(); it != properties.end();) {
+                if (propertyNames.contains(it.key())) {
+                    ++it;
+                } else {
+                    it = properties.erase(it);
+                }
+            }
+        }
+        items.append(DBusMenuItem{id, properties});
+    }
+    return items;
 }
 
 uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &propertyNames, DBusMenuLayoutItem &dbusItem)
@@ -449,6 +549,14 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
         return 1;
     }
 
+    if (index == 0) {
+        auto it = m_layouts.constFind(parentId);
+        if (it != m_layouts.constEnd()) {
+            dbusItem = it->item;
+            return m_revision;
+        }
+    }
+
     bool ok;
     const GMenuItem section = m_currentMenu->getSection(subscription, sectionId, &ok);
 
@@ -479,6 +587,9 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
         }
     }
 
+    CachedLayout layout;
+    layout.sections.append(Utils::treeStructureToInt(subscription, sectionId, 0));
+
     dbusItem.id = parentId; // TODO
     dbusItem.properties = {
         {QStringLiteral("children-display"), QStringLiteral("submenu")}
@@ -489,9 +600,10 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
     const auto itemsToBeAdded = section.items;
     for (const auto &item : itemsToBeAdded) {
 
+        const int childId = Utils::treeStructureToInt(section.id, sectionId, ++count);
         DBusMenuLayoutItem child{
-            Utils::treeStructureToInt(section.id, sectionId, ++count),
-            gMenuToDBusMenuProperties(item),
+            childId,
+            cachedProperties(childId, item),
             {} // children
         };
         dbusItem.children.append(child);
@@ -525,11 +637,15 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
                 }
             }
 
+            layout.sections.append(Utils::treeStructureToInt(gmenuSection.subscription, gmenuSection.menu, 0));
+            layout.sections.append(Utils::treeStructureToInt(originalSubscription, originalMenu, 0));
+
             int aliasedCount = 0;
             for (const auto &aliasedItem : qAsConst(items)) {
+                const int aliasedId = Utils::treeStructureToInt(originalSubscription, originalMenu, ++aliasedCount);
                 DBusMenuLayoutItem aliasedChild{
-                    Utils::treeStructureToInt(originalSubscription, originalMenu, ++aliasedCount),
-                    gMenuToDBusMenuProperties(aliasedItem),
+                    aliasedId,
+                    cachedProperties(aliasedId, aliasedItem),
                     {} // children
                 };
                 dbusItem.children.append(aliasedChild);
@@ -537,8 +653,10 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
         }
     }
 
-    // revision, unused in libdbusmenuqt
-    return 1;
+    layout.item = dbusItem;
+    m_layouts.insert(parentId, layout);
+
+    return m_revision;
 }
 
 QDBusVariant Window::GetProperty(int id, const QString &property)
@@ -559,6 +677,15 @@ uint Window::version() const
     return 4;
 }
 
+QVariantMap Window::cachedProperties(int id, const QVariantMap &source)
+{
+    auto it = m_itemProperties.find(id);
+    if (it == m_itemProperties.end()) {
+        it = m_itemProperties.insert(id, gMenuToDBusMenuProperties(source));
+    }
+    return *it;
+}
+
 QVariantMap Window::gMenuToDBusMenuProperties(const QVariantMap &source) const
 {
     QVariantMap result;
@@ -21,6 +21,8 @@
 
 #include <QObject>
 #include <QDBusContext>
+#include <QHash>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <QWindow> // for WId
@@ -110,6 +112,11 @@ private:
     void onMenuSubscribed(uint id);
 
     QVariantMap gMenuToDBusMenuProperties(const QVariantMap &source) const;
+    QVariantMap cachedProperties(int id, const QVariantMap &source);
+
+    void invalidateLayouts();
+    void invalidateSection(int subscription, int sectionId, QSet<int> &invalidatedLayouts);
+    void emitLayoutUpdated(int parent);
 
     WId m_winId = 0;
     QString m_serviceName; // original GMenu service (the gtk app)
@@ -126,6 +133,16 @@ private:
 
     QHash<int, QDBusMessage> m_pendingGetLayouts;
 
+    // Translated layouts served by GetLayout, patched when items change and
+    // dropped when the sections they were built from change
+    struct CachedLayout {
+        DBusMenuLayoutItem item;
+        QVector<int> sections; // sections (id with index 0) the layout was built from
+    };
+    QHash<int, CachedLayout> m_layouts;
+    QHash<int, QVariantMap> m_itemProperties;
+    uint m_revision = 1;
+
     Menu *m_applicationMenu = nullptr;
     Menu *m_menuBar = nullptr;
 
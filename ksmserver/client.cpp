@@ -74,6 +74,7 @@ void KSMClient::resetState()
     pendingInteraction = false;
     waitForPhase2 = false;
     wasPhase2 = false;
+    hadInteraction = false;
 }
 
 /*
@@ -28,6 +28,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 // needed to avoid clash with INT8 defined in X11/Xmd.h on solaris
 #define QT_CLEAN_NAMESPACE 1
 
+#include <QElapsedTimer>
+
 #include <kworkspace.h>
 
 #include "server.h"
@@ -47,6 +49,8 @@ public:
     uint pendingInteraction : 1;
     uint waitForPhase2 : 1;
     uint wasPhase2 : 1;
+    uint hadInteraction : 1;
+    QElapsedTimer saveRequested;
 
     QList<SmProp*> properties;
     SmProp* property( const char* name ) const;
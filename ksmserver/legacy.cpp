@@ -32,6 +32,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <QX11Info>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
 
 #include <config-workspace.h>
 
@@ -56,6 +58,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
 
+#include <xcb/xcb.h>
+
 /*
 * Legacy session management
 */
@@ -68,6 +72,61 @@ static Atom wm_protocols = XNone;
 static Atom wm_client_leader = XNone;
 static Atom sm_client_id = XNone;
 
+struct PropertyReply
+{
+    bool valid = false;
+    QByteArray data;
+};
+
+/*
+ * Collects property requests and sends them all before waiting for
+ * the first reply, so that a whole batch costs a single round trip
+ * instead of one per property.
+ */
+class PropertyBatch
+{
+public:
+    explicit PropertyBatch(xcb_connection_t *connection)
+        : m_connection(connection)
+    {
+    }
+
+    void request(WId w, xcb_atom_t property, xcb_atom_t type, uint32_t length = 10000)
+    {
+        m_cookies.append(xcb_get_property(m_connection, false, w, property, type, 0, length));
+    }
+
+    QVector<PropertyReply> collect()
+    {
+        QVector<PropertyReply> replies(m_cookies.count());
+        for (int i = 0; i < m_cookies.count(); ++i) {
+            xcb_generic_error_t *error = nullptr;
+            xcb_get_property_reply_t *reply = xcb_get_property_reply(m_connection, m_cookies.at(i), &error);
+            if (error) {
+                free(error);
+            }
+            if (reply) {
+                replies[i].valid = !error;
+                replies[i].data = QByteArray(static_cast<const char *>(xcb_get_property_value(reply)),
+                                             xcb_get_property_value_length(reply));
+                free(reply);
+            }
+        }
+        m_cookies.clear();
+        return replies;
+    }
+
+private:
+    xcb_connection_t *m_connection;
+    QVector<xcb_get_property_cookie_t> m_cookies;
+};
+
+// the first string of a STRING property
+static QByteArray stringFromProperty(const QByteArray &property)
+{
+    return QByteArray(property.constData());
+}
+
 static int winsErrorHandler(Display *, XErrorEvent *ev)
 {
     if (windowMapPtr) {
@@ -107,34 +166,86 @@ void KSMServer::performLegacySessionSave()
         wm_client_leader = atoms[ 2 ];
         sm_client_id = atoms[ 3 ];
     }
+    // Compute the leaders and their session ids for all windows with as few
+    // round trips as possible: every property request of one pass is sent
+    // before the first reply is waited for.
+    xcb_connection_t *c = QX11Info::connection();
     const QList<WId> windows = KWindowSystem::windows();
-    for ( QList<WId>::ConstIterator it = windows.begin();
-        it != windows.end(); ++it) {
-        WId leader = windowWmClientLeader( *it );
-        if (!legacyWindows.contains(leader) && windowSessionId( *it, leader ).isEmpty()) {
-            SMType wtype = SM_WMCOMMAND;
-            int nprotocols = 0;
-            Atom *protocols = nullptr;
-            if( XGetWMProtocols(QX11Info::display(), leader, &protocols, &nprotocols)) {
-                for (int i=0; i<nprotocols; i++)
-                    if (protocols[i] == wm_save_yourself) {
-                        wtype = SM_WMSAVEYOURSELF;
-                        break;
-                    }
-                XFree((void*) protocols);
-            }
-            SMData data;
-            data.type = wtype;
-            XClassHint classHint;
-            if( XGetClassHint( QX11Info::display(), leader, &classHint ) ) {
-                data.wmclass1 = QString::fromLocal8Bit( classHint.res_name );
-                data.wmclass2 = QString::fromLocal8Bit( classHint.res_class );
-                XFree( classHint.res_name );
-                XFree( classHint.res_class );
+    PropertyBatch leaderBatch(c);
+    for (WId w : windows) {
+        leaderBatch.request(w, wm_client_leader, XCB_ATOM_WINDOW, 1);
+        leaderBatch.request(w, sm_client_id, XCB_ATOM_STRING);
+    }
+    const QVector<PropertyReply> leaderReplies = leaderBatch.collect();
+
+    QHash<WId, WId> leaderOf;
+    QHash<WId, QByteArray> sessionIds;
+    for (int i = 0; i < windows.count(); ++i) {
+        const WId w = windows.at(i);
+        const PropertyReply &leaderReply = leaderReplies.at(2 * i);
+        WId leader = w;
+        if (leaderReply.data.size() >= int(sizeof(quint32))) {
+            leader = *reinterpret_cast<const quint32 *>(leaderReply.data.constData());
+            if (leader == XCB_WINDOW_NONE)
+                leader = w;
+        }
+        leaderOf.insert(w, leader);
+        sessionIds.insert(w, stringFromProperty(leaderReplies.at(2 * i + 1).data));
+    }
+
+    // Leaders which are not among the managed windows still need their session id
+    PropertyBatch sessionBatch(c);
+    QList<WId> unknownLeaders;
+    for (WId leader : qAsConst(leaderOf)) {
+        if (!sessionIds.contains(leader) && !unknownLeaders.contains(leader)) {
+            unknownLeaders.append(leader);
+            sessionBatch.request(leader, sm_client_id, XCB_ATOM_STRING);
+        }
+    }
+    const QVector<PropertyReply> sessionReplies = sessionBatch.collect();
+    for (int i = 0; i < unknownLeaders.count(); ++i)
+        sessionIds.insert(unknownLeaders.at(i), stringFromProperty(sessionReplies.at(i).data));
+
+    QList<WId> leaders;
+    for (WId w : windows) {
+        const WId leader = leaderOf.value(w);
+        if (leaders.contains(leader))
+            continue;
+        QByteArray sessionId = sessionIds.value(w);
+        if (sessionId.isEmpty() && leader != w)
+            sessionId = sessionIds.value(leader);
+        if (sessionId.isEmpty())
+            leaders.append(leader);
+    }
+
+    // Determine which style (WM_COMMAND or WM_SAVE_YOURSELF) each leader needs
+    PropertyBatch protocolBatch(c);
+    for (WId leader : qAsConst(leaders)) {
+        protocolBatch.request(leader, wm_protocols, XCB_ATOM_ATOM);
+        protocolBatch.request(leader, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING);
+    }
+    const QVector<PropertyReply> protocolReplies = protocolBatch.collect();
+    for (int i = 0; i < leaders.count(); ++i) {
+        const PropertyReply &protocolsReply = protocolReplies.at(2 * i);
+        const PropertyReply &classReply = protocolReplies.at(2 * i + 1);
+        SMData data;
+        data.type = SM_WMCOMMAND;
+        const quint32 *protocols = reinterpret_cast<const quint32 *>(protocolsReply.data.constData());
+        const int nprotocols = protocolsReply.data.size() / int(sizeof(quint32));
+        for (int j = 0; j < nprotocols; ++j) {
+            if (protocols[j] == wm_save_yourself) {
+                data.type = SM_WMSAVEYOURSELF;
+                break;
             }
-            legacyWindows.insert(leader, data);
         }
+        if (classReply.valid) {
+            const QList<QByteArray> classHint = classReply.data.split('\0');
+            data.wmclass1 = QString::fromLocal8Bit(classHint.value(0));
+            data.wmclass2 = QString::fromLocal8Bit(classHint.value(1));
+        }
+        legacyWindows.insert(leaders.at(i), data);
     }
+
     // Open fresh display for sending WM_SAVE_YOURSELF
     XSync(QX11Info::display(), False);
     Display *newdisplay = XOpenDisplay(DisplayString(QX11Info::display()));
@@ -209,13 +320,26 @@ void KSMServer::performLegacySessionSave()
     // Restore old error handler
     XSync(QX11Info::display(), False);
     XSetErrorHandler(oldHandler);
-    for (WindowMap::Iterator it = legacyWindows.begin(); it != legacyWindows.end(); ++it) {
+    PropertyBatch commandBatch(c);
+    QList<WId> commandWindows;
+    for (WindowMap::ConstIterator it = legacyWindows.constBegin(); it != legacyWindows.constEnd(); ++it) {
         if ( (*it).type != SM_ERROR) {
-            WId w = it.key();
-            (*it).wmCommand = windowWmCommand(w);
-            (*it).wmClientMachine = windowWmClientMachine(w);
+            commandWindows.append(it.key());
+            commandBatch.request(it.key(), XCB_ATOM_WM_COMMAND, XCB_ATOM_STRING);
+            commandBatch.request(it.key(), XCB_ATOM_WM_CLIENT_MACHINE, XCB_ATOM_STRING);
         }
     }
+    const QVector<PropertyReply> commandReplies = commandBatch.collect();
+    for (int i = 0; i < commandWindows.count(); ++i) {
+        SMData &data = legacyWindows[commandWindows.at(i)];
+        const PropertyReply &commandReply = commandReplies.at(2 * i);
+        if (!commandReply.valid) {
+            data.type = SM_ERROR;
+            continue;
+        }
+        data.wmCommand = windowWmCommand(commandReply.data);
+        data.wmClientMachine = windowWmClientMachine(commandReplies.at(2 * i + 1).data);
+    }
     qCDebug(KSMSERVER) << "Done saving " << legacyWindows.count() << " legacy session apps";
 }
 
@@ -273,52 +397,14 @@ void KSMServer::restoreLegacySessionInternal( KConfigGroup* config, char sep )
     }
 }
 
-static QByteArray getQCStringProperty(WId w, Atom prop)
+QStringList KSMServer::windowWmCommand(const QByteArray &property)
 {
-    Atom type;
-    int format, status;
-    unsigned long nitems = 0;
-    unsigned long extra = 0;
-    unsigned char *data = nullptr;
-    QByteArray result = "";
-    status = XGetWindowProperty( QX11Info::display(), w, prop, 0, 10000,
-                                false, XA_STRING, &type, &format,
-                                &nitems, &extra, &data );
-    if ( status == Success) {
-        if( data )
-            result = (char*)data;
-        XFree(data);
+    QStringList ret;
+    for (int i = 0; i < property.size(); i++) {
+        ret << QLatin1String(property.constData() + i);
+        while (i < property.size() && property.at(i))
+            i++;
     }
-    return result;
-}
-
-static QStringList getQStringListProperty(WId w, Atom prop)
-{
-    Atom type;
-    int format, status;
-    unsigned long nitems = 0;
-    unsigned long extra = 0;
-    unsigned char *data = nullptr;
-    QStringList result;
-
-    status = XGetWindowProperty( QX11Info::display(), w, prop, 0, 10000,
-                                false, XA_STRING, &type, &format,
-                                &nitems, &extra, &data );
-    if ( status == Success) {
-        if (!data)
-            return result;
-        for (int i=0; i<(int)nitems; i++) {
-            result << QLatin1String( (const char*)data + i );
-            while(data[i]) i++;
-        }
-        XFree(data);
-    }
-    return result;
-}
-
-QStringList KSMServer::windowWmCommand(WId w)
-{
-    QStringList ret = getQStringListProperty(w, XA_WM_COMMAND);
     // hacks here
     if( ret.count() == 1 ) {
         QString command = ret.first();
@@ -339,9 +425,9 @@ QStringList KSMServer::windowWmCommand(WId w)
     return ret;
 }
 
-QString KSMServer::windowWmClientMachine(WId w)
+QString KSMServer::windowWmClientMachine(const QByteArray &property)
 {
-    QByteArray result = getQCStringProperty(w, XA_WM_CLIENT_MACHINE);
+    QByteArray result = stringFromProperty(property);
     if (result.isEmpty()) {
         result = "localhost";
     } else {
@@ -361,35 +447,4 @@ QString KSMServer::windowWmClientMachine(WId w)
     return QLatin1String(result);
 }
 
-WId KSMServer::windowWmClientLeader(WId w)
-{
-    Atom type;
-    int format, status;
-    unsigned long nitems = 0;
-    unsigned long extra = 0;
-    unsigned char *data = nullptr;
-    Window result = w;
-    status = XGetWindowProperty( QX11Info::display(), w, wm_client_leader, 0, 10000,
-                                false, XA_WINDOW, &type, &format,
-                                &nitems, &extra, &data );
-    if (status  == Success ) {
-        if (data && nitems > 0)
-            result = *((Window*) data);
-        XFree(data);
-    }
-    return result;
-}
-
-
-/*
-Returns sessionId for this client,
-taken either from its window or from the leader window.
-*/
-QByteArray KSMServer::windowSessionId(WId w, WId leader)
-{
-    QByteArray result = getQCStringProperty(w, sm_client_id);
-    if (result.isEmpty() && leader != (WId)None && leader != w)
-        result = getQCStringProperty(leader, sm_client_id);
-    return result;
-}
 #endif
@@ -60,6 +60,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <QApplication>
 #include <QTimer>
 #include <QFile>
+#include <QSet>
 #include <QFutureWatcher>
 #include <QtConcurrentRun>
 #include <QDesktopWidget>
@@ -194,6 +195,7 @@ void KSMServer::performLogout()
     auto setStateReply = m_kwinInterface->setState(KWinSessionState::Saving);
 
     state = Shutdown;
+    startLogoutPhases();
 
     // shall we save the session on logout?
     KConfigGroup cg(KSharedConfig::openConfig(), "General");
@@ -214,6 +216,7 @@ void KSMServer::performLogout()
     saveType = saveSession?SmSaveBoth:SmSaveGlobal;
 #ifndef NO_LEGACY_SESSION_MANAGEMENT
     performLegacySessionSave();
+    finishLogoutPhase( QStringLiteral( "legacySave" ) );
 #endif
     startProtection();
 
@@ -230,12 +233,14 @@ void KSMServer::performLogout()
         // "Save changes?" prompts altering the state.
         // KWin doesn't talk to KSMServer directly anymore, so this won't deadlock.
         saveSessionCall.waitForFinished();
+        finishLogoutPhase( QStringLiteral( "windowManagerSave" ) );
     }
 
     const auto pendingClients = clients;
 
     for (KSMClient *c : pendingClients) {
         c->resetState();
+        c->saveRequested.start();
 
         SmsSaveYourself(c->connection(), saveType, true, SmInteractStyleAny, false);
     }
@@ -255,18 +260,22 @@ void KSMServer::saveCurrentSession()
         sessionGroup = QLatin1String("Session: ") + QString::fromLocal8Bit( SESSION_BY_USER );
 
     state = Checkpoint;
+    startLogoutPhases();
 
     saveType = SmSaveLocal;
     saveSession = true;
 #ifndef NO_LEGACY_SESSION_MANAGEMENT
     performLegacySessionSave();
+    finishLogoutPhase( QStringLiteral( "legacySave" ) );
 #endif
 
     auto aboutToSaveCall = m_kwinInterface->aboutToSaveSession(currentSession());
     aboutToSaveCall.waitForFinished();
+    finishLogoutPhase( QStringLiteral( "windowManagerSave" ) );
 
     const auto pendingClients = clients;
     for (KSMClient *c : pendingClients) {
+        c->saveRequested.start();
         SmsSaveYourself( c->connection(), saveType, false, SmInteractStyleNone, false );
     }
     if ( clients.isEmpty() )
@@ -294,6 +303,10 @@ void KSMServer::saveYourselfDone( KSMClient* client, bool success )
             executeCommand( discard );
         return;
     }
+    if ( !client->saveYourselfDone && !client->hadInteraction && !client->wasPhase2
+         && client->saveRequested.isValid() ) {
+        recordSaveLatency( client, int( client->saveRequested.elapsed() ) );
+    }
     if ( success ) {
         client->saveYourselfDone = true;
         completeShutdownOrCheckpoint();
@@ -309,6 +322,7 @@ void KSMServer::saveYourselfDone( KSMClient* client, bool success )
 
 void KSMServer::interactRequest( KSMClient* client, int /*dialogType*/ )
 {
+    client->hadInteraction = true;
     if ( state == Shutdown || state == ClosingSubSession )
         client->pendingInteraction = true;
     else
@@ -398,10 +412,44 @@ void KSMServer::startProtection()
     config->reparseConfiguration(); // config may have changed in the KControl module
     KConfigGroup cg( config, "General" );
 
-    int timeout = cg.readEntry( "clientShutdownTimeoutSecs", 15 ) * 1000;
+    clientShutdownTimeout = cg.readEntry( "clientShutdownTimeoutSecs", 15 ) * 1000;
+    minClientShutdownTimeout = qMin( cg.readEntry( "minClientShutdownTimeoutSecs", 10 ) * 1000,
+                                     clientShutdownTimeout );
+    adaptiveShutdownTimeout = cg.readEntry( "adaptiveClientShutdownTimeout", true );
+
+    protectionClock.start();
+    scheduleProtection();
+}
+
+/*
+Arms the protection timer for the pending client that runs out of
+time first.
+*/
+void KSMServer::scheduleProtection()
+{
+    qint64 timeout = clientShutdownTimeout - protectionClock.elapsed();
+    foreach( KSMClient* c, clients ) {
+        if ( !c->saveYourselfDone && !c->waitForPhase2 )
+            timeout = qMin( timeout, clientSaveTimeLeft( c ) );
+    }
 
     protectionTimer.setSingleShot( true );
-    protectionTimer.start( timeout );
+    protectionTimer.start( qMax<qint64>( 0, timeout ) );
+}
+
+/*
+Returns how much longer the client may take to save itself. The
+configured maximum counts from the last time any client made progress,
+as it always did, while the shorter adaptive deadline of a client counts
+from the moment it was asked to save.
+*/
+qint64 KSMServer::clientSaveTimeLeft( KSMClient* client )
+{
+    qint64 left = clientShutdownTimeout - protectionClock.elapsed();
+    const int timeout = clientSaveTimeout( client );
+    if ( timeout < clientShutdownTimeout && client->saveRequested.isValid() )
+        left = qMin( left, timeout - client->saveRequested.elapsed() );
+    return left;
 }
 
 void KSMServer::endProtection()
@@ -409,6 +457,70 @@ void KSMServer::endProtection()
     protectionTimer.stop();
 }
 
+/*
+Returns how long the client may take to save itself. Clients which
+saved quickly during previous logouts get a shorter grace period than
+the configured maximum, so a single hung application doesn't hold up
+the logout for the full timeout when the others are done long before.
+*/
+int KSMServer::clientSaveTimeout( KSMClient* client )
+{
+    if ( !adaptiveShutdownTimeout )
+        return clientShutdownTimeout;
+
+    loadSaveLatencies();
+    const int latency = saveLatencies.value( client->program(), -1 );
+    if ( latency < 0 )
+        return clientShutdownTimeout;
+    return qBound( minClientShutdownTimeout, 3 * latency, clientShutdownTimeout );
+}
+
+void KSMServer::recordSaveLatency( KSMClient* client, int msecs )
+{
+    const QString program = client->program();
+    if ( program.isEmpty() )
+        return;
+
+    loadSaveLatencies();
+    auto it = saveLatencies.find( program );
+    if ( it == saveLatencies.end() )
+        saveLatencies.insert( program, msecs );
+    else
+        *it = ( 3 * *it + msecs ) / 4;
+}
+
+void KSMServer::loadSaveLatencies()
+{
+    if ( saveLatenciesLoaded )
+        return;
+    saveLatenciesLoaded = true;
+
+    const KConfigGroup cg( KSharedConfig::openConfig(), "SaveLatencies" );
+    const QStringList programs = cg.keyList();
+    for ( const QString &program : programs )
+        saveLatencies.insert( program, cg.readEntry( program, 0 ) );
+}
+
+void KSMServer::storeSaveLatencies()
+{
+    if ( !saveLatenciesLoaded )
+        return;
+
+    // only keep the programs of this session, the others would pile up forever
+    QSet<QString> programs;
+    foreach( KSMClient* c, clients )
+        programs.insert( c->program() );
+
+    KSharedConfig::Ptr config = KSharedConfig::openConfig();
+    KConfigGroup cg( config, "SaveLatencies" );
+    cg.deleteGroup();
+    for ( auto it = saveLatencies.constBegin(); it != saveLatencies.constEnd(); ++it ) {
+        if ( programs.contains( it.key() ) )
+            cg.writeEntry( it.key(), it.value() );
+    }
+    config->sync();
+}
+
 /*
 Internal protection slot, invoked when clients do not react during
 shutdown.
@@ -419,13 +531,34 @@ void KSMServer::protectionTimeout()
         return;
 
     foreach( KSMClient* c, clients ) {
-        if ( !c->saveYourselfDone && !c->waitForPhase2 ) {
+        if ( !c->saveYourselfDone && !c->waitForPhase2 && clientSaveTimeLeft( c ) <= 0 ) {
             qCDebug(KSMSERVER) << "protectionTimeout: client " << c->program() << "(" << c->clientId() << ")";
             c->saveYourselfDone = true;
+            // give it the full timeout next time
+            recordSaveLatency( c, clientShutdownTimeout );
         }
     }
     completeShutdownOrCheckpoint();
-    startProtection();
+    scheduleProtection();
+}
+
+void KSMServer::startLogoutPhases()
+{
+    logoutPhases.clear();
+    logoutPhaseTimer.start();
+}
+
+void KSMServer::finishLogoutPhase( const QString &phase )
+{
+    if ( !logoutPhaseTimer.isValid() )
+        return;
+    logoutPhases.insert( phase, logoutPhaseTimer.restart() );
+    qCDebug(KSMSERVER) << "Logout phase" << phase << "took" << logoutPhases.value( phase ).toLongLong() << "ms";
+}
+
+QVariantMap KSMServer::logoutPhaseTimings() const
+{
+    return logoutPhases;
 }
 
 void KSMServer::completeShutdownOrCheckpoint()
@@ -457,10 +590,14 @@ void KSMServer::completeShutdownOrCheckpoint()
     if ( waitForPhase2 )
         return;
 
+    finishLogoutPhase( QStringLiteral( "clientSave" ) );
+
     if ( saveSession )
         storeSession();
     else
         discardSession();
+    storeSaveLatencies();
+    finishLogoutPhase( QStringLiteral( "storeSession" ) );
 
 	qCDebug(KSMSERVER) << "state is " << state;
     if ( state == Shutdown ) {
@@ -498,6 +635,7 @@ void KSMServer::startKilling()
     }
     // kill all clients
     state = Killing;
+    finishLogoutPhase( QStringLiteral( "logoutNotification" ) );
 
     m_kwinInterface->setState(KWinSessionState::Quitting);
 
@@ -530,6 +668,7 @@ void KSMServer::completeKilling()
 // shutdown is fully complete
 void KSMServer::killingCompleted()
 {
+    finishLogoutPhase( QStringLiteral( "killing" ) );
     if (m_performLogoutCall.type() == QDBusMessage::MethodCallMessage) {
         auto reply = m_performLogoutCall.createReply(true);
         QDBusConnection::sessionBus().send(reply);
@@ -557,6 +696,7 @@ void KSMServer::saveSubSession(const QString &name, QStringList saveAndClose, QS
     saveType = SmSaveBoth; //both or local? what oes it mean?
     saveSession = true;
     sessionGroup = QStringLiteral( "SubSession: " ) + name;
+    startLogoutPhases();
 
 #ifndef NO_LEGACY_SESSION_MANAGEMENT
     //performLegacySessionSave(); FIXME
@@ -566,12 +706,14 @@ void KSMServer::saveSubSession(const QString &name, QStringList saveAndClose, QS
     foreach( KSMClient* c, clients ) {
         if (saveAndClose.contains(QString::fromLocal8Bit(c->clientId()))) {
             c->resetState();
+            c->saveRequested.start();
             SmsSaveYourself( c->connection(), saveType,
                              true, SmInteractStyleAny, false );
             clientsToSave << c;
             clientsToKill << c;
         } else if (saveOnly.contains(QString::fromLocal8Bit(c->clientId()))) {
             c->resetState();
+            c->saveRequested.start();
             SmsSaveYourself( c->connection(), saveType,
                              true, SmInteractStyleAny, false );
             clientsToSave << c;
@@ -59,13 +59,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <assert.h>
 #include <fcntl.h>
 
+#include <algorithm>
+
 #ifdef HAVE_LIMITS_H
 #include <limits.h>
 #endif
 
 #include <QFile>
+#include <QFileInfo>
 #include <QPushButton>
 #include <QRegularExpression>
+#include <QSet>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <QSocketNotifier>
@@ -603,6 +607,12 @@ KSMServer::KSMServer(InitFlags flags)
 
     state = Idle;
     saveSession = false;
+    clientShutdownTimeout = 15000;
+    minClientShutdownTimeout = 10000;
+    adaptiveShutdownTimeout = true;
+    saveLatenciesLoaded = false;
+    maxParallelRestores = 4;
+    restoreRegistrationTimeout = 2000;
     KConfigGroup config(KSharedConfig::openConfig(), "General");
     clientInteracting = nullptr;
     xonCommand = config.readEntry( "xonCommand", "xon" );
@@ -984,13 +994,8 @@ void KSMServer::restoreSession( const QString &sessionName )
     state = RestoringWMSession;
 
     qCDebug(KSMSERVER) << "KSMServer::restoreSession " << sessionName;
-    KSharedConfig::Ptr config = KSharedConfig::openConfig();
 
     sessionGroup = QLatin1String("Session: ") + sessionName;
-    KConfigGroup configSessionGroup( config, sessionGroup);
-
-    int count =  configSessionGroup.readEntry( "count", 0 );
-    appsToStart = count;
 
     auto reply = m_kwinInterface->loadSession(sessionName);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
@@ -1028,8 +1033,7 @@ void KSMServer::restoreSession()
    m_restoreSessionCall = message();
 
    restoreLegacySession(KSharedConfig::openConfig().data());
-   lastAppStarted = 0;
-   lastIdStarted.clear();
+   prepareRestore();
    state = KSMServer::Restoring;
    connect(this, &KSMServer::sessionRestored, this, [this]() {
         auto reply = m_restoreSessionCall.createReply();
@@ -1042,12 +1046,7 @@ void KSMServer::restoreSession()
 void KSMServer::restoreSubSession( const QString& name )
 {
     sessionGroup = QStringLiteral( "SubSession: " ) + name;
-
-    KConfigGroup configSessionGroup( KSharedConfig::openConfig(), sessionGroup);
-    int count =  configSessionGroup.readEntry( "count", 0 );
-    appsToStart = count;
-    lastAppStarted = 0;
-    lastIdStarted.clear();
+    prepareRestore();
 
     state = RestoringSubSession;
     tryRestoreNext();
@@ -1055,24 +1054,96 @@ void KSMServer::restoreSubSession( const QString& name )
 
 void KSMServer::clientRegistered( const char* previousId )
 {
-    if ( previousId && lastIdStarted == QString::fromLocal8Bit( previousId ) )
+    if ( previousId && restoresInProgress.remove( QString::fromLocal8Bit( previousId ) ) )
         tryRestoreNext();
 }
 
+/*!
+  Collects the clients of the session to restore. The window manager
+  comes first, followed by the clients that have windows on the current
+  desktop, so that what the user sees first is usable as early as possible.
+ */
+void KSMServer::prepareRestore()
+{
+    restoreQueue.clear();
+    restoresInProgress.clear();
+
+    KConfigGroup generalGroup(KSharedConfig::openConfig(), "General");
+    maxParallelRestores = qMax( 1, generalGroup.readEntry( "maxParallelRestores", 4 ) );
+    restoreRegistrationTimeout = generalGroup.readEntry( "restoreTimeoutSecs", 2 ) * 1000;
+
+    QString windowManager = QFileInfo( qEnvironmentVariable( "KDEWM" ) ).fileName();
+    if ( windowManager.isEmpty() )
+        windowManager = QStringLiteral( "kwin_x11" );
+
+    // KWin stores the desktop of each window of the session, keyed by client id
+    const KConfigGroup kwinSessionGroup( KSharedConfig::openConfig( QStringLiteral( "kwinrc" ) ), sessionGroup );
+    const int currentDesktop = kwinSessionGroup.readEntry( "desktop", 1 );
+    QSet<QString> visibleClients;
+    const int windowCount = kwinSessionGroup.readEntry( "count", 0 );
+    for ( int i = 1; i <= windowCount; i++ ) {
+        const QString n = QString::number( i );
+        const int desktop = kwinSessionGroup.readEntry( QStringLiteral( "desktop" ) + n, 0 );
+        if ( desktop == currentDesktop || desktop == -1 )
+            visibleClients.insert( kwinSessionGroup.readEntry( QStringLiteral( "sessionId" ) + n, QString() ) );
+    }
+
+    KConfigGroup config(KSharedConfig::openConfig(), sessionGroup );
+    const int count = config.readEntry( "count", 0 );
+    for ( int i = 1; i <= count; i++ ) {
+        QString n = QString::number(i);
+        PendingRestore restore;
+        restore.restartCommand = config.readEntry( QLatin1String("restartCommand")+n, QStringList() );
+        if ( restore.restartCommand.isEmpty() ||
+             (config.readEntry( QStringLiteral("restartStyleHint")+n, 0 ) == SmRestartNever)) {
+            continue;
+        }
+        restore.clientId = config.readEntry( QLatin1String("clientId")+n, QString() );
+        restore.clientMachine = config.readEntry( QStringLiteral("clientMachine")+n, QString() );
+        restore.userId = config.readEntry( QStringLiteral("userId")+n, QString() );
+
+        const QString program = QFileInfo( config.readEntry( QStringLiteral("program")+n, QString() ) ).fileName();
+        if ( program == windowManager )
+            restore.priority = 0;
+        else if ( visibleClients.contains( restore.clientId ) )
+            restore.priority = 1;
+        else
+            restore.priority = 2;
+        restoreQueue.append( restore );
+    }
+
+    std::stable_sort( restoreQueue.begin(), restoreQueue.end(),
+                      []( const PendingRestore &a, const PendingRestore &b ) {
+                          return a.priority < b.priority;
+                      } );
+}
+
+/*!
+  Launches clients of the session being restored until maxParallelRestores
+  of them are waiting to register. A client that does not register within
+  the restore timeout gives up its slot to the next one, so a misbehaving
+  application cannot stall the rest of the session.
+ */
 void KSMServer::tryRestoreNext()
 {
     if( state != Restoring && state != RestoringSubSession )
         return;
     restoreTimer.stop();
-    KConfigGroup config(KSharedConfig::openConfig(), sessionGroup );
 
-    while ( lastAppStarted < appsToStart ) {
-        lastAppStarted++;
-        QString n = QString::number(lastAppStarted);
-        QString clientId = config.readEntry( QLatin1String("clientId")+n, QString() );
+    for ( auto it = restoresInProgress.begin(); it != restoresInProgress.end(); ) {
+        if ( it.value().elapsed() >= restoreRegistrationTimeout ) {
+            qCDebug(KSMSERVER) << "Client" << it.key() << "did not register in time, continuing restore";
+            it = restoresInProgress.erase( it );
+        } else {
+            ++it;
+        }
+    }
+
+    while ( restoresInProgress.count() < maxParallelRestores && !restoreQueue.isEmpty() ) {
+        const PendingRestore restore = restoreQueue.takeFirst();
         bool alreadyStarted = false;
         foreach ( KSMClient *c, clients ) {
-            if ( QString::fromLocal8Bit( c->clientId() ) == clientId ) {
+            if ( QString::fromLocal8Bit( c->clientId() ) == restore.clientId ) {
                 alreadyStarted = true;
                 break;
             }
@@ -1080,26 +1151,24 @@ void KSMServer::tryRestoreNext()
         if ( alreadyStarted )
             continue;
 
-        QStringList restartCommand = config.readEntry( QLatin1String("restartCommand")+n, QStringList() );
-        if ( restartCommand.isEmpty() ||
-             (config.readEntry( QStringLiteral("restartStyleHint")+n, 0 ) == SmRestartNever)) {
-            continue;
-        }
-        startApplication( restartCommand,
-                          config.readEntry( QStringLiteral("clientMachine")+n, QString() ),
-                          config.readEntry( QStringLiteral("userId")+n, QString() ));
-        lastIdStarted = clientId;
-        if ( !lastIdStarted.isEmpty() ) {
-            restoreTimer.setSingleShot( true );
-            restoreTimer.start( 2000 );
-            return; // we get called again from the clientRegistered handler
+        startApplication( restore.restartCommand, restore.clientMachine, restore.userId );
+        if ( !restore.clientId.isEmpty() ) {
+            QElapsedTimer launched;
+            launched.start();
+            restoresInProgress.insert( restore.clientId, launched );
         }
     }
 
-    //all done
-    appsToStart = 0;
-    lastIdStarted.clear();
+    if ( !restoresInProgress.isEmpty() ) {
+        qint64 remaining = restoreRegistrationTimeout;
+        for ( const QElapsedTimer &launched : qAsConst( restoresInProgress ) )
+            remaining = qMin( remaining, restoreRegistrationTimeout - launched.elapsed() );
+        restoreTimer.setSingleShot( true );
+        restoreTimer.start( qMax<qint64>( 0, remaining ) );
+        return; // we get called again from the clientRegistered handler
+    }
 
+    //all done
     if (state == Restoring) {
         emit sessionRestored();
     } else { //subsession
@@ -51,7 +51,10 @@ extern "C" {
 #include <KConfigGroup>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
+#include <QVariantMap>
 
 #define SESSION_PREVIOUS_LOGOUT "saved at previous logout"
 #define SESSION_BY_USER  "saved by user"
@@ -155,7 +158,16 @@ private:
     void storeSession();
 
     void startProtection();
+    void scheduleProtection();
     void endProtection();
+    int clientSaveTimeout( KSMClient* client );
+    qint64 clientSaveTimeLeft( KSMClient* client );
+    void recordSaveLatency( KSMClient* client, int msecs );
+    void loadSaveLatencies();
+    void storeSaveLatencies();
+
+    void startLogoutPhases();
+    void finishLogoutPhase( const QString &phase );
 
     void startApplication( const QStringList& command,
         const QString& clientMachine = QString(),
@@ -169,11 +181,10 @@ private:
     void storeLegacySession( KConfig* config );
     void restoreLegacySession( KConfig* config );
     void restoreLegacySessionInternal( KConfigGroup* config, char sep = ',' );
-    QStringList windowWmCommand(WId w);
-    QString windowWmClientMachine(WId w);
-    WId windowWmClientLeader(WId w);
-    QByteArray windowSessionId(WId w, WId leader);
+    QStringList windowWmCommand(const QByteArray &property);
+    QString windowWmClientMachine(const QByteArray &property);
 
+    void prepareRestore();
     void tryRestoreNext();
     void startupDone();
 
@@ -196,6 +207,7 @@ private:
 
     void openSwitchUserDialog();
     bool closeSession();
+    QVariantMap logoutPhaseTimings() const;
 
  Q_SIGNALS:
     void subSessionClosed();
@@ -222,12 +234,30 @@ private:
     KSMClient* clientInteracting;
     QString sessionGroup;
     QTimer protectionTimer;
+    QElapsedTimer protectionClock;
+    int clientShutdownTimeout;
+    int minClientShutdownTimeout;
+    bool adaptiveShutdownTimeout;
+    // program name -> smoothed save latency in msecs, persisted across logouts
+    QHash<QString, int> saveLatencies;
+    bool saveLatenciesLoaded;
+    QElapsedTimer logoutPhaseTimer;
+    QVariantMap logoutPhases;
     QTimer restoreTimer;
     QString xonCommand;
-    // sequential startup
-    int appsToStart;
-    int lastAppStarted;
-    QString lastIdStarted;
+    // parallel startup
+    struct PendingRestore
+    {
+        QString clientId;
+        QStringList restartCommand;
+        QString clientMachine;
+        QString userId;
+        int priority;
+    };
+    QList<PendingRestore> restoreQueue;
+    QHash<QString, QElapsedTimer> restoresInProgress; // client id -> time since launch
+    int maxParallelRestores;
+    int restoreRegistrationTimeout;
 
     QStringList excludeApps;
 
@@ -35,6 +35,7 @@
 #include <QTimer>
 #include <QToolButton>
 #include <QWidgetAction>
+#include <QHash>
 #include <QSet>
 #include <QDebug>
 
@@ -87,12 +88,22 @@ public:
     ActionForId m_actionForId;
     QTimer *m_pendingLayoutUpdateTimer;
 
+    // Parent menu of every known item, to skip refreshes covered by an ancestor
+    QHash<int, int> m_parentForId;
+    // Layout revision each menu was last fetched at
+    QHash<int, uint> m_layoutRevisions;
+
     QSet<int> m_idsRefreshedByAboutToShow;
+    QSet<int> m_idsShownFromCache;
     QSet<int> m_pendingLayoutUpdates;
 
+    /**
+     * Fetches the whole subtree below id in one call, so opening a submenu
+     * later on does not need another GetLayout round trip
+     */
     QDBusPendingCallWatcher *refresh(int id)
     {
-        auto call = m_interface->GetLayout(id, 1, QStringList());
+        auto call = m_interface->GetLayout(id, -1, QStringList());
         QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, q);
         watcher->setProperty(DBUSMENU_PROPERTY_ID, id);
         QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
@@ -101,6 +112,53 @@ public:
         return watcher;
     }
 
+    /**
+     * Fetches the properties of several plain items with a single call
+     */
+    void refreshProperties(const QList<int> &ids)
+    {
+        auto call = m_interface->GetGroupProperties(ids, QStringList());
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, q);
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, q, [this](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+
+            QDBusPendingReply<DBusMenuItemList> reply = *watcher;
+            if (reply.isError()) {
+                qDebug(DBUSMENUQT) << "Call to GetGroupProperties() failed:" << reply.error().message();
+                return;
+            }
+
+            for (const DBusMenuItem &item : reply.value()) {
+                QAction *action = m_actionForId.value(item.id);
+                if (!action) {
+                    continue;
+                }
+                updateAction(action, item.properties, mutableKeys(item.properties));
+            }
+        });
+    }
+
+    bool hasPendingAncestor(int id, const QSet<int> &pendingIds) const
+    {
+        for (int parentId = m_parentForId.value(id, -1); parentId != -1; parentId = m_parentForId.value(parentId, -1)) {
+            if (pendingIds.contains(parentId)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static QStringList mutableKeys(const QVariantMap &properties)
+    {
+        QStringList keys = properties.keys();
+        keys.removeOne(QStringLiteral("type"));
+        keys.removeOne(QStringLiteral("toggle-type"));
+        keys.removeOne(QStringLiteral("children-display"));
+        return keys;
+    }
+
+    void updateLayout(QMenu *menu, const DBusMenuLayoutItem &rootItem, uint revision);
+
     QMenu *createMenu(QWidget *parent)
     {
         QMenu *menu = q->createMenu(parent);
@@ -306,10 +364,14 @@ DBusMenuImporter::~DBusMenuImporter()
 
 void DBusMenuImporter::slotLayoutUpdated(uint revision, int parentId)
 {
-    Q_UNUSED(revision)
     if (d->m_idsRefreshedByAboutToShow.remove(parentId)) {
         return;
     }
+    // we already fetched this menu after the change was made
+    auto it = d->m_layoutRevisions.constFind(parentId);
+    if (it != d->m_layoutRevisions.constEnd() && *it >= revision) {
+        return;
+    }
     d->m_pendingLayoutUpdates << parentId;
     if (!d->m_pendingLayoutUpdateTimer->isActive()) {
         d->m_pendingLayoutUpdateTimer->start();
@@ -320,8 +382,24 @@ void DBusMenuImporter::processPendingLayoutUpdates()
 {
     QSet<int> ids = d->m_pendingLayoutUpdates;
     d->m_pendingLayoutUpdates.clear();
-    Q_FOREACH(int id, ids) {
-        d->refresh(id);
+
+    QList<int> itemIds;
+    for (int id : qAsConst(ids)) {
+        // the full depth refresh of an ancestor covers this one as well
+        if (d->hasPendingAncestor(id, ids)) {
+            continue;
+        }
+        QAction *action = d->m_actionForId.value(id);
+        if (action && !action->menu()) {
+            // plain items have no layout of their own, batch their properties
+            itemIds << id;
+        } else {
+            d->refresh(id);
+        }
+    }
+
+    if (!itemIds.isEmpty()) {
+        d->refreshProperties(itemIds);
     }
 }
 
@@ -381,11 +459,13 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
     watcher->deleteLater();
 
     QMenu *menu = d->menuForId(parentId);
+    // the menu was already handed out from the cache, it's patched in place
+    const bool shownFromCache = d->m_idsShownFromCache.remove(parentId);
 
     QDBusPendingReply<uint, DBusMenuLayoutItem> reply = *watcher;
     if (!reply.isValid()) {
         qDebug(DBUSMENUQT) << reply.error().message();
-        if (menu) {
+        if (menu && !shownFromCache) {
             emit menuUpdated(menu);
         }
         return;
@@ -394,6 +474,7 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
     #ifdef BENCHMARK
     DMDEBUG << "- items received:" << sChrono.elapsed() << "ms";
     #endif
+    uint revision = reply.argumentAt<0>();
     DBusMenuLayoutItem rootItem = reply.argumentAt<1>();
 
     if (!menu) {
@@ -401,12 +482,24 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
         return;
     }
 
+    d->updateLayout(menu, rootItem, revision);
+
+    if (!shownFromCache) {
+        emit menuUpdated(menu);
+    }
+}
+
+void DBusMenuImporterPrivate::updateLayout(QMenu *menu, const DBusMenuLayoutItem &rootItem, uint revision)
+{
+    m_layoutRevisions.insert(rootItem.id, revision);
+
     //remove outdated actions
     QSet<int> newDBusMenuItemIds;
     newDBusMenuItemIds.reserve(rootItem.children.count());
     for (const DBusMenuLayoutItem &item: rootItem.children) {
         newDBusMenuItemIds << item.id;
     }
+    QSet<QAction *> outdatedActions;
     for (QAction *action: menu->actions()) {
         int id = action->property(DBUSMENU_PROPERTY_ID).toInt();
         if (! newDBusMenuItemIds.contains(id)) {
@@ -417,47 +510,71 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
             if (action->menu()) {
                 action->menu()->deleteLater();
             }
-            d->m_actionForId.remove(id);
+            m_actionForId.remove(id);
+            outdatedActions << action;
         }
     }
 
     //insert or update new actions into our menu
+    QList<QAction *> orderedActions;
+    orderedActions.reserve(rootItem.children.count());
     for (const DBusMenuLayoutItem &dbusMenuItem: rootItem.children) {
-        DBusMenuImporterPrivate::ActionForId::Iterator it = d->m_actionForId.find(dbusMenuItem.id);
+        ActionForId::Iterator it = m_actionForId.find(dbusMenuItem.id);
         QAction *action = nullptr;
-        if (it == d->m_actionForId.end()) {
+        if (it == m_actionForId.end()) {
             int id = dbusMenuItem.id;
-            action = d->createAction(id, dbusMenuItem.properties, menu);
-            d->m_actionForId.insert(id, action);
+            action = createAction(id, dbusMenuItem.properties, menu);
+            m_actionForId.insert(id, action);
 
-            connect(action, &QObject::destroyed, this, [this, id]() {
-                d->m_actionForId.remove(id);
+            QObject::connect(action, &QObject::destroyed, q, [this, id]() {
+                m_actionForId.remove(id);
+                m_parentForId.remove(id);
+                m_layoutRevisions.remove(id);
             });
 
-            connect(action, &QAction::triggered, this, [ id, this]() {
-                sendClickedEvent(id);
+            QObject::connect(action, &QAction::triggered, q, [ id, this]() {
+                q->sendClickedEvent(id);
             });
 
             if (QMenu *menuAction = action->menu()) {
-                connect(menuAction, &QMenu::aboutToShow, this, &DBusMenuImporter::slotMenuAboutToShow, Qt::UniqueConnection);
+                QObject::connect(menuAction, &QMenu::aboutToShow, q, &DBusMenuImporter::slotMenuAboutToShow, Qt::UniqueConnection);
             }
-            connect(menu, &QMenu::aboutToHide, this, &DBusMenuImporter::slotMenuAboutToHide, Qt::UniqueConnection);
-
-            menu->addAction(action);
+            QObject::connect(menu, &QMenu::aboutToHide, q, &DBusMenuImporter::slotMenuAboutToHide, Qt::UniqueConnection);
         } else {
             action = *it;
-            QStringList filteredKeys = dbusMenuItem.properties.keys();
-            filteredKeys.removeOne("type");
-            filteredKeys.removeOne("toggle-type");
-            filteredKeys.removeOne("children-display");
-            d->updateAction(*it, dbusMenuItem.properties, filteredKeys);
+            updateAction(action, dbusMenuItem.properties, mutableKeys(dbusMenuItem.properties));
+        }
+        m_parentForId.insert(dbusMenuItem.id, rootItem.id);
+        orderedActions << action;
+
+        // the layout was fetched with full depth, fill the submenus right away.
+        // Exporters ignoring the recursion depth only return one level though, a
+        // submenu without children in the reply is only emptied when the item no
+        // longer announces any, otherwise it is kept until AboutToShow fetches it
+        if (action->menu()) {
+            const bool hasSubmenu = dbusMenuItem.properties.value(QStringLiteral("children-display")).toString() == QLatin1String("submenu");
+            if (!dbusMenuItem.children.isEmpty() || !hasSubmenu) {
+                updateLayout(action->menu(), dbusMenuItem, revision);
+            }
+        }
+    }
+
+    // Only touch the menu if the order changed, removing and re-adding every
+    // action makes QMenu recompute its layout for each of them.
+    QList<QAction *> currentActions;
+    currentActions.reserve(orderedActions.count());
+    for (QAction *action : menu->actions()) {
+        if (!outdatedActions.contains(action)) {
+            currentActions << action;
+        }
+    }
+    if (currentActions != orderedActions) {
+        for (QAction *action : qAsConst(orderedActions)) {
             // Move the action to the tail so we can keep the order same as the dbus request.
             menu->removeAction(action);
             menu->addAction(action);
         }
     }
-
-    emit menuUpdated(menu);
 }
 
 void DBusMenuImporter::sendClickedEvent(int id)
@@ -479,6 +596,15 @@ void DBusMenuImporter::updateMenu(QMenu * menu)
 
     int id = action->property(DBUSMENU_PROPERTY_ID).toInt();
 
+    // A menu whose layout is known and up to date is handed out right away,
+    // AboutToShow then only patches it in place if the application changes it.
+    const bool cached = !menu->actions().isEmpty()
+        && d->m_layoutRevisions.contains(id)
+        && !d->m_pendingLayoutUpdates.contains(id);
+    if (cached) {
+        d->m_idsShownFromCache << id;
+    }
+
     auto call = d->m_interface->AboutToShow(id);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
     watcher->setProperty(DBUSMENU_PROPERTY_ID, id);
@@ -487,6 +613,10 @@ void DBusMenuImporter::updateMenu(QMenu * menu)
 
     // Firefox deliberately ignores "aboutToShow" whereas Qt ignores" opened", so we'll just send both all the time...
     d->sendEvent(id, QStringLiteral("opened"));
+
+    if (cached) {
+        emit menuUpdated(menu);
+    }
 }
 
 void DBusMenuImporter::slotAboutToShowDBusCallFinished(QDBusPendingCallWatcher *watcher)
@@ -496,13 +626,16 @@ void DBusMenuImporter::slotAboutToShowDBusCallFinished(QDBusPendingCallWatcher *
 
     QMenu *menu = d->menuForId(id);
     if (!menu) {
+        d->m_idsShownFromCache.remove(id);
         return;
     }
 
     QDBusPendingReply<bool> reply = *watcher;
     if (reply.isError()) {
         qDebug(DBUSMENUQT) << "Call to AboutToShow() failed:" << reply.error().message();
-        menuUpdated(menu);
+        if (!d->m_idsShownFromCache.remove(id)) {
+            menuUpdated(menu);
+        }
         return;
     }
     //Note, this isn't used by Qt's QPT - but we get a LayoutChanged emitted before
@@ -512,7 +645,7 @@ void DBusMenuImporter::slotAboutToShowDBusCallFinished(QDBusPendingCallWatcher *
     if (needRefresh || menu->actions().isEmpty()) {
         d->m_idsRefreshedByAboutToShow << id;
         d->refresh(id);
-    } else if (menu) {
+    } else if (!d->m_idsShownFromCache.remove(id)) {
         menuUpdated(menu);
     }
 }
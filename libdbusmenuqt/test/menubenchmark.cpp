@@ -0,0 +1,264 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Exports a large mock menu on its own bus connection and measures how long
+ * DBusMenuImporter takes to load it and to open its submenus: fetched when
+ * opened, as with applications that only return one level of the layout,
+ * and prefetched with the layout.
+ *
+ * Usage: dbusmenubenchmark [top level menus] [items per menu] [submenu depth]
+ * Needs a session bus, run with QT_QPA_PLATFORM=offscreen on headless systems.
+ */
+
+#include <QApplication>
+
+#include <QDBusConnection>
+#include <QDBusVariant>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QMenu>
+#include <QTimer>
+#include <QVector>
+#include <QDebug>
+
+#include <functional>
+
+#include <dbusmenuimporter.h>
+#include <dbusmenutypes_p.h>
+
+class MockMenuExporter : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.canonical.dbusmenu")
+
+public:
+    MockMenuExporter(int menus, int items, int depth, QObject *parent = nullptr);
+
+    int itemCount() const
+    {
+        return m_items.count();
+    }
+
+    /** Returns at most @p depth levels, whatever the importer asks for */
+    void setMaxDepth(int depth)
+    {
+        m_maxDepth = depth;
+    }
+
+public Q_SLOTS:
+    uint GetLayout(int parentId, int recursionDepth, const QStringList &propertyNames, DBusMenuLayoutItem &item);
+    DBusMenuItemList GetGroupProperties(const QList<int> &ids, const QStringList &propertyNames);
+    bool AboutToShow(int id);
+    void Event(int id, const QString &eventId, const QDBusVariant &data, uint timestamp);
+
+Q_SIGNALS:
+    void LayoutUpdated(uint revision, int parentId);
+    void ItemsPropertiesUpdated(const DBusMenuItemList &updatedProps, const DBusMenuItemKeysList &removedProps);
+    void ItemActivationRequested(int id, uint timestamp);
+
+private:
+    struct Item {
+        QVariantMap properties;
+        QVector<int> children;
+    };
+
+    int addMenu(int parentId, const QString &label, int items, int depth);
+    void fillLayout(int id, int recursionDepth, DBusMenuLayoutItem &item) const;
+
+    QHash<int, Item> m_items;
+    uint m_revision = 1;
+    int m_maxDepth = -1;
+};
+
+MockMenuExporter::MockMenuExporter(int menus, int items, int depth, QObject *parent)
+    : QObject(parent)
+{
+    m_items.insert(0, Item());
+    for (int i = 0; i < menus; ++i) {
+        addMenu(0, QStringLiteral("Menu %1").arg(i), items, depth);
+    }
+}
+
+int MockMenuExporter::addMenu(int parentId, const QString &label, int items, int depth)
+{
+    const int id = m_items.count();
+    Item menu;
+    menu.properties.insert(QStringLiteral("label"), label);
+    menu.properties.insert(QStringLiteral("children-display"), QStringLiteral("submenu"));
+    m_items.insert(id, menu);
+    m_items[parentId].children << id;
+
+    for (int i = 0; i < items; ++i) {
+        const QString itemLabel = QStringLiteral("%1 / Item %2").arg(label).arg(i);
+        // every tenth entry opens another level
+        if (depth > 1 && i % 10 == 9) {
+            addMenu(id, itemLabel, items, depth - 1);
+            continue;
+        }
+
+        const int itemId = m_items.count();
+        Item item;
+        item.properties.insert(QStringLiteral("label"), itemLabel);
+        if (i % 5 == 0) {
+            item.properties.insert(QStringLiteral("toggle-type"), QStringLiteral("checkmark"));
+            item.properties.insert(QStringLiteral("toggle-state"), i % 2);
+        }
+        if (i % 7 == 0) {
+            item.properties.insert(QStringLiteral("enabled"), false);
+        }
+        m_items.insert(itemId, item);
+        m_items[id].children << itemId;
+    }
+    return id;
+}
+
+void MockMenuExporter::fillLayout(int id, int recursionDepth, DBusMenuLayoutItem &item) const
+{
+    const Item &source = m_items[id];
+    item.id = id;
+    item.properties = source.properties;
+    if (recursionDepth == 0) {
+        return;
+    }
+    for (int childId : source.children) {
+        DBusMenuLayoutItem child;
+        fillLayout(childId, recursionDepth < 0 ? recursionDepth : recursionDepth - 1, child);
+        item.children << child;
+    }
+}
+
+uint MockMenuExporter::GetLayout(int parentId, int recursionDepth, const QStringList &propertyNames, DBusMenuLayoutItem &item)
+{
+    Q_UNUSED(propertyNames)
+    if (m_maxDepth >= 0 && (recursionDepth < 0 || recursionDepth > m_maxDepth)) {
+        recursionDepth = m_maxDepth;
+    }
+    fillLayout(parentId, recursionDepth, item);
+    return m_revision;
+}
+
+DBusMenuItemList MockMenuExporter::GetGroupProperties(const QList<int> &ids, const QStringList &propertyNames)
+{
+    Q_UNUSED(propertyNames)
+    DBusMenuItemList list;
+    for (int id : ids) {
+        list << DBusMenuItem{id, m_items.value(id).properties};
+    }
+    return list;
+}
+
+bool MockMenuExporter::AboutToShow(int id)
+{
+    Q_UNUSED(id)
+    return false;
+}
+
+void MockMenuExporter::Event(int id, const QString &eventId, const QDBusVariant &data, uint timestamp)
+{
+    Q_UNUSED(id)
+    Q_UNUSED(eventId)
+    Q_UNUSED(data)
+    Q_UNUSED(timestamp)
+}
+
+static qint64 waitForMenu(DBusMenuImporter *importer, QMenu *menu, const std::function<void()> &trigger)
+{
+    QEventLoop loop;
+    QElapsedTimer timer;
+    qint64 elapsed = -1;
+    auto connection = QObject::connect(importer, &DBusMenuImporter::menuUpdated, &loop, [&](QMenu *updated) {
+        if (updated == menu && elapsed < 0) {
+            elapsed = timer.nsecsElapsed() / 1000;
+            loop.quit();
+        }
+    });
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+
+    timer.start();
+    // cached menus are handed out before updateMenu() returns
+    trigger();
+    if (elapsed < 0) {
+        loop.exec();
+    }
+    QObject::disconnect(connection);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    const int menus = args.value(1, QStringLiteral("10")).toInt();
+    const int items = args.value(2, QStringLiteral("60")).toInt();
+    const int depth = args.value(3, QStringLiteral("3")).toInt();
+
+    DBusMenuTypes_register();
+
+    // a connection of its own, so the calls go through the bus like with a real application
+    QDBusConnection exporterBus = QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("dbusmenubenchmark"));
+    MockMenuExporter exporter(menus, items, depth);
+    MockMenuExporter shallowExporter(menus, items, depth);
+    shallowExporter.setMaxDepth(1);
+    if (!exporterBus.registerObject(QStringLiteral("/MenuBar"), &exporter, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals)
+        || !exporterBus.registerObject(QStringLiteral("/ShallowMenuBar"), &shallowExporter, QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals)) {
+        qWarning() << "Could not export the mock menu:" << exporterBus.lastError().message();
+        return 1;
+    }
+    qInfo() << "Mock menu with" << exporter.itemCount() << "items";
+
+    // opens every submenu of the menu bar once, returns the average time
+    auto openSubmenus = [](DBusMenuImporter *importer) -> qint64 {
+        qint64 total = 0;
+        int opened = 0;
+        const auto actions = importer->menu()->actions();
+        for (QAction *action : actions) {
+            QMenu *menu = action->menu();
+            if (!menu) {
+                continue;
+            }
+            total += waitForMenu(importer, menu, [importer, menu]() {
+                importer->updateMenu(menu);
+            });
+            ++opened;
+        }
+        return opened ? total / opened : -1;
+    };
+
+    DBusMenuImporter shallowImporter(exporterBus.baseService(), QStringLiteral("/ShallowMenuBar"));
+    const qint64 shallowLoadTime = waitForMenu(&shallowImporter, shallowImporter.menu(), [&shallowImporter]() {
+        shallowImporter.updateMenu();
+    });
+    qInfo() << "Initial load of one level:" << shallowLoadTime << "us";
+    qInfo() << "Open, fetching the submenu:" << openSubmenus(&shallowImporter) << "us on average";
+
+    DBusMenuImporter importer(exporterBus.baseService(), QStringLiteral("/MenuBar"));
+    const qint64 loadTime = waitForMenu(&importer, importer.menu(), [&importer]() {
+        importer.updateMenu();
+    });
+    qInfo() << "Initial load of the full layout:" << loadTime << "us";
+    qInfo() << "Open, prefetched:" << openSubmenus(&importer) << "us on average";
+
+    QDBusConnection::disconnectFromBus(exporterBus.name());
+    return 0;
+}
+
+#include "menubenchmark.moc"
@@ -0,0 +1,276 @@
+/* Copyright 2026  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "freespacemonitor.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <functional>
+
+#include <sys/statvfs.h>
+
+// Checks while the free space changes or runs low
+static const qint64 s_minInterval = 5 * 1000;
+static const qint64 s_lowSpaceInterval = 15 * 1000;
+static const qint64 s_initialInterval = 30 * 1000;
+// Checks of a stable file system back off up to this
+static const qint64 s_maxInterval = 2 * 60 * 1000;
+// Unresponsive file systems back off up to this
+static const qint64 s_maxUnresponsiveInterval = 10 * 60 * 1000;
+static const qint64 s_notRespondingTimeout = 15 * 1000;
+
+// Threads for responsive file systems, hanging queries get extra ones
+static const int s_threadCount = 4;
+
+// A change of this many bytes counts as the file system being in use
+static const quint64 s_significantChange = 16 * 1024 * 1024;
+
+Q_GLOBAL_STATIC(FreeSpaceMonitor, s_freeSpaceMonitor)
+
+// Lets the queries outlive the monitor: a query stuck on a dead network
+// mount must not be waited for, nor report to a deleted monitor.
+struct FreeSpaceMonitorChannel {
+    QMutex mutex;
+    FreeSpaceMonitor *monitor = nullptr;
+};
+
+namespace {
+
+class FreeSpaceQuery : public QRunnable
+{
+public:
+    FreeSpaceQuery(const QString &path, const QSharedPointer<FreeSpaceMonitorChannel> &channel,
+                   const std::function<void(bool, quint64, quint64)> &callback)
+        : m_path(path)
+        , m_channel(channel)
+        , m_callback(callback)
+    {
+    }
+
+    void run() override
+    {
+        struct statvfs buf;
+        const bool ok = statvfs(QFile::encodeName(m_path).constData(), &buf) == 0;
+        const quint64 size = ok ? quint64(buf.f_blocks) * buf.f_frsize : 0;
+        const quint64 available = ok ? quint64(buf.f_bavail) * buf.f_frsize : 0;
+
+        QMutexLocker locker(&m_channel->mutex);
+        if (m_channel->monitor) {
+            auto callback = m_callback;
+            QMetaObject::invokeMethod(m_channel->monitor, [callback, ok, size, available] {
+                callback(ok, size, available);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QString m_path;
+    QSharedPointer<FreeSpaceMonitorChannel> m_channel;
+    std::function<void(bool, quint64, quint64)> m_callback;
+};
+
+}
+
+FreeSpaceMonitor *FreeSpaceMonitor::self()
+{
+    return s_freeSpaceMonitor();
+}
+
+FreeSpaceMonitor::FreeSpaceMonitor()
+    : QObject()
+    , m_pool(new QThreadPool)
+    , m_channel(new FreeSpaceMonitorChannel)
+{
+    m_channel->monitor = this;
+
+    // one per file system being checked at the same time; a hanging
+    // mount keeps its thread busy, so the pool grows by one for it
+    // and the others are not stalled
+    m_pool->setMaxThreadCount(s_threadCount);
+
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &FreeSpaceMonitor::processMounts);
+    m_clock.start();
+}
+
+FreeSpaceMonitor::~FreeSpaceMonitor()
+{
+    {
+        QMutexLocker locker(&m_channel->mutex);
+        m_channel->monitor = nullptr;
+    }
+
+    m_pool->clear();
+    if (m_pool->waitForDone(100)) {
+        delete m_pool;
+    }
+    // otherwise a query hangs in the kernel, leak the pool rather than block
+}
+
+void FreeSpaceMonitor::watch(const QString &path)
+{
+    Mount &mount = m_mounts[path];
+    ++mount.watchers;
+    if (mount.watchers > 1) {
+        return;
+    }
+
+    mount.interval = s_initialInterval;
+    check(path, mount);
+    schedule();
+}
+
+void FreeSpaceMonitor::unwatch(const QString &path)
+{
+    auto it = m_mounts.find(path);
+    if (it == m_mounts.end()) {
+        return;
+    }
+
+    if (--it->watchers <= 0) {
+        m_mounts.erase(it);
+        schedule();
+    }
+}
+
+FreeSpaceMonitor::Info FreeSpaceMonitor::info(const QString &path) const
+{
+    return m_mounts.value(path).info;
+}
+
+void FreeSpaceMonitor::check(const QString &path, Mount &mount)
+{
+    mount.checking = true;
+    mount.checkStarted = m_clock.elapsed();
+
+    // the path was watched again while the query of an earlier watch is
+    // still running, wait for that one instead of stacking up threads
+    if (m_queries.contains(path)) {
+        mount.notResponding = m_hungQueries.contains(path);
+        return;
+    }
+    m_queries.insert(path);
+
+    m_pool->start(new FreeSpaceQuery(path, m_channel, [this, path](bool ok, quint64 size, quint64 available) {
+        checkFinished(path, ok, size, available);
+    }));
+}
+
+void FreeSpaceMonitor::checkFinished(const QString &path, bool ok, quint64 size, quint64 available)
+{
+    m_queries.remove(path);
+    if (m_hungQueries.remove(path)) {
+        m_pool->setMaxThreadCount(m_pool->maxThreadCount() - 1);
+    }
+
+    auto it = m_mounts.find(path);
+    if (it == m_mounts.end()) {
+        // nobody is interested anymore
+        return;
+    }
+    Mount &mount = *it;
+
+    mount.checking = false;
+
+    if (!ok) {
+        mount.interval = qMin(mount.interval * 2, s_maxInterval);
+    } else if (mount.notResponding) {
+        // answered in the end, but keep the load off a flaky network file system
+        mount.interval = qMin(mount.interval * 4, s_maxUnresponsiveInterval);
+        mount.notResponding = false;
+    } else {
+        const quint64 change = mount.info.valid ? qMax(available, mount.info.available) - qMin(available, mount.info.available) : 0;
+        const bool lowSpace = size > 0 && available < size / 10;
+
+        if (change >= s_significantChange) {
+            mount.interval = s_minInterval;
+        } else if (lowSpace) {
+            mount.interval = qMin(mount.interval * 2, s_lowSpaceInterval);
+        } else {
+            mount.interval = qMin(mount.interval * 2, s_maxInterval);
+        }
+    }
+    mount.nextCheck = m_clock.elapsed() + mount.interval;
+
+    if (ok && (!mount.info.valid || mount.info.size != size || mount.info.available != available)) {
+        mount.info.size = size;
+        mount.info.available = available;
+        mount.info.valid = true;
+        emit freeSpaceChanged(path, size, available);
+    }
+
+    schedule();
+}
+
+void FreeSpaceMonitor::processMounts()
+{
+    const qint64 now = m_clock.elapsed();
+
+    QStringList unresponsive;
+    for (auto it = m_mounts.begin(), end = m_mounts.end(); it != end; ++it) {
+        Mount &mount = *it;
+        if (mount.checking) {
+            if (!mount.notResponding && now - mount.checkStarted >= s_notRespondingTimeout) {
+                mount.notResponding = true;
+                unresponsive << it.key();
+                if (!m_hungQueries.contains(it.key())) {
+                    m_hungQueries.insert(it.key());
+                    m_pool->setMaxThreadCount(m_pool->maxThreadCount() + 1);
+                }
+            }
+        } else if (mount.nextCheck <= now) {
+            check(it.key(), mount);
+        }
+    }
+
+    schedule();
+
+    for (const QString &path : qAsConst(unresponsive)) {
+        emit notResponding(path);
+    }
+}
+
+void FreeSpaceMonitor::schedule()
+{
+    qint64 next = -1;
+    for (const Mount &mount : qAsConst(m_mounts)) {
+        qint64 due;
+        if (mount.checking) {
+            if (mount.notResponding) {
+                continue;
+            }
+            due = mount.checkStarted + s_notRespondingTimeout;
+        } else {
+            due = mount.nextCheck;
+        }
+        if (next < 0 || due < next) {
+            next = due;
+        }
+    }
+
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start(int(qMax<qint64>(0, next - m_clock.elapsed())));
+}
@@ -0,0 +1,115 @@
+/* Copyright 2026  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FREESPACEMONITOR_H
+#define FREESPACEMONITOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+
+class QThreadPool;
+
+struct FreeSpaceMonitorChannel;
+
+/**
+ * Keeps track of the free space of mounted file systems.
+ *
+ * The file systems are queried with statvfs on a small thread pool of its
+ * own, so a hanging network mount only blocks itself. Every path is checked
+ * at its own pace: often while its free space is changing or running low,
+ * rarely while it is stable, and with a growing backoff while it doesn't
+ * respond. A path is never queried again while a query for it is still
+ * running, and the pool gets an extra thread for every query that hangs.
+ *
+ * The library is linked statically into the soliddevice data engine
+ * (plasmashell) and the free space notifier (kded), which run in separate
+ * processes. Each process has its own monitor and checks its own paths.
+ */
+class FreeSpaceMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Info {
+        quint64 size = 0;
+        quint64 available = 0;
+        bool valid = false;
+    };
+
+    /**
+     * The monitor shared by everything in this process, use this instead
+     * of creating instances.
+     */
+    static FreeSpaceMonitor *self();
+
+    FreeSpaceMonitor();
+    ~FreeSpaceMonitor() override;
+
+    /**
+     * Starts checking @p path, the first result is reported right away.
+     * Every call must be balanced by a call to unwatch().
+     */
+    void watch(const QString &path);
+    void unwatch(const QString &path);
+
+    /**
+     * @return the last known free space of a watched @p path
+     */
+    Info info(const QString &path) const;
+
+Q_SIGNALS:
+    void freeSpaceChanged(const QString &path, quint64 size, quint64 available);
+    /**
+     * Emitted once when a query for @p path takes unusually long,
+     * e.g. because its network file system is unreachable.
+     */
+    void notResponding(const QString &path);
+
+private:
+    struct Mount {
+        int watchers = 0;
+        Info info;
+        qint64 interval = 0; // ms
+        qint64 nextCheck = 0; // ms on m_clock
+        qint64 checkStarted = 0; // ms on m_clock
+        bool checking = false;
+        bool notResponding = false;
+    };
+
+    void check(const QString &path, Mount &mount);
+    void checkFinished(const QString &path, bool ok, quint64 size, quint64 available);
+    void processMounts();
+    void schedule();
+
+    QHash<QString, Mount> m_mounts;
+    // paths with a query running, which may outlive their Mount
+    QSet<QString> m_queries;
+    // queries declared not responding, each holds a thread of the pool
+    QSet<QString> m_hungQueries;
+    QThreadPool *m_pool;
+    QSharedPointer<FreeSpaceMonitorChannel> m_channel;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+};
+
+#endif
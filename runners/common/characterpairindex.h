@@ -0,0 +1,87 @@
+/* Copyright 2026  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHARACTERPAIRINDEX_H
+#define CHARACTERPAIRINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * Posting lists of the pairs of adjacent characters in a set of texts,
+ * used by runners to narrow substring searches down to a few candidates.
+ *
+ * A text containing a term contains every pair of the term, so the
+ * shortest posting list among the term's pairs holds every entry that
+ * can match. The candidates still have to be checked with contains().
+ */
+class CharacterPairIndex
+{
+public:
+    /**
+     * Indexes @p foldedText as belonging to entry @p entry.
+     * Entries have to be added in ascending order.
+     */
+    void add(int entry, const QString &foldedText)
+    {
+        for (int i = 1; i < foldedText.length(); ++i) {
+            QVector<int> &postings = m_pairs[pairKey(foldedText.at(i - 1), foldedText.at(i))];
+            // a text may contain the same pair more than once
+            if (postings.isEmpty() || postings.last() != entry) {
+                postings.append(entry);
+            }
+        }
+    }
+
+    /**
+     * The entries which might contain @p foldedTerm, in ascending order.
+     * A term shorter than two characters has no pairs to narrow with,
+     * @p narrowed is set to false then and every entry is a candidate.
+     */
+    QVector<int> candidates(const QString &foldedTerm, bool *narrowed) const
+    {
+        *narrowed = foldedTerm.length() >= 2;
+        if (!*narrowed) {
+            return {};
+        }
+
+        const QVector<int> *rarest = nullptr;
+        for (int i = 1; i < foldedTerm.length(); ++i) {
+            const auto it = m_pairs.constFind(pairKey(foldedTerm.at(i - 1), foldedTerm.at(i)));
+            if (it == m_pairs.constEnd()) {
+                return {};
+            }
+            if (!rarest || it->count() < rarest->count()) {
+                rarest = &it.value();
+            }
+        }
+        return *rarest;
+    }
+
+private:
+    static quint32 pairKey(QChar first, QChar second)
+    {
+        return (quint32(first.unicode()) << 16) | second.unicode();
+    }
+
+    QHash<quint32, QVector<int>> m_pairs;
+};
+
+#endif
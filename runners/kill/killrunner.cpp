@@ -23,6 +23,7 @@
 #include <QAction>
 #include <QDebug>
 #include <QIcon>
+#include <QtConcurrentRun>
 
 #include <KProcess>
 #include <KAuth>
@@ -31,6 +32,8 @@
 #include <processcore/processes.h>
 #include <processcore/process.h>
 
+#include "processindex.h"
+
 K_EXPORT_PLASMA_RUNNER_WITH_JSON(KillRunner, "plasma-runner-kill.json")
 
 KillRunner::KillRunner(QObject *parent, const QVariantList &args)
@@ -45,12 +48,21 @@ KillRunner::KillRunner(QObject *parent, const QVariantList &args)
     connect(this, &Plasma::AbstractRunner::prepare, this, &KillRunner::prep);
     connect(this, &Plasma::AbstractRunner::teardown, this, &KillRunner::cleanup);
 
-    m_delayedCleanupTimer.setInterval(50);
+    // Keep the process table up to date while the user is typing, the
+    // refresh only reads what changed in /proc since the last one
+    m_refreshTimer.setInterval(2000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &KillRunner::refresh);
+
+    m_delayedCleanupTimer.setInterval(5 * 60 * 1000);
     m_delayedCleanupTimer.setSingleShot(true);
-    connect(&m_delayedCleanupTimer, &QTimer::timeout, this, &KillRunner::cleanup);
+    connect(&m_delayedCleanupTimer, &QTimer::timeout, this, &KillRunner::releaseProcesses);
 }
 
-KillRunner::~KillRunner() = default;
+KillRunner::~KillRunner()
+{
+    m_refreshWatcher.waitForFinished();
+    delete m_processes;
+}
 
 
 void KillRunner::reloadConfiguration()
@@ -72,22 +84,69 @@ void KillRunner::reloadConfiguration()
 void KillRunner::prep()
 {
     m_delayedCleanupTimer.stop();
+    refresh();
+    m_refreshTimer.start();
 }
 
 void KillRunner::cleanup()
 {
+    m_refreshTimer.stop();
+    m_delayedCleanupTimer.start();
+}
+
+void KillRunner::refresh()
+{
+    if (m_refreshWatcher.isRunning()) {
+        return;
+    }
+
     if (!m_processes) {
+        m_processes = new KSysGuard::Processes();
+    }
+
+    KSysGuard::Processes *processes = m_processes;
+    m_refreshWatcher.setFuture(QtConcurrent::run([this, processes] {
+        processes->updateAllProcesses();
+
+        const QList<KSysGuard::Process *> processlist = processes->getAllProcesses();
+        QVector<ProcessIndex::Entry> entries;
+        entries.reserve(processlist.count());
+        for (const KSysGuard::Process *process : processlist) {
+            entries.append({quint64(process->pid()), process->name(),
+                            qreal(process->userUsage() + process->sysUsage())});
+        }
+        QSharedPointer<const ProcessIndex> index(new ProcessIndex(entries));
+
+        QMutexLocker locker(&m_indexLock);
+        m_index = index;
+        m_indexReady.wakeAll();
+    }));
+}
+
+void KillRunner::releaseProcesses()
+{
+    if (m_refreshWatcher.isRunning()) {
+        m_delayedCleanupTimer.start();
         return;
     }
 
-    if (m_prepLock.tryLockForWrite()) {
-        delete m_processes;
-        m_processes = nullptr;
+    delete m_processes;
+    m_processes = nullptr;
 
-        m_prepLock.unlock();
-    } else {
-        m_delayedCleanupTimer.stop();
+    QMutexLocker locker(&m_indexLock);
+    m_index.reset();
+}
+
+QSharedPointer<const ProcessIndex> KillRunner::processIndex(const Plasma::RunnerContext &context)
+{
+    QMutexLocker locker(&m_indexLock);
+    if (!m_index) {
+        QMetaObject::invokeMethod(this, &KillRunner::refresh, Qt::QueuedConnection);
+        while (!m_index && context.isValid()) {
+            m_indexReady.wait(&m_indexLock, 100);
+        }
     }
+    return m_index;
 }
 
 void KillRunner::match(Plasma::RunnerContext &context)
@@ -97,37 +156,25 @@ void KillRunner::match(Plasma::RunnerContext &context)
         return;
     }
 
-    m_prepLock.lockForRead();
-    if (!m_processes) {
-        m_prepLock.unlock();
-        m_prepLock.lockForWrite();
-        if (!m_processes) {
-            suspendMatching(true);
-            m_processes = new KSysGuard::Processes();
-            m_processes->updateAllProcesses();
-            suspendMatching(false);
-        }
-    }
-    m_prepLock.unlock();
-
     term = term.right(term.length() - m_triggerWord.length());
 
     if (term.length() < 2)  {
         return;
     }
 
+    const QSharedPointer<const ProcessIndex> index = processIndex(context);
+    if (!index) {
+        return;
+    }
+
     QList<Plasma::QueryMatch> matches;
-    const QList<KSysGuard::Process *> processlist = m_processes->getAllProcesses();
-    for (const KSysGuard::Process *process : processlist) {
+    const QVector<const ProcessIndex::Entry *> processlist = index->match(term);
+    for (const ProcessIndex::Entry *process : processlist) {
         if (!context.isValid()) {
             return;
         }
-        const QString name = process->name();
-        if (!name.contains(term, Qt::CaseInsensitive)) {
-            continue;
-        }
-
-        const quint64 pid = process->pid();
+        const QString &name = process->name;
+        const quint64 pid = process->pid;
         Plasma::QueryMatch match(this);
         match.setText(i18n("Terminate %1", name));
         match.setSubtext(i18n("Process ID: %1", QString::number(pid)));
@@ -138,10 +185,10 @@ void KillRunner::match(Plasma::RunnerContext &context)
         // Set the relevance
         switch (m_sorting) {
         case Sort::CPU:
-            match.setRelevance((process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(process->cpuUsage / 100);
             break;
         case Sort::CPUI:
-            match.setRelevance(1 - (process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(1 - process->cpuUsage / 100);
             break;
         case Sort::NONE:
             match.setRelevance(name.compare(term, Qt::CaseInsensitive) == 0 ? 1 : 9);
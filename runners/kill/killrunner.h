@@ -21,13 +21,17 @@
 #ifndef KILLRUNNER_H
 #define KILLRUNNER_H
 
-#include <QReadWriteLock>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QTimer>
+#include <QWaitCondition>
 
 #include <KRunner/AbstractRunner>
 
 #include "config_keys.h"
 class QAction;
+class ProcessIndex;
 
 namespace KSysGuard
 {
@@ -51,21 +55,38 @@ public:
 private Q_SLOTS:
     void prep();
     void cleanup();
+    void refresh();
+    void releaseProcesses();
 
 private:
+    /** The latest process table, waits for the first one if there is none yet */
+    QSharedPointer<const ProcessIndex> processIndex(const Plasma::RunnerContext &context);
+
     /** The trigger word */
     QString m_triggerWord;
 
     /** How to sort */
     Sort m_sorting;
 
-    /** process lister */
+    /** process lister, only used by the refresh job */
     KSysGuard::Processes *m_processes;
 
-    /** lock for initializing m_processes */
-    QReadWriteLock m_prepLock;
+    /** snapshot of the process table shared by the match threads */
+    QSharedPointer<const ProcessIndex> m_index;
+
+    /** lock for swapping m_index */
+    QMutex m_indexLock;
+
+    /** signalled when a new snapshot is available */
+    QWaitCondition m_indexReady;
+
+    /** running refresh of the process table */
+    QFutureWatcher<void> m_refreshWatcher;
+
+    /** timer for refreshing the process table during a match session */
+    QTimer m_refreshTimer;
 
-    /** timer for retrying the cleanup due to lock contention */
+    /** timer for releasing the process table some time after the session ended */
     QTimer m_delayedCleanupTimer;
 
     /** Reuse actions */
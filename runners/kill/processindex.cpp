@@ -0,0 +1,58 @@
+/* Copyright 2026  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "processindex.h"
+
+ProcessIndex::ProcessIndex(const QVector<Entry> &entries)
+    : m_entries(entries)
+{
+    m_foldedNames.reserve(m_entries.count());
+    for (int i = 0; i < m_entries.count(); ++i) {
+        const QString folded = m_entries.at(i).name.toCaseFolded();
+        m_foldedNames.append(folded);
+        m_pairs.add(i, folded);
+    }
+}
+
+QVector<const ProcessIndex::Entry *> ProcessIndex::match(const QString &term) const
+{
+    QVector<const Entry *> matches;
+    const QString folded = term.toCaseFolded();
+    if (folded.isEmpty()) {
+        return matches;
+    }
+
+    bool narrowed;
+    const QVector<int> candidates = m_pairs.candidates(folded, &narrowed);
+    if (!narrowed) {
+        for (int i = 0; i < m_entries.count(); ++i) {
+            if (m_foldedNames.at(i).contains(folded)) {
+                matches.append(&m_entries.at(i));
+            }
+        }
+        return matches;
+    }
+
+    for (int i : candidates) {
+        if (m_foldedNames.at(i).contains(folded)) {
+            matches.append(&m_entries.at(i));
+        }
+    }
+    return matches;
+}
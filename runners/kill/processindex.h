@@ -0,0 +1,58 @@
+/* Copyright 2026  agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCESSINDEX_H
+#define PROCESSINDEX_H
+
+#include <QString>
+#include <QVector>
+
+#include "../common/characterpairindex.h"
+
+/**
+ * Immutable snapshot of the process table with a name index.
+ *
+ * Substring lookups go through posting lists of the character pairs
+ * occurring in the lower cased process names, so a query only has to
+ * look at the processes sharing its rarest pair instead of every
+ * process in the system. Snapshots are never modified once built and
+ * can be shared between match threads without locking.
+ */
+class ProcessIndex
+{
+public:
+    struct Entry {
+        quint64 pid;
+        QString name;
+        /** Total CPU usage in percent */
+        qreal cpuUsage;
+    };
+
+    explicit ProcessIndex(const QVector<Entry> &entries);
+
+    /** Entries whose name contains @p term, compared case-insensitively */
+    QVector<const Entry *> match(const QString &term) const;
+
+private:
+    QVector<Entry> m_entries;
+    QVector<QString> m_foldedNames;
+    CharacterPairIndex m_pairs;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) version 3, or any
+ *   later version accepted by the membership of KDE e.V. (or its
+ *   successor approved by the membership of KDE e.V.), which shall
+ *   act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KSycoca>
+
+#include "../serviceindex.h"
+
+#include <algorithm>
+#include <clocale>
+
+class ServiceIndexTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testCaseFolding();
+    void testShortWords();
+    void testNoFalseNegatives();
+
+private:
+    static QStringList fields(const ServiceIndex::Entry &entry);
+    static bool contains(const ServiceIndex::Entry &entry, const QString &word);
+};
+
+void ServiceIndexTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    auto appsPath = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
+    QDir(appsPath).removeRecursively();
+    QVERIFY(QDir().mkpath(appsPath));
+    auto fixtureDir = QDir(QFINDTESTDATA("fixtures"));
+    const auto infoList = fixtureDir.entryInfoList(QDir::Files);
+    for (const auto &fileInfo : infoList) {
+        auto source = fileInfo.absoluteFilePath();
+        auto target = appsPath + QDir::separator() + fileInfo.fileName();
+        QVERIFY2(QFile::copy(fileInfo.absoluteFilePath(), target),
+                 qPrintable(QStringLiteral("can't copy %1 => %2").arg(source, target)));
+    }
+
+    setlocale(LC_ALL, "C.utf8");
+
+    KSycoca::self()->ensureCacheValid();
+
+    QVERIFY(setenv("XDG_CURRENT_DESKTOP", "KDE", 1) == 0);
+}
+
+QStringList ServiceIndexTest::fields(const ServiceIndex::Entry &entry)
+{
+    QStringList fields = {entry.foldedName, entry.foldedGenericName, entry.foldedComment,
+                          entry.foldedExec, entry.foldedDesktopEntryName};
+    fields += entry.foldedKeywords;
+    fields += entry.foldedCategories;
+    for (const ServiceIndex::Action &action : entry.actions) {
+        fields << action.foldedText;
+    }
+    return fields;
+}
+
+// what a full scan without the index would find
+bool ServiceIndexTest::contains(const ServiceIndex::Entry &entry, const QString &word)
+{
+    const QString folded = ServiceIndex::fold(word);
+    const QStringList entryFields = fields(entry);
+    for (const QString &field : entryFields) {
+        if (field.contains(folded)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ServiceIndexTest::testCaseFolding()
+{
+    const ServiceIndex index;
+
+    int konsole = -1;
+    for (int i = 0; i < index.entries().count(); ++i) {
+        if (index.entries().at(i).desktopEntryName == QLatin1String("org.kde.konsole")) {
+            konsole = i;
+        }
+    }
+    QVERIFY(konsole != -1);
+
+    QVERIFY(index.candidates(QStringLiteral("konsole")).contains(konsole));
+    QVERIFY(index.candidates(QStringLiteral("KONSOLE")).contains(konsole));
+    QVERIFY(index.candidates(QStringLiteral("KonSole")).contains(konsole));
+    QCOMPARE(index.candidates(QStringLiteral("KONSOLE")), index.candidates(QStringLiteral("konsole")));
+}
+
+void ServiceIndexTest::testShortWords()
+{
+    const ServiceIndex index;
+    QVERIFY(!index.entries().isEmpty());
+
+    // a single character has no pair to narrow with, every entry is a candidate
+    for (const QString &word : {QString(), QStringLiteral("k"), QStringLiteral("K"), QStringLiteral("é")}) {
+        const QVector<int> candidates = index.candidates(word);
+        QCOMPARE(candidates.count(), index.entries().count());
+        for (int i = 0; i < candidates.count(); ++i) {
+            QCOMPARE(candidates.at(i), i);
+        }
+    }
+}
+
+void ServiceIndexTest::testNoFalseNegatives()
+{
+    const ServiceIndex index;
+    const QVector<ServiceIndex::Entry> &entries = index.entries();
+
+    // every substring of up to a few characters of every field, in both
+    // cases, plus some words nothing contains
+    QSet<QString> words = {QStringLiteral("xyzzy"), QStringLiteral("qq"), QStringLiteral("été")};
+    for (const ServiceIndex::Entry &entry : entries) {
+        const QStringList entryFields = fields(entry);
+        for (const QString &field : entryFields) {
+            for (int from = 0; from < field.length(); ++from) {
+                for (int length = 2; length <= 5 && from + length <= field.length(); ++length) {
+                    const QString word = field.mid(from, length);
+                    words << word << word.toUpper();
+                }
+            }
+        }
+    }
+    QVERIFY(words.count() > 100);
+
+    for (const QString &word : qAsConst(words)) {
+        const QVector<int> candidates = index.candidates(word);
+        for (int i = 0; i < entries.count(); ++i) {
+            if (contains(entries.at(i), word)) {
+                QVERIFY2(candidates.contains(i),
+                         qPrintable(QStringLiteral("%1 not a candidate for \"%2\"").arg(entries.at(i).storageId, word)));
+            }
+        }
+        QVERIFY(std::is_sorted(candidates.cbegin(), candidates.cend()));
+    }
+
+    QVERIFY(index.candidates(QStringLiteral("xyzzy")).isEmpty());
+}
+
+QTEST_MAIN(ServiceIndexTest)
+
+#include "serviceindextest.moc"
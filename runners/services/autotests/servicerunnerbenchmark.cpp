@@ -0,0 +1,122 @@
+/*
+ *   Copyright (C) 2026 agent <agent@local>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) version 3, or any
+ *   later version accepted by the membership of KDE e.V. (or its
+ *   successor approved by the membership of KDE e.V.), which shall
+ *   act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KSycoca>
+
+#include "../servicerunner.h"
+
+#include <clocale>
+
+static const int s_serviceCount = 2000;
+
+class ServiceRunnerBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkQuery_data();
+    void benchmarkQuery();
+
+private:
+    QString m_servicesPath;
+};
+
+void ServiceRunnerBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    m_servicesPath = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation)
+        + QStringLiteral("/servicerunnerbenchmark");
+    QDir(m_servicesPath).removeRecursively();
+    QVERIFY(QDir().mkpath(m_servicesPath));
+
+    // Names loosely modeled after a typical installation, so that short
+    // prefixes match many services and longer ones only a few
+    const QStringList words = {
+        QStringLiteral("Konsole"), QStringLiteral("Kate"), QStringLiteral("Office"), QStringLiteral("Editor"),
+        QStringLiteral("Viewer"), QStringLiteral("Player"), QStringLiteral("Manager"), QStringLiteral("Settings"),
+        QStringLiteral("Browser"), QStringLiteral("Terminal"), QStringLiteral("Calculator"), QStringLiteral("Monitor"),
+    };
+    for (int i = 0; i < s_serviceCount; ++i) {
+        const QString word = words.at(i % words.count());
+        const QString other = words.at((i / words.count()) % words.count());
+        QFile file(m_servicesPath + QStringLiteral("/benchmark-%1.desktop").arg(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QStringLiteral("[Desktop Entry]\n"
+                                  "Type=Application\n"
+                                  "Name=%1 %2 %3\n"
+                                  "GenericName=%2 for %1\n"
+                                  "Comment=Benchmark application number %3\n"
+                                  "Keywords=%1;%2;benchmark;\n"
+                                  "Categories=Qt;KDE;Utility;\n"
+                                  "Exec=benchmark-%3 %u\n"
+                                  "Icon=application-x-executable\n").arg(word, other, QString::number(i)).toUtf8());
+    }
+
+    setlocale(LC_ALL, "C.utf8");
+
+    KSycoca::self()->ensureCacheValid();
+}
+
+void ServiceRunnerBenchmark::cleanupTestCase()
+{
+    QDir(m_servicesPath).removeRecursively();
+}
+
+void ServiceRunnerBenchmark::benchmarkQuery_data()
+{
+    QTest::addColumn<QString>("query");
+
+    const QString word = QStringLiteral("konso");
+    for (int length = 1; length <= word.length(); ++length) {
+        QTest::newRow(qPrintable(word.left(length))) << word.left(length);
+    }
+}
+
+void ServiceRunnerBenchmark::benchmarkQuery()
+{
+    QFETCH(QString, query);
+
+    ServiceRunner runner(this, QVariantList());
+    // build the index outside of the measured part
+    {
+        Plasma::RunnerContext context;
+        context.setQuery(QStringLiteral("warm up"));
+        runner.match(context);
+    }
+
+    QBENCHMARK {
+        Plasma::RunnerContext context;
+        context.setQuery(query);
+        runner.match(context);
+    }
+}
+
+QTEST_MAIN(ServiceRunnerBenchmark)
+
+#include "servicerunnerbenchmark.moc"
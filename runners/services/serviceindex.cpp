@@ -0,0 +1,121 @@
+/*
+ *   Copyright (C) 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "serviceindex.h"
+
+#include <numeric>
+
+#include <KService>
+#include <KServiceAction>
+#include <KServiceTypeTrader>
+
+static ServiceIndex::Entry entryForService(const KService::Ptr &service, bool moduleListing)
+{
+    ServiceIndex::Entry entry;
+    entry.moduleListing = moduleListing;
+    entry.storageId = service->storageId();
+    entry.desktopEntryName = service->desktopEntryName();
+    entry.name = service->name();
+    entry.genericName = service->genericName();
+    entry.comment = service->comment();
+    entry.exec = service->exec();
+    entry.icon = service->icon();
+
+    entry.foldedName = ServiceIndex::fold(entry.name);
+    entry.foldedGenericName = ServiceIndex::fold(entry.genericName);
+    entry.foldedComment = ServiceIndex::fold(entry.comment);
+    entry.foldedExec = ServiceIndex::fold(entry.exec);
+    entry.foldedDesktopEntryName = ServiceIndex::fold(entry.desktopEntryName);
+    const QStringList keywords = service->keywords();
+    for (const QString &keyword : keywords) {
+        entry.foldedKeywords << ServiceIndex::fold(keyword);
+    }
+    const QStringList categories = service->categories();
+    for (const QString &category : categories) {
+        entry.foldedCategories << ServiceIndex::fold(category);
+    }
+
+    const auto actions = service->actions();
+    for (const KServiceAction &action : actions) {
+        entry.actions.append({action.name(), action.text(), ServiceIndex::fold(action.text()),
+                              action.exec(), action.icon()});
+    }
+
+    entry.kcm = service->serviceTypes().contains(QLatin1String("KCModule"));
+    entry.noDisplay = service->noDisplay();
+    entry.application = service->isApplication();
+    entry.kde = categories.contains(QLatin1String("KDE")) || entry.kcm;
+    entry.secondary = categories.contains(QLatin1String("X-KDE-More")) || !service->showInCurrentDesktop();
+    entry.kinfocenterModule = service->parentApp() == QLatin1String("kinfocenter");
+    return entry;
+}
+
+ServiceIndex::ServiceIndex()
+{
+    const KService::List applications = KServiceTypeTrader::self()->query(QStringLiteral("Application"));
+    const KService::List modules = KServiceTypeTrader::self()->query(QStringLiteral("KCModule"));
+    m_entries.reserve(applications.count() + modules.count());
+
+    for (const KService::Ptr &service : applications) {
+        addEntry(entryForService(service, false));
+    }
+    for (const KService::Ptr &service : modules) {
+        addEntry(entryForService(service, true));
+    }
+}
+
+void ServiceIndex::addEntry(Entry &&entry)
+{
+    const int index = m_entries.count();
+
+    QString text = entry.foldedName + QLatin1Char('\n') + entry.foldedGenericName + QLatin1Char('\n')
+        + entry.foldedComment + QLatin1Char('\n') + entry.foldedExec + QLatin1Char('\n')
+        + entry.foldedDesktopEntryName + QLatin1Char('\n')
+        + entry.foldedKeywords.join(QLatin1Char('\n')) + QLatin1Char('\n')
+        + entry.foldedCategories.join(QLatin1Char('\n'));
+    for (const Action &action : qAsConst(entry.actions)) {
+        text += QLatin1Char('\n') + action.foldedText;
+    }
+
+    m_pairs.add(index, text);
+
+    m_entries.append(std::move(entry));
+}
+
+const QVector<ServiceIndex::Entry> &ServiceIndex::entries() const
+{
+    return m_entries;
+}
+
+QVector<int> ServiceIndex::candidates(const QString &word) const
+{
+    bool narrowed;
+    const QVector<int> candidates = m_pairs.candidates(fold(word), &narrowed);
+    if (!narrowed) {
+        QVector<int> all(m_entries.count());
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+    }
+    return candidates;
+}
+
+QString ServiceIndex::fold(const QString &text)
+{
+    return text.toCaseFolded();
+}
+
@@ -0,0 +1,102 @@
+/*
+ *   Copyright (C) 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SERVICEINDEX_H
+#define SERVICEINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "../common/characterpairindex.h"
+
+/**
+ * In-memory snapshot of the searchable fields of all applications and
+ * KCModules known to KSycoca.
+ *
+ * All fields are stored case folded next to their display values, and the
+ * pairs of adjacent characters in them are indexed, so looking up the
+ * services mentioning a word only has to visit the ones sharing its rarest
+ * character pair instead of running a trader query over the whole
+ * database. An index never changes once built and is rebuilt when the
+ * sycoca database changes.
+ */
+class ServiceIndex
+{
+public:
+    struct Action {
+        QString name;
+        QString text;
+        QString foldedText;
+        QString exec;
+        QString icon;
+    };
+
+    struct Entry {
+        QString storageId;
+        QString desktopEntryName;
+        QString name;
+        QString genericName;
+        QString comment;
+        QString exec;
+        QString icon;
+
+        QString foldedName;
+        QString foldedGenericName;
+        QString foldedComment;
+        QString foldedExec;
+        QString foldedDesktopEntryName;
+        QStringList foldedKeywords;
+        QStringList foldedCategories;
+
+        QVector<Action> actions;
+
+        /** Whether this entry was listed as KCModule rather than as Application */
+        bool moduleListing = false;
+        /** Whether the service has the KCModule service type */
+        bool kcm = false;
+        bool noDisplay = false;
+        bool application = false;
+        /** In the KDE category or a KCModule */
+        bool kde = false;
+        /** In X-KDE-More or hidden in the current desktop */
+        bool secondary = false;
+        bool kinfocenterModule = false;
+    };
+
+    /** Builds the index from the current sycoca database */
+    ServiceIndex();
+
+    const QVector<Entry> &entries() const;
+
+    /**
+     * Indexes of the entries which might contain @p word in any of their
+     * fields, in sycoca order. Entries not listed certainly don't contain it.
+     */
+    QVector<int> candidates(const QString &word) const;
+
+    static QString fold(const QString &text);
+
+private:
+    void addEntry(Entry &&entry);
+
+    QVector<Entry> m_entries;
+    CharacterPairIndex m_pairs;
+};
+
+#endif
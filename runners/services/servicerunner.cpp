@@ -35,12 +35,13 @@
 #include <KNotificationJobUiDelegate>
 #include <KService>
 #include <KServiceAction>
-#include <KServiceTypeTrader>
 #include <KStringHandler>
+#include <KSycoca>
 
 #include <KIO/ApplicationLauncherJob>
 
 #include "debug.h"
+#include "serviceindex.h"
 
 namespace {
 
@@ -56,8 +57,9 @@ int weightedLength(const QString &query) {
 class ServiceFinder
 {
 public:
-    ServiceFinder(ServiceRunner *runner)
+    ServiceFinder(ServiceRunner *runner, const ServiceIndex &index)
          : m_runner(runner)
+         , m_index(index)
     {}
 
 
@@ -68,6 +70,7 @@ public:
         }
 
         term = context.query();
+        foldedTerm = ServiceIndex::fold(term);
         weightedTermLength = weightedLength(term);
 
         matchExectuables();
@@ -79,112 +82,106 @@ public:
     }
 
 private:
+    using Entry = ServiceIndex::Entry;
 
-    void seen(const KService::Ptr &service)
+    void seen(const Entry &service)
     {
-        m_seen.insert(service->storageId());
-        m_seen.insert(service->exec());
+        m_seen.insert(service.storageId);
+        m_seen.insert(service.exec);
     }
 
-    void seen(const KServiceAction &action)
+    void seen(const ServiceIndex::Action &action)
     {
-        m_seen.insert(action.exec());
+        m_seen.insert(action.exec);
     }
 
-    bool hasSeen(const KService::Ptr &service)
+    bool hasSeen(const Entry &service)
     {
-        return m_seen.contains(service->storageId()) &&
-               m_seen.contains(service->exec());
+        return m_seen.contains(service.storageId) &&
+               m_seen.contains(service.exec);
     }
 
-    bool hasSeen(const KServiceAction &action)
+    bool hasSeen(const ServiceIndex::Action &action)
     {
-        return m_seen.contains(action.exec());
+        return m_seen.contains(action.exec);
     }
 
-    bool disqualify(const KService::Ptr &service)
+    bool disqualify(const Entry &service)
     {
-        auto ret = hasSeen(service) || service->noDisplay();
-        qCDebug(RUNNER_SERVICES) << service->name() << "disqualified?" << ret;
+        auto ret = hasSeen(service) || service.noDisplay;
+        qCDebug(RUNNER_SERVICES) << service.name << "disqualified?" << ret;
         seen(service);
         return ret;
     }
 
-    qreal increaseMatchRelavance(const KService::Ptr &service, const QVector<QStringRef> &strList, const QString &category)
+    qreal increaseMatchRelavance(const QString &field, const QStringList &strList)
     {
         //Increment the relevance based on all the words (other than the first) of the query list
         qreal relevanceIncrement = 0;
 
         for(int i = 1; i < strList.size(); ++i) {
-            const auto &str = strList.at(i);
-            if (category == QLatin1String("Name")) {
-                if (service->name().contains(str, Qt::CaseInsensitive)) {
-                    relevanceIncrement += 0.01;
-                }
-            } else if (category == QLatin1String("GenericName")) {
-                if (service->genericName().contains(str, Qt::CaseInsensitive)) {
-                    relevanceIncrement += 0.01;
-                }
-            } else if (category == QLatin1String("Exec")) {
-                if (service->exec().contains(str, Qt::CaseInsensitive)) {
-                    relevanceIncrement += 0.01;
-                }
-            } else if (category == QLatin1String("Comment")) {
-                if (service->comment().contains(str, Qt::CaseInsensitive)) {
-                    relevanceIncrement += 0.01;
-                }
+            if (field.contains(strList.at(i))) {
+                relevanceIncrement += 0.01;
             }
         }
 
         return relevanceIncrement;
     }
 
-    QString generateQuery(const QVector<QStringRef> &strList)
+    static bool containsAll(const QString &field, const QStringList &strList)
     {
-        QString keywordTemplate = QStringLiteral("exist Keywords");
-        QString genericNameTemplate = QStringLiteral("exist GenericName");
-        QString nameTemplate = QStringLiteral("exist Name");
-        QString commentTemplate = QStringLiteral("exist Comment");
-
-        // Search for applications which are executable and the term case-insensitive matches any of
-        // * a substring of one of the keywords
-        // * a substring of the GenericName field
-        // * a substring of the Name field
-        // Note that before asking for the content of e.g. Keywords and GenericName we need to ask if
-        // they exist to prevent a tree evaluation error if they are not defined.
-        for (const QStringRef &str : strList)
-        {
-            keywordTemplate += QStringLiteral(" and '%1' ~subin Keywords").arg(str.toString());
-            genericNameTemplate += QStringLiteral(" and '%1' ~~ GenericName").arg(str.toString());
-            nameTemplate += QStringLiteral(" and '%1' ~~ Name").arg(str.toString());
-            commentTemplate += QStringLiteral(" and '%1' ~~ Comment").arg(str.toString());
-        }
+        return std::all_of(strList.begin(), strList.end(), [&field](const QString &str) {
+            return field.contains(str);
+        });
+    }
 
-        QString finalQuery = QStringLiteral("exist Exec and ( (%1) or (%2) or (%3) or ('%4' ~~ Exec) or (%5) )")
-            .arg(keywordTemplate, genericNameTemplate, nameTemplate, strList[0].toString(), commentTemplate);
+    static bool containedInAny(const QStringList &fields, const QString &str)
+    {
+        return std::any_of(fields.begin(), fields.end(), [&str](const QString &field) {
+            return field.contains(str);
+        });
+    }
 
-        qCDebug(RUNNER_SERVICES) << "Final query : " << finalQuery;
-        return finalQuery;
+    // Applications which are executable and where the term case-insensitively matches any of
+    // * a substring of one of the keywords
+    // * a substring of the GenericName field
+    // * a substring of the Name field
+    // * a substring of the Exec field (first word only)
+    // * a substring of the Comment field
+    bool matchesAllWords(const Entry &service, const QStringList &strList)
+    {
+        if (!service.foldedKeywords.isEmpty()) {
+            const bool keywordsMatch = std::all_of(strList.begin(), strList.end(), [&service](const QString &str) {
+                return containedInAny(service.foldedKeywords, str);
+            });
+            if (keywordsMatch) {
+                return true;
+            }
+        }
+        return (!service.genericName.isEmpty() && containsAll(service.foldedGenericName, strList))
+            || (!service.name.isEmpty() && containsAll(service.foldedName, strList))
+            || service.foldedExec.contains(strList.first())
+            || (!service.comment.isEmpty() && containsAll(service.foldedComment, strList));
     }
 
-    void setupMatch(const KService::Ptr &service, Plasma::QueryMatch &match)
+    void setupMatch(const Entry &service, Plasma::QueryMatch &match)
     {
-        const QString name = service->name();
+        const QString &name = service.name;
 
         match.setText(name);
 
-        QUrl url(service->storageId());
+        QUrl url(service.storageId);
         url.setScheme(QStringLiteral("applications"));
         match.setData(url);
 
-        if (!service->genericName().isEmpty() && service->genericName() != name) {
-            match.setSubtext(service->genericName());
-        } else if (!service->comment().isEmpty()) {
-            match.setSubtext(service->comment());
+        if (!service.genericName.isEmpty() && service.genericName != name) {
+            match.setSubtext(service.genericName);
+        } else if (!service.comment.isEmpty()) {
+            match.setSubtext(service.comment);
         }
 
-        if (!service->icon().isEmpty()) {
-            match.setIconName(service->icon());
+        if (!service.icon.isEmpty()) {
+            match.setIconName(service.icon);
         }
     }
 
@@ -195,17 +192,15 @@ private:
         }
 
         // Search for applications which are executable and case-insensitively match the search term
-        // See https://techbase.kde.org/Development/Tutorials/Services/Traders#The_KTrader_Query_Language
-        // if the following is unclear to you.
-        query = QStringLiteral("exist Exec and ('%1' =~ Name)").arg(term);
-        const KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
-
-        if (services.isEmpty()) {
-            return;
-        }
+        const auto &entries = m_index.entries();
+        const QVector<int> candidates = m_index.candidates(term);
+        for (int i : candidates) {
+            const Entry &service = entries.at(i);
+            if (service.moduleListing || service.exec.isEmpty() || service.foldedName != foldedTerm) {
+                continue;
+            }
 
-        for (const KService::Ptr &service : services) {
-            qCDebug(RUNNER_SERVICES) << service->name() << "is an exact match!" << service->storageId() << service->exec();
+            qCDebug(RUNNER_SERVICES) << service.name << "is an exact match!" << service.storageId << service.exec;
             if (disqualify(service)) {
                 continue;
             }
@@ -220,28 +215,31 @@ private:
     void matchNameKeywordAndGenericName()
     {
         //Splitting the query term to match using subsequences
-        QVector<QStringRef> queryList = term.splitRef(QLatin1Char(' '));
+        const QStringList queryList = foldedTerm.split(QLatin1Char(' '));
 
-        // If the term length is < 3, no real point searching the Keywords and GenericName
-        if (weightedTermLength < 3) {
-            query = QStringLiteral("exist Exec and ( (exist Name and '%1' ~~ Name) or ('%1' ~~ Exec) )").arg(term);
-        } else {
-            //Match using subsequences (Bug: 262837)
-            query = generateQuery(queryList);
-        }
+        // Every match contains the first word somewhere
+        const auto &entries = m_index.entries();
+        const QVector<int> candidates = m_index.candidates(queryList.first());
 
-        KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
-        services += KServiceTypeTrader::self()->query(QStringLiteral("KCModule"), query);
+        for (int i : candidates) {
+            const Entry &service = entries.at(i);
+            if (service.exec.isEmpty()) {
+                continue;
+            }
 
-        qCDebug(RUNNER_SERVICES) << "got " << services.count() << " services from " << query;
-        for (const KService::Ptr &service : qAsConst(services)) {
-            if (disqualify(service)) {
+            // If the term length is < 3, no real point searching the Keywords and GenericName
+            if (weightedTermLength < 3) {
+                if (!(!service.name.isEmpty() && service.foldedName.contains(foldedTerm))
+                    && !service.foldedExec.contains(foldedTerm)) {
+                    continue;
+                }
+            } else if (!matchesAllWords(service, queryList)) { //Match using subsequences (Bug: 262837)
                 continue;
             }
 
-            const QString id = service->storageId();
-            const QString name = service->desktopEntryName();
-            const QString exec = service->exec();
+            if (disqualify(service)) {
+                continue;
+            }
 
             Plasma::QueryMatch match(m_runner);
             match.setType(Plasma::QueryMatch::PossibleMatch);
@@ -251,50 +249,50 @@ private:
             // If the term was < 3 chars and NOT at the beginning of the App's name or Exec, then
             // chances are the user doesn't want that app.
             if (weightedTermLength < 3) {
-                if (name.startsWith(term, Qt::CaseInsensitive) || exec.startsWith(term, Qt::CaseInsensitive)) {
+                if (service.foldedDesktopEntryName.startsWith(foldedTerm) || service.foldedExec.startsWith(foldedTerm)) {
                     relevance = 0.9;
                 } else {
                     continue;
                 }
-            } else if (service->name().contains(queryList[0], Qt::CaseInsensitive)) {
+            } else if (service.foldedName.contains(queryList[0])) {
                 relevance = 0.8;
-                relevance += increaseMatchRelavance(service, queryList, QStringLiteral("Name"));
+                relevance += increaseMatchRelavance(service.foldedName, queryList);
 
-                if (service->name().startsWith(queryList[0], Qt::CaseInsensitive)) {
+                if (service.foldedName.startsWith(queryList[0])) {
                     relevance += 0.1;
                 }
-            } else if (service->genericName().contains(queryList[0], Qt::CaseInsensitive)) {
+            } else if (service.foldedGenericName.contains(queryList[0])) {
                 relevance = 0.65;
-                relevance += increaseMatchRelavance(service, queryList, QStringLiteral("GenericName"));
+                relevance += increaseMatchRelavance(service.foldedGenericName, queryList);
 
-                if (service->genericName().startsWith(queryList[0], Qt::CaseInsensitive)) {
+                if (service.foldedGenericName.startsWith(queryList[0])) {
                     relevance += 0.05;
                 }
-            } else if (service->exec().contains(queryList[0], Qt::CaseInsensitive)) {
+            } else if (service.foldedExec.contains(queryList[0])) {
                 relevance = 0.7;
-                relevance += increaseMatchRelavance(service, queryList, QStringLiteral("Exec"));
+                relevance += increaseMatchRelavance(service.foldedExec, queryList);
 
-                if (service->exec().startsWith(queryList[0], Qt::CaseInsensitive)) {
+                if (service.foldedExec.startsWith(queryList[0])) {
                     relevance += 0.05;
                 }
-            } else if (service->comment().contains(queryList[0], Qt::CaseInsensitive)) {
+            } else if (service.foldedComment.contains(queryList[0])) {
                 relevance = 0.5;
-                relevance += increaseMatchRelavance(service, queryList, QStringLiteral("Comment"));
+                relevance += increaseMatchRelavance(service.foldedComment, queryList);
 
-                if (service->comment().startsWith(queryList[0], Qt::CaseInsensitive)) {
+                if (service.foldedComment.startsWith(queryList[0])) {
                     relevance += 0.05;
                 }
             }
 
-            if (service->categories().contains(QLatin1String("KDE")) || service->serviceTypes().contains(QLatin1String("KCModule"))) {
-                qCDebug(RUNNER_SERVICES) << "found a kde thing" << id << match.subtext() << relevance;
+            if (service.kde) {
+                qCDebug(RUNNER_SERVICES) << "found a kde thing" << service.storageId << match.subtext() << relevance;
                 relevance += .09;
             }
 
-            qCDebug(RUNNER_SERVICES) << service->name() << "is this relevant:" << relevance;
+            qCDebug(RUNNER_SERVICES) << service.name << "is this relevant:" << relevance;
             match.setRelevance(relevance);
-            if (service->serviceTypes().contains(QLatin1String("KCModule"))) {
-                if (service->parentApp() == QStringLiteral("kinfocenter")) {
+            if (service.kcm) {
+                if (service.kinfocenterModule) {
                     match.setMatchCategory(i18n("System Information"));
                 } else {
                     match.setMatchCategory(i18n("System Settings"));
@@ -307,11 +305,16 @@ private:
     void matchCategories()
     {
         //search for applications whose categories contains the query
-        query = QStringLiteral("exist Exec and (exist Categories and '%1' ~subin Categories)").arg(term);
-        const auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+        const auto &entries = m_index.entries();
+        const QVector<int> candidates = m_index.candidates(term);
+        for (int i : candidates) {
+            const Entry &service = entries.at(i);
+            if (service.moduleListing || service.exec.isEmpty()
+                || !containedInAny(service.foldedCategories, foldedTerm)) {
+                continue;
+            }
 
-        for (const KService::Ptr &service : services) {
-            qCDebug(RUNNER_SERVICES) << service->name() << "is an exact match!" << service->storageId() << service->exec();
+            qCDebug(RUNNER_SERVICES) << service.name << "is an exact match!" << service.storageId << service.exec;
             if (disqualify(service)) {
                 continue;
             }
@@ -321,12 +324,11 @@ private:
             setupMatch(service, match);
 
             qreal relevance = 0.6;
-            if (service->categories().contains(QLatin1String("X-KDE-More")) ||
-                    !service->showInCurrentDesktop()) {
+            if (service.secondary) {
                 relevance = 0.5;
             }
 
-            if (service->isApplication()) {
+            if (service.application) {
                 relevance += .04;
             }
 
@@ -341,41 +343,39 @@ private:
             return;
         }
 
-        query = QStringLiteral("exist Actions"); // doesn't work
-        const auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"));//, query);
-
-        for (const KService::Ptr &service : services) {
-            if (service->noDisplay()) {
+        // Walks all applications since skipping an action also depends on the ones seen before it
+        const auto &entries = m_index.entries();
+        for (const Entry &service : entries) {
+            if (service.moduleListing || service.noDisplay) {
                 continue;
             }
 
-            const auto actions = service->actions();
-            for (const KServiceAction &action : actions) {
-                if (action.text().isEmpty() || action.exec().isEmpty() || hasSeen(action)) {
+            for (const ServiceIndex::Action &action : service.actions) {
+                if (action.text.isEmpty() || action.exec.isEmpty() || hasSeen(action)) {
                     continue;
                 }
                 seen(action);
 
-                const int matchIndex = action.text().indexOf(term, 0, Qt::CaseInsensitive);
+                const int matchIndex = action.foldedText.indexOf(foldedTerm);
                 if (matchIndex < 0) {
                     continue;
                 }
 
                 Plasma::QueryMatch match(m_runner);
                 match.setType(Plasma::QueryMatch::PossibleMatch);
-                if (!action.icon().isEmpty()) {
-                    match.setIconName(action.icon());
+                if (!action.icon.isEmpty()) {
+                    match.setIconName(action.icon);
                 } else {
-                    match.setIconName(service->icon());
+                    match.setIconName(service.icon);
                 }
                 match.setText(i18nc("Jump list search result, %1 is action (eg. open new tab), %2 is application (eg. browser)",
-                                    "%1 - %2", action.text(), service->name()));
+                                    "%1 - %2", action.text, service.name));
 
-                QUrl url(service->storageId());
+                QUrl url(service.storageId);
                 url.setScheme(QStringLiteral("applications"));
 
                 QUrlQuery query;
-                query.addQueryItem(QStringLiteral("action"), action.name());
+                query.addQueryItem(QStringLiteral("action"), action.name);
                 url.setQuery(query);
 
                 match.setData(url);
@@ -393,11 +393,12 @@ private:
     }
 
     ServiceRunner *m_runner;
+    const ServiceIndex &m_index;
     QSet<QString> m_seen;
 
     QList<Plasma::QueryMatch> matches;
-    QString query;
     QString term;
+    QString foldedTerm;
     int weightedTermLength = -1;
 };
 
@@ -408,6 +409,11 @@ ServiceRunner::ServiceRunner(QObject *parent, const QVariantList &args)
     setPriority(AbstractRunner::HighestPriority);
 
     addSyntax(Plasma::RunnerSyntax(QStringLiteral(":q:"), i18n("Finds applications whose name or description match :q:")));
+
+    connect(KSycoca::self(), QOverload<>::of(&KSycoca::databaseChanged), this, [this] {
+        QMutexLocker locker(&m_indexMutex);
+        m_index.reset();
+    });
 }
 
 ServiceRunner::~ServiceRunner() = default;
@@ -429,11 +435,21 @@ QIcon ServiceRunner::categoryIcon(const QString& category) const
 }
 
 
+QSharedPointer<const ServiceIndex> ServiceRunner::index()
+{
+    QMutexLocker locker(&m_indexMutex);
+    if (!m_index) {
+        m_index.reset(new ServiceIndex);
+    }
+    return m_index;
+}
+
 void ServiceRunner::match(Plasma::RunnerContext &context)
 {
     // This helper class aids in keeping state across numerous
     // different queries that together form the matches set.
-    ServiceFinder finder(this);
+    const QSharedPointer<const ServiceIndex> serviceIndex = index();
+    ServiceFinder finder(this, *serviceIndex);
     finder.match(context);
 }
 
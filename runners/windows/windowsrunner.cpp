@@ -18,26 +18,106 @@
  ***************************************************************************/
 #include "windowsrunner.h"
 
-#include "config-windowsrunner.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 #include <QTimer>
 
 #include <QDebug>
-#include <QIcon>
+#include <QIconEngine>
 #include <QMutexLocker>
+#include <QPainter>
+#include <QPair>
+#include <QVector>
+#include <KWindowInfo>
 #include <KWindowSystem>
 #include <KLocalizedString>
 
 #if HAVE_X11
 #include <QX11Info>
 #include <netwm.h>
+#include <xcb/xcb.h>
 #endif
 
 K_EXPORT_PLASMA_RUNNER_WITH_JSON(WindowsRunner, "plasma-runner-windows.json")
 
+// Fetches the icon of a window the first time it is painted, which happens
+// in the main thread and only for the matches that actually get shown
+class WindowIconEngine : public QIconEngine
+{
+public:
+    explicit WindowIconEngine(WId window)
+        : m_window(window)
+    {
+    }
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override
+    {
+        icon().paint(painter, rect, Qt::AlignCenter, mode, state);
+    }
+
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        return icon().pixmap(size, mode, state);
+    }
+
+    QSize actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        return icon().actualSize(size, mode, state);
+    }
+
+    QIconEngine *clone() const override
+    {
+        WindowIconEngine *engine = new WindowIconEngine(m_window);
+        engine->m_icon = m_icon;
+        engine->m_fetched = m_fetched;
+        return engine;
+    }
+
+private:
+    const QIcon &icon()
+    {
+        if (!m_fetched) {
+            m_fetched = true;
+            m_icon = QIcon(KWindowSystem::icon(m_window));
+        }
+        return m_icon;
+    }
+
+    WId m_window;
+    QIcon m_icon;
+    bool m_fetched = false;
+};
+
+bool WindowsRunner::WindowData::isOnDesktop(int desktop) const
+{
+    return this->desktop == NET::OnAllDesktops || this->desktop == desktop;
+}
+
+bool WindowsRunner::WindowData::actionSupported(NET::Action action) const
+{
+    return allowedActions & action;
+}
+
+// ignore NET::Tool and other special window types
+static bool isMatchableWindowType(NET::WindowType type)
+{
+    return type == NET::Normal || type == NET::Override || type == NET::Unknown ||
+           type == NET::Dialog || type == NET::Utility;
+}
+
+static const NET::WindowTypes s_windowTypeMask = NET::NormalMask | NET::DesktopMask | NET::DockMask |
+                                                 NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+                                                 NET::OverrideMask | NET::TopMenuMask |
+                                                 NET::UtilityMask | NET::SplashMask;
+
 WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
     : AbstractRunner(parent, args),
-      m_inSession(false)
+      m_inSession(false),
+      m_gathering(false),
+      m_tracking(false),
+      m_desktopsChanged(true)
 {
     setObjectName(QStringLiteral("Windows"));
 
@@ -68,57 +148,439 @@ WindowsRunner::~WindowsRunner()
 // Called in the main thread
 void WindowsRunner::gatherInfo()
 {
+    m_gathering = false;
     if (!m_inSession) {
+        m_mutex.unlock();
         return;
     }
 
-    const auto windows = KWindowSystem::windows();
+    // The window list is kept across match sessions, afterwards only the
+    // windows that changed in between are fetched again
+    if (!m_tracking) {
+        m_tracking = true;
+        connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &WindowsRunner::windowAdded);
+        connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &WindowsRunner::windowRemoved);
+        void (KWindowSystem::*windowChangedSignal)(WId, NET::Properties, NET::Properties2) = &KWindowSystem::windowChanged;
+        connect(KWindowSystem::self(), windowChangedSignal, this, &WindowsRunner::windowChanged);
+        connect(KWindowSystem::self(), &KWindowSystem::numberOfDesktopsChanged, this, &WindowsRunner::desktopsChanged);
+        connect(KWindowSystem::self(), &KWindowSystem::desktopNamesChanged, this, &WindowsRunner::desktopsChanged);
+
+        const auto windows = KWindowSystem::windows();
+        for (const WId &w : windows) {
+            m_changedWindows.insert(w);
+        }
+    }
+
+    updateChangedWindows();
+
+    // unlock lock locked in prepareForMatchSession
+    m_mutex.unlock();
+}
+
+// Called in the main thread
+QHash<WId, WindowsRunner::WindowData> WindowsRunner::fetchWindows(const QSet<WId> &windows)
+{
+#if HAVE_X11
+    if (KWindowSystem::isPlatformX11()) {
+        return fetchWindowsX11(windows);
+    }
+#endif
+
+    QHash<WId, WindowData> result;
     for (const WId &w : windows) {
-        KWindowInfo info(w, NET::WMWindowType | NET::WMDesktop |
-                                                        NET::WMState | NET::XAWMState |
-                                                        NET::WMName,
-                                                    NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
-        if (info.valid()) {
-            // ignore NET::Tool and other special window types
-            NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                                                    NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                                                    NET::OverrideMask | NET::TopMenuMask |
-                                                    NET::UtilityMask | NET::SplashMask);
-
-            if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
-                wType != NET::Dialog && wType != NET::Utility) {
-                continue;
+        // only what matching needs, the state is fetched again in run()
+        KWindowInfo info(w, NET::WMWindowType | NET::WMDesktop | NET::WMName,
+                         NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
+        if (!info.valid() || !isMatchableWindowType(info.windowType(s_windowTypeMask))) {
+            continue;
+        }
+
+        WindowData data;
+        data.win = w;
+        data.name = info.name();
+        data.windowClassName = info.windowClassName();
+        data.windowClassClass = info.windowClassClass();
+        data.windowRole = info.windowRole();
+        data.desktop = info.desktop();
+        for (NET::Action action : {NET::ActionClose, NET::ActionMinimize, NET::ActionMaxVert, NET::ActionMaxHoriz,
+                                   NET::ActionShade, NET::ActionFullScreen}) {
+            if (info.actionSupported(action)) {
+                data.allowedActions |= action;
             }
-            m_windows.insert(w, info);
-            m_icons.insert(w, QIcon(KWindowSystem::icon(w)));
         }
+        result.insert(w, data);
+    }
+    return result;
+}
+
+#if HAVE_X11
+namespace {
+
+enum AtomIndex {
+    NetWmWindowType,
+    NetWmDesktop,
+    NetWmName,
+    Utf8String,
+    NetWmAllowedActions,
+    WmWindowRole,
+    // window types, in the order of s_windowTypes
+    TypeNormal,
+    TypeDesktop,
+    TypeDock,
+    TypeToolbar,
+    TypeMenu,
+    TypeDialog,
+    TypeOverride,
+    TypeTopMenu,
+    TypeUtility,
+    TypeSplash,
+    // actions, in the order of s_actions
+    ActionClose,
+    ActionMinimize,
+    ActionMaxVert,
+    ActionMaxHoriz,
+    ActionShade,
+    ActionFullScreen,
+    AtomCount
+};
+
+static const char *const s_atomNames[AtomCount] = {
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_DESKTOP",
+    "_NET_WM_NAME",
+    "UTF8_STRING",
+    "_NET_WM_ALLOWED_ACTIONS",
+    "WM_WINDOW_ROLE",
+    "_NET_WM_WINDOW_TYPE_NORMAL",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_DIALOG",
+    "_KDE_NET_WM_WINDOW_TYPE_OVERRIDE",
+    "_KDE_NET_WM_WINDOW_TYPE_TOPMENU",
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_NET_WM_ACTION_CLOSE",
+    "_NET_WM_ACTION_MINIMIZE",
+    "_NET_WM_ACTION_MAXIMIZE_VERT",
+    "_NET_WM_ACTION_MAXIMIZE_HORZ",
+    "_NET_WM_ACTION_SHADE",
+    "_NET_WM_ACTION_FULLSCREEN",
+};
+
+static const NET::WindowType s_windowTypes[] = {
+    NET::Normal, NET::Desktop, NET::Dock, NET::Toolbar, NET::Menu,
+    NET::Dialog, NET::Override, NET::TopMenu, NET::Utility, NET::Splash
+};
+
+static const NET::Action s_actions[] = {
+    NET::ActionClose, NET::ActionMinimize, NET::ActionMaxVert, NET::ActionMaxHoriz,
+    NET::ActionShade, NET::ActionFullScreen
+};
+
+// interned once for the process, the X server keeps them forever
+static const xcb_atom_t *atoms()
+{
+    static xcb_atom_t atoms[AtomCount] = {XCB_ATOM_NONE};
+    static bool interned = false;
+    if (interned) {
+        return atoms;
     }
 
-    for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
-        m_desktopNames << KWindowSystem::desktopName(i);
+    xcb_connection_t *c = QX11Info::connection();
+    xcb_intern_atom_cookie_t cookies[AtomCount];
+    for (int i = 0; i < AtomCount; ++i) {
+        cookies[i] = xcb_intern_atom(c, false, strlen(s_atomNames[i]), s_atomNames[i]);
+    }
+    for (int i = 0; i < AtomCount; ++i) {
+        if (xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(c, cookies[i], nullptr)) {
+            atoms[i] = reply->atom;
+            free(reply);
+        }
     }
+    interned = true;
+    return atoms;
+}
 
-    // unlock lock locked in prepareForMatchSession
-    m_mutex.unlock();
+struct PropertyCookies {
+    xcb_get_property_cookie_t type;
+    xcb_get_property_cookie_t desktop;
+    xcb_get_property_cookie_t netName;
+    xcb_get_property_cookie_t name;
+    xcb_get_property_cookie_t windowClass;
+    xcb_get_property_cookie_t role;
+    xcb_get_property_cookie_t allowedActions;
+};
+
+// the reply of a property request, freed when going out of scope
+class PropertyReply
+{
+public:
+    PropertyReply(xcb_connection_t *c, xcb_get_property_cookie_t cookie)
+        : m_reply(xcb_get_property_reply(c, cookie, &m_error))
+    {
+    }
+
+    ~PropertyReply()
+    {
+        free(m_reply);
+        free(m_error);
+    }
+
+    bool windowExists() const
+    {
+        return !m_error || m_error->error_code != XCB_WINDOW;
+    }
+
+    QByteArray bytes(xcb_atom_t type) const
+    {
+        if (!m_reply || m_reply->type != type || m_reply->format != 8) {
+            return QByteArray();
+        }
+        return QByteArray(static_cast<const char *>(xcb_get_property_value(m_reply)),
+                          xcb_get_property_value_length(m_reply));
+    }
+
+    QVector<quint32> values(xcb_atom_t type) const
+    {
+        QVector<quint32> result;
+        if (!m_reply || m_reply->type != type || m_reply->format != 32) {
+            return result;
+        }
+        const quint32 *data = static_cast<const quint32 *>(xcb_get_property_value(m_reply));
+        result.reserve(m_reply->value_len);
+        for (uint i = 0; i < m_reply->value_len; ++i) {
+            result << data[i];
+        }
+        return result;
+    }
+
+private:
+    Q_DISABLE_COPY(PropertyReply)
+
+    xcb_generic_error_t *m_error = nullptr;
+    xcb_get_property_reply_t *m_reply;
+};
+
+}
+
+// Called in the main thread
+QHash<WId, WindowsRunner::WindowData> WindowsRunner::fetchWindowsX11(const QSet<WId> &windows)
+{
+    xcb_connection_t *c = QX11Info::connection();
+    const xcb_atom_t *atom = atoms();
+
+    // all requests go out before the first reply is waited for, so the
+    // whole batch costs a single round trip instead of one per window
+    QVector<QPair<WId, PropertyCookies>> requests;
+    requests.reserve(windows.count());
+    for (const WId &w : windows) {
+        PropertyCookies cookies;
+        cookies.type = xcb_get_property(c, false, w, atom[NetWmWindowType], XCB_ATOM_ATOM, 0, 32);
+        cookies.desktop = xcb_get_property(c, false, w, atom[NetWmDesktop], XCB_ATOM_CARDINAL, 0, 1);
+        cookies.netName = xcb_get_property(c, false, w, atom[NetWmName], atom[Utf8String], 0, 2048);
+        cookies.name = xcb_get_property(c, false, w, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 0, 2048);
+        cookies.windowClass = xcb_get_property(c, false, w, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 2048);
+        cookies.role = xcb_get_property(c, false, w, atom[WmWindowRole], XCB_ATOM_STRING, 0, 2048);
+        cookies.allowedActions = xcb_get_property(c, false, w, atom[NetWmAllowedActions], XCB_ATOM_ATOM, 0, 32);
+        requests << qMakePair(w, cookies);
+    }
+
+    const bool allowedActionsSupported = KWindowSystem::allowedActionsSupported();
+
+    QHash<WId, WindowData> result;
+    for (const auto &request : qAsConst(requests)) {
+        const PropertyCookies &cookies = request.second;
+        // every reply has to be read, even for windows which are skipped
+        const PropertyReply type(c, cookies.type);
+        const PropertyReply desktop(c, cookies.desktop);
+        const PropertyReply netName(c, cookies.netName);
+        const PropertyReply name(c, cookies.name);
+        const PropertyReply windowClass(c, cookies.windowClass);
+        const PropertyReply role(c, cookies.role);
+        const PropertyReply allowedActions(c, cookies.allowedActions);
+
+        if (!type.windowExists()) {
+            continue;
+        }
+
+        // the first type out of s_windowTypeMask wins, like KWindowInfo::windowType()
+        NET::WindowType windowType = NET::Unknown;
+        const QVector<quint32> types = type.values(XCB_ATOM_ATOM);
+        for (quint32 typeAtom : types) {
+            const xcb_atom_t *known = std::find(atom + TypeNormal, atom + TypeSplash + 1, typeAtom);
+            if (known != atom + TypeSplash + 1) {
+                windowType = s_windowTypes[known - (atom + TypeNormal)];
+                break;
+            }
+        }
+        if (!isMatchableWindowType(windowType)) {
+            continue;
+        }
+
+        WindowData data;
+        data.win = request.first;
+
+        data.name = QString::fromUtf8(netName.bytes(atom[Utf8String]));
+        if (data.name.isEmpty()) {
+            data.name = QString::fromLocal8Bit(name.bytes(XCB_ATOM_STRING));
+        }
+
+        // WM_CLASS holds the instance and the class name, each null terminated
+        const QList<QByteArray> classNames = windowClass.bytes(XCB_ATOM_STRING).split('\0');
+        data.windowClassName = classNames.value(0);
+        data.windowClassClass = classNames.value(1);
+        data.windowRole = role.bytes(XCB_ATOM_STRING);
+        data.windowRole.truncate(qstrnlen(data.windowRole.constData(), data.windowRole.size()));
+
+        const QVector<quint32> desktops = desktop.values(XCB_ATOM_CARDINAL);
+        if (!desktops.isEmpty()) {
+            data.desktop = desktops.first() == 0xFFFFFFFF ? int(NET::OnAllDesktops) : int(desktops.first()) + 1;
+        }
+
+        if (allowedActionsSupported) {
+            const QVector<quint32> actions = allowedActions.values(XCB_ATOM_ATOM);
+            for (int i = ActionClose; i <= ActionFullScreen; ++i) {
+                if (actions.contains(atom[i])) {
+                    data.allowedActions |= s_actions[i - ActionClose];
+                }
+            }
+        } else {
+            // like KWindowInfo::actionSupported() without window manager support
+            for (NET::Action action : s_actions) {
+                data.allowedActions |= action;
+            }
+        }
+
+        result.insert(data.win, data);
+    }
+    return result;
+}
+#endif
+
+// Called in the main thread with m_mutex locked
+void WindowsRunner::updateChangedWindows()
+{
+    const QHash<WId, WindowData> windows = fetchWindows(m_changedWindows);
+    for (const WId &w : qAsConst(m_changedWindows)) {
+        auto it = windows.constFind(w);
+        if (it == windows.constEnd()) {
+            m_windows.remove(w);
+            m_icons.remove(w);
+        } else {
+            m_windows.insert(w, *it);
+        }
+    }
+    m_changedWindows.clear();
+
+    // fetched again by the next match showing them
+    for (const WId &w : qAsConst(m_changedIcons)) {
+        m_icons.remove(w);
+    }
+    m_changedIcons.clear();
+
+    if (m_desktopsChanged) {
+        m_desktopsChanged = false;
+        m_desktopNames.clear();
+        for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
+            m_desktopNames << KWindowSystem::desktopName(i);
+        }
+    }
+}
+
+// Called in the main thread
+void WindowsRunner::invalidate(WId w)
+{
+    m_changedWindows.insert(w);
+    m_changedIcons.insert(w);
+    // outside of a session the changes are picked up by the next gatherInfo
+    if (m_inSession && !m_gathering) {
+        QMutexLocker locker(&m_mutex);
+        updateChangedWindows();
+    }
+}
+
+// Called in the main thread
+void WindowsRunner::windowAdded(WId w)
+{
+    invalidate(w);
+}
+
+// Called in the main thread
+void WindowsRunner::windowRemoved(WId w)
+{
+    // there is nothing left to fetch about a destroyed window
+    m_changedWindows.remove(w);
+    m_changedIcons.remove(w);
+    if (m_gathering) {
+        // gatherInfo holds the lock already
+        m_windows.remove(w);
+        m_icons.remove(w);
+    } else {
+        QMutexLocker locker(&m_mutex);
+        m_windows.remove(w);
+        m_icons.remove(w);
+    }
+}
+
+// Called in the main thread
+void WindowsRunner::windowChanged(WId w, NET::Properties properties, NET::Properties2 properties2)
+{
+    if (properties & NET::WMIcon) {
+        m_changedIcons.insert(w);
+    }
+    if ((properties & (NET::WMWindowType | NET::WMDesktop | NET::WMName)) ||
+        (properties2 & (NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions))) {
+        invalidate(w);
+    } else if (m_inSession && !m_gathering && !m_changedIcons.isEmpty()) {
+        QMutexLocker locker(&m_mutex);
+        updateChangedWindows();
+    }
+}
+
+// Called in the main thread
+void WindowsRunner::desktopsChanged()
+{
+    m_desktopsChanged = true;
+    if (m_inSession && !m_gathering) {
+        QMutexLocker locker(&m_mutex);
+        updateChangedWindows();
+    }
 }
 
 // Called in the main thread
 void WindowsRunner::prepareForMatchSession()
 {
+    if (m_gathering) {
+        // the previous session was torn down before gatherInfo ran
+        m_inSession = true;
+        return;
+    }
+
     // gatherInfo will unlock the lock
     m_mutex.lock();
     m_inSession = true;
+    m_gathering = true;
     QTimer::singleShot(0, this, &WindowsRunner::gatherInfo);
 }
 
 // Called in the main thread
 void WindowsRunner::matchSessionComplete()
 {
-    QMutexLocker locker(&m_mutex);
+    // the window information stays cached for the next session
     m_inSession = false;
-    m_desktopNames.clear();
-    m_icons.clear();
-    m_windows.clear();
+}
+
+// Called in the secondary thread with m_mutex locked
+QIcon WindowsRunner::windowIcon(WId w)
+{
+    auto it = m_icons.constFind(w);
+    if (it == m_icons.constEnd()) {
+        // only a handle, the icon is fetched when the match gets painted
+        it = m_icons.insert(w, QIcon(new WindowIconEngine(w)));
+    }
+    return *it;
 }
 
 // Called in the secondary thread
@@ -200,24 +662,24 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
                 }
             }
         }
-        QHashIterator<WId, KWindowInfo> it(m_windows);
+        QHashIterator<WId, WindowData> it(m_windows);
         while(it.hasNext()) {
             it.next();
             WId w = it.key();
-            KWindowInfo info = it.value();
-            QString windowClassCompare = QString::fromUtf8(info.windowClassName()) + QLatin1Char(' ') +
-                                         QString::fromUtf8(info.windowClassClass());
+            const WindowData &info = it.value();
+            QString windowClassCompare = QString::fromUtf8(info.windowClassName) + QLatin1Char(' ') +
+                                         QString::fromUtf8(info.windowClassClass);
             // exclude not matching windows
             if (!KWindowSystem::hasWId(w)) {
                 continue;
             }
-            if (!windowName.isEmpty() && !info.name().startsWith(windowName, Qt::CaseInsensitive)) {
+            if (!windowName.isEmpty() && !info.name.startsWith(windowName, Qt::CaseInsensitive)) {
                 continue;
             }
             if (!windowClass.isEmpty() && !windowClassCompare.contains(windowClass, Qt::CaseInsensitive)) {
                 continue;
             }
-            if (!windowRole.isEmpty() && !QString::fromUtf8(info.windowRole()).contains(windowRole, Qt::CaseInsensitive)) {
+            if (!windowRole.isEmpty() && !QString::fromUtf8(info.windowRole).contains(windowRole, Qt::CaseInsensitive)) {
                 continue;
             }
             if (desktop != -1 && !info.isOnDesktop(desktop)) {
@@ -227,9 +689,9 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             // check the name, class and role for containing the query without the keyword
             if (windowName.isEmpty() && windowClass.isEmpty() && windowRole.isEmpty() && desktop == -1) {
                 const QString& test = term.mid(keywords[0].length() + 1);
-                if (!info.name().contains(test, Qt::CaseInsensitive) &&
+                if (!info.name.contains(test, Qt::CaseInsensitive) &&
                     !windowClassCompare.contains(test, Qt::CaseInsensitive) &&
-                    !QString::fromUtf8(info.windowRole()).contains(test, Qt::CaseInsensitive)) {
+                    !QString::fromUtf8(info.windowRole).contains(test, Qt::CaseInsensitive)) {
                     continue;
                 }
             }
@@ -271,7 +733,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
     }
 
     // check for matches without keywords
-    QHashIterator<WId, KWindowInfo> it(m_windows);
+    QHashIterator<WId, WindowData> it(m_windows);
     while (it.hasNext()) {
         it.next();
         WId w = it.key();
@@ -279,12 +741,12 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             continue;
         }
         // check if window name, class or role contains the query
-        KWindowInfo info = it.value();
-        QString className = QString::fromUtf8(info.windowClassName());
-        if (info.name().startsWith(term, Qt::CaseInsensitive) ||
+        const WindowData &info = it.value();
+        QString className = QString::fromUtf8(info.windowClassName);
+        if (info.name.startsWith(term, Qt::CaseInsensitive) ||
             className.startsWith(term, Qt::CaseInsensitive)) {
             matches << windowMatch(info, action, 0.8, Plasma::QueryMatch::ExactMatch);
-        } else if ((info.name().contains(term, Qt::CaseInsensitive) ||
+        } else if ((info.name.contains(term, Qt::CaseInsensitive) ||
              className.contains(term, Qt::CaseInsensitive)) && 
             actionSupported(info, action)) {
             matches << windowMatch(info, action, 0.7, Plasma::QueryMatch::PossibleMatch);
@@ -302,10 +764,10 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             }
 
             // search for windows on desktop and list them with less relevance
-            QHashIterator<WId, KWindowInfo> it(m_windows);
+            QHashIterator<WId, WindowData> it(m_windows);
             while (it.hasNext()) {
                 it.next();
-                KWindowInfo info = it.value();
+                const WindowData &info = it.value();
                 if (info.isOnDesktop(desktop) && actionSupported(info, action)) {
                     matches << windowMatch(info, action, 0.5, Plasma::QueryMatch::PossibleMatch);
                 }
@@ -413,15 +875,15 @@ Plasma::QueryMatch WindowsRunner::desktopMatch(int desktop, qreal relevance)
     return match;
 }
 
-Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance, Plasma::QueryMatch::Type type)
+Plasma::QueryMatch WindowsRunner::windowMatch(const WindowData& info, WindowAction action, qreal relevance, Plasma::QueryMatch::Type type)
 {
     Plasma::QueryMatch match(this);
     match.setType(type);
-    match.setData(QString(QString::number((int)action) + QLatin1Char('_') + QString::number(info.win())));
-    match.setIcon(m_icons[info.win()]);
-    match.setText(info.name());
+    match.setData(QString(QString::number((int)action) + QLatin1Char('_') + QString::number(info.win)));
+    match.setIcon(windowIcon(info.win));
+    match.setText(info.name);
     QString desktopName;
-    int desktop = info.desktop();
+    int desktop = info.desktop;
     if (desktop == NET::OnAllDesktops) {
         desktop = KWindowSystem::currentDesktop();
     }
@@ -461,7 +923,7 @@ Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAct
     return match;
 }
 
-bool WindowsRunner::actionSupported(const KWindowInfo& info, WindowAction action)
+bool WindowsRunner::actionSupported(const WindowData& info, WindowAction action)
 {
     switch (action) {
     case CloseAction:
@@ -21,9 +21,13 @@
 
 #include <KRunner/AbstractRunner>
 
+#include <QIcon>
 #include <QMutex>
+#include <QSet>
 
-class KWindowInfo;
+#include <netwm_def.h>
+
+#include "config-windowsrunner.h"
 
 class WindowsRunner : public Plasma::AbstractRunner
 {
@@ -40,6 +44,10 @@ class WindowsRunner : public Plasma::AbstractRunner
         void prepareForMatchSession();
         void matchSessionComplete();
         void gatherInfo();
+        void windowAdded(WId w);
+        void windowRemoved(WId w);
+        void windowChanged(WId w, NET::Properties properties, NET::Properties2 properties2);
+        void desktopsChanged();
 
     private:
         enum WindowAction {
@@ -52,17 +60,45 @@ class WindowsRunner : public Plasma::AbstractRunner
             KeepAboveAction,
             KeepBelowAction
         };
+        // what matching needs to know about a window
+        struct WindowData {
+            WId win = 0;
+            QString name;
+            QByteArray windowClassName;
+            QByteArray windowClassClass;
+            QByteArray windowRole;
+            int desktop = 0;
+            NET::Actions allowedActions;
+
+            bool isOnDesktop(int desktop) const;
+            bool actionSupported(NET::Action action) const;
+        };
+
         Plasma::QueryMatch desktopMatch(int desktop, qreal relevance = 1.0);
-        Plasma::QueryMatch windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance = 1.0,
+        Plasma::QueryMatch windowMatch(const WindowData& info, WindowAction action, qreal relevance = 1.0,
                                        Plasma::QueryMatch::Type type = Plasma::QueryMatch::ExactMatch);
-        bool actionSupported(const KWindowInfo& info, WindowAction action);
+        bool actionSupported(const WindowData& info, WindowAction action);
+        QIcon windowIcon(WId w);
+        void invalidate(WId w);
+        void updateChangedWindows();
+        static QHash<WId, WindowData> fetchWindows(const QSet<WId> &windows);
+#if HAVE_X11
+        static QHash<WId, WindowData> fetchWindowsX11(const QSet<WId> &windows);
+#endif
 
-        QHash<WId, KWindowInfo> m_windows; // protected by m_mutex
-        QHash<WId, QIcon> m_icons; // protected by m_mutex
+        QHash<WId, WindowData> m_windows; // protected by m_mutex
+        QHash<WId, QIcon> m_icons; // protected by m_mutex, filled by match()
         QStringList m_desktopNames; // protected by m_mutex
         QMutex m_mutex;
 
+        // windows whose information has to be refetched, only used in the main thread
+        QSet<WId> m_changedWindows;
+        QSet<WId> m_changedIcons;
+
         bool m_inSession : 1; // only used in the main thread
+        bool m_gathering : 1; // only used in the main thread
+        bool m_tracking : 1; // only used in the main thread
+        bool m_desktopsChanged : 1; // only used in the main thread
 };
 
 #endif // WINDOWSRUNNER_H
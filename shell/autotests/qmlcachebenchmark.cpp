@@ -0,0 +1,168 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QScopedPointer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KPluginFactory>
+#include <KPluginLoader>
+
+#include "../qmlcachewarmer.h"
+
+// The applets of this repository a default panel holds, relative to its root
+static const char *const s_referencePanel[] = {
+    "applets/appmenu/package",
+    "applets/panelspacer/package",
+    "applets/icon/package",
+    "applets/notifications/package",
+    "applets/devicenotifier/package",
+    "applets/batterymonitor/package",
+    "applets/systemtray/package",
+    "applets/digital-clock/package",
+};
+
+class QmlCacheBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkPanelLoad_data();
+    void benchmarkPanelLoad();
+
+private:
+    QStringList copyPanel(const QString &name);
+    QString loadPanel(const QStringList &mainScripts);
+
+    QTemporaryDir m_dir;
+    QString m_sourceDir;
+    QScopedPointer<QObject> m_scriptEngine;
+};
+
+static bool copyDirectory(const QString &source, const QString &target)
+{
+    QDirIterator it(source, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString file = it.next();
+        const QString copy = target + file.mid(source.length());
+        if (!QDir().mkpath(QFileInfo(copy).absolutePath()) || !QFile::copy(file, copy)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void QmlCacheBenchmark::initTestCase()
+{
+    if (qEnvironmentVariableIsSet("QML_DISABLE_DISK_CACHE")) {
+        QSKIP("The QML disk cache is disabled");
+    }
+
+    // keeps the compiled files away from the real cache
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+
+    m_sourceDir = QFINDTESTDATA("../../applets");
+    QVERIFY(!m_sourceDir.isEmpty());
+    m_sourceDir = QDir::cleanPath(m_sourceDir + QStringLiteral("/.."));
+
+    // registers the org.kde.plasma.plasmoid types, like loading the first applet does in the shell
+    KPluginLoader loader(QStringLiteral("plasma/scriptengines/plasma_appletscript_declarative"));
+    KPluginFactory *factory = loader.factory();
+    if (!factory) {
+        QSKIP("The Plasma QML applet script engine is not installed");
+    }
+    m_scriptEngine.reset(factory->create<QObject>());
+}
+
+QStringList QmlCacheBenchmark::copyPanel(const QString &name)
+{
+    // new paths, which the disk cache knows nothing about yet
+    QStringList mainScripts;
+    for (const char *package : s_referencePanel) {
+        const QString source = m_sourceDir + QLatin1Char('/') + QLatin1String(package);
+        const QString target = m_dir.path() + QLatin1Char('/') + name + QLatin1Char('/') + QLatin1String(package);
+        if (!copyDirectory(source, target)) {
+            return QStringList();
+        }
+        mainScripts << target + QStringLiteral("/contents/ui/main.qml");
+    }
+    return mainScripts;
+}
+
+QString QmlCacheBenchmark::loadPanel(const QStringList &mainScripts)
+{
+    // a fresh engine, so nothing comes from its in-memory type cache
+    QQmlEngine engine;
+    for (const QString &mainScript : mainScripts) {
+        // compiled with everything it pulls in from its package, like the shell
+        // does before creating the applet in its context
+        QQmlComponent component(&engine, QUrl::fromLocalFile(mainScript));
+        if (!component.isReady()) {
+            return component.errorString();
+        }
+    }
+    return QString();
+}
+
+void QmlCacheBenchmark::benchmarkPanelLoad_data()
+{
+    QTest::addColumn<bool>("warm");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("warm") << true;
+}
+
+void QmlCacheBenchmark::benchmarkPanelLoad()
+{
+    QFETCH(bool, warm);
+
+    const QStringList mainScripts = copyPanel(QString::fromLatin1(QTest::currentDataTag()));
+    QVERIFY(!mainScripts.isEmpty());
+
+    if (warm) {
+        QmlCacheWarmer warmer;
+        QSignalSpy finishedSpy(&warmer, &QmlCacheWarmer::finished);
+        warmer.warmFiles(mainScripts);
+        QVERIFY(finishedSpy.count() || finishedSpy.wait(60000));
+    }
+
+    // only the first load tells cold from warm, later ones hit the cache either way
+    QString error;
+    QBENCHMARK_ONCE {
+        error = loadPanel(mainScripts);
+    }
+    if (!error.isEmpty()) {
+        QSKIP(qPrintable(QStringLiteral("The reference panel needs the Plasma QML modules installed: ") + error));
+    }
+}
+
+QTEST_MAIN(QmlCacheBenchmark)
+
+#include "qmlcachebenchmark.moc"
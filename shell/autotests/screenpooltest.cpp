@@ -21,13 +21,51 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 
 #include <QDir>
+#include <QSignalSpy>
 #include <QStandardPaths>
 #include <QTemporaryDir>
 #include <QTest>
 #include <QScreen>
 
+#include "../screenindex.h"
 #include "../screenpool.h"
 
+// ScreenIndex only asks the views for their containment and screen,
+// stand-ins do for them
+namespace Plasma
+{
+    class Containment
+    {
+    };
+} // namespace Plasma
+
+struct DesktopView
+{
+    Plasma::Containment *containment() const
+    {
+        return m_containment;
+    }
+
+    Plasma::Containment *m_containment;
+};
+
+class PanelView
+{
+public:
+    explicit PanelView(QScreen *screen)
+        : m_screen(screen)
+    {
+    }
+
+    QScreen *screenToFollow() const
+    {
+        return m_screen;
+    }
+
+private:
+    QScreen *m_screen;
+};
+
 class ScreenPoolTest : public QObject
 {
 Q_OBJECT
@@ -38,6 +76,7 @@ private Q_SLOTS:
 
     void testScreenInsertion();
     void testPrimarySwap();
+    void testHotplugStress();
 
 private:
     ScreenPool *m_screenPool;
@@ -97,6 +136,83 @@ void ScreenPoolTest::testPrimarySwap()
     QCOMPARE(m_screenPool->id(oldPrimary), oldIdOfFake1);
 }
 
+void ScreenPoolTest::testHotplugStress()
+{
+    // a laptop going in and out of a dock with two external outputs,
+    // the external ones becoming primary while docked
+    QScreen *laptopScreen = QGuiApplication::primaryScreen();
+    const QString laptop = laptopScreen->name();
+    const QStringList docked = {QStringLiteral("HOTPLUG-0"), QStringLiteral("HOTPLUG-1")};
+    m_screenPool->setPrimaryConnector(laptop);
+    const int knownIdsCount = m_screenPool->knownIds().count();
+
+    ScreenIndex screenIndex;
+    screenIndex.setScreenPool(m_screenPool);
+
+    Plasma::Containment laptopDesktop;
+    Plasma::Containment dockedDesktops[2];
+    DesktopView laptopView{&laptopDesktop};
+    DesktopView dockedViews[2] = {{&dockedDesktops[0]}, {&dockedDesktops[1]}};
+    PanelView laptopPanel{laptopScreen};
+    // like ShellCorona::m_desktopViewforId and m_panelViews
+    QMap<int, DesktopView *> desktopViews;
+    QList<PanelView *> panelViews;
+    desktopViews.insert(0, &laptopView);
+    panelViews << &laptopPanel;
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 1000; ++i) {
+            const int dockedIndex = i % docked.count();
+            const QString &output = docked.at(dockedIndex);
+            Plasma::Containment *dockedDesktop = &dockedDesktops[dockedIndex];
+
+            // docking, like ShellCorona::addOutput()
+            if (m_screenPool->id(output) < 0) {
+                m_screenPool->insertScreenMapping(m_screenPool->firstAvailableId(), output);
+            }
+            screenIndex.update(desktopViews, panelViews);
+            m_screenPool->setPrimaryConnector(output);
+            QVERIFY(!screenIndex.isValid());
+            desktopViews.remove(m_screenPool->id(output));
+            desktopViews.insert(m_screenPool->id(laptop), &laptopView);
+            desktopViews.insert(0, &dockedViews[dockedIndex]);
+            screenIndex.invalidate();
+
+            screenIndex.update(desktopViews, panelViews);
+            QCOMPARE(screenIndex.screenForDesktop(dockedDesktop), 0);
+            QCOMPARE(screenIndex.screenForDesktop(&laptopDesktop), m_screenPool->id(laptop));
+            QCOMPARE(screenIndex.screen(m_screenPool->id(laptop)), laptopScreen);
+            // the docked outputs are not real screens
+            QVERIFY(!screenIndex.screen(0));
+            QCOMPARE(screenIndex.panelsForScreen(laptopScreen), QList<PanelView *>{&laptopPanel});
+
+            // undocking, like ShellCorona::removeDesktop(), the view goes before the mapping changes
+            desktopViews.remove(0);
+            screenIndex.invalidate();
+            screenIndex.update(desktopViews, panelViews);
+            QCOMPARE(screenIndex.screenForDesktop(dockedDesktop), -1);
+
+            m_screenPool->setPrimaryConnector(laptop);
+            QVERIFY(!screenIndex.isValid());
+            desktopViews.remove(m_screenPool->id(output));
+            desktopViews.insert(0, &laptopView);
+            screenIndex.invalidate();
+
+            screenIndex.update(desktopViews, panelViews);
+            QCOMPARE(screenIndex.screenForDesktop(&laptopDesktop), 0);
+            QCOMPARE(screenIndex.screen(0), laptopScreen);
+            QVERIFY(!screenIndex.screen(m_screenPool->id(output)));
+            QCOMPARE(screenIndex.panelsForScreen(laptopScreen), QList<PanelView *>{&laptopPanel});
+        }
+    }
+
+    // outputs coming back get their old ids, nothing piles up
+    QCOMPARE(m_screenPool->knownIds().count(), knownIdsCount + docked.count());
+    QVERIFY(m_screenPool->id(docked.at(0)) > 0);
+    QVERIFY(m_screenPool->id(docked.at(1)) > 0);
+    QCOMPARE(desktopViews.count(), 1);
+}
+
 QTEST_MAIN(ScreenPoolTest)
 
 #include "screenpooltest.moc"
@@ -110,6 +110,11 @@ PanelView::PanelView(ShellCorona *corona, QScreen *targetScreen, QWindow *parent
     connect(&m_strutsTimer, &QTimer::timeout,
             this, &PanelView::updateStruts);
 
+    m_configWriteTimer.setSingleShot(true);
+    m_configWriteTimer.setInterval(CONFIGWRITEDELAY);
+    connect(&m_configWriteTimer, &QTimer::timeout,
+            this, &PanelView::writePendingConfig);
+
     qmlRegisterType<QScreen>();
     rootContext()->setContextProperty(QStringLiteral("panel"), this);
     setSource(m_corona->kPackage().fileUrl("views", QStringLiteral("Panel.qml")));
@@ -118,6 +123,7 @@ PanelView::PanelView(ShellCorona *corona, QScreen *targetScreen, QWindow *parent
 PanelView::~PanelView()
 {
     if (containment()) {
+        writePendingConfig();
         m_corona->requestApplicationConfigSync();
     }
 }
@@ -156,6 +162,40 @@ int PanelView::readConfigValueWithFallBack(const QString &key, int defaultValue)
     return value;
 }
 
+void PanelView::scheduleConfigWrite(const QString &key, int value)
+{
+    //while dragging a panel edge this is called for every pixel,
+    //only the last value of each entry ends up in the config
+    if (m_pendingConfig.isEmpty()) {
+        //the groups depend on screen size and form factor, keep the ones the values were set for
+        m_pendingConfigGroup = config();
+        m_pendingConfigDefaults = configDefaults();
+    }
+    m_pendingConfig[key] = value;
+    m_configWriteTimer.start();
+}
+
+void PanelView::writePendingConfig()
+{
+    m_configWriteTimer.stop();
+
+    if (m_pendingConfig.isEmpty()) {
+        return;
+    }
+
+    if (m_pendingConfigGroup.isValid()) {
+        for (auto it = m_pendingConfig.constBegin(); it != m_pendingConfig.constEnd(); ++it) {
+            m_pendingConfigGroup.writeEntry(it.key(), it.value());
+            m_pendingConfigDefaults.writeEntry(it.key(), it.value());
+        }
+        m_corona->requestApplicationConfigSync();
+    }
+
+    m_pendingConfig.clear();
+    m_pendingConfigGroup = KConfigGroup();
+    m_pendingConfigDefaults = KConfigGroup();
+}
+
 KConfigGroup PanelView::config() const
 {
     return panelConfig(m_corona, containment(), m_screenToFollow);
@@ -224,12 +264,9 @@ void PanelView::setOffset(int offset)
     }
 
     m_offset = offset;
-    config().writeEntry("offset", m_offset);
-    configDefaults().writeEntry("offset", m_offset);
+    scheduleConfigWrite(QStringLiteral("offset"), m_offset);
     positionPanel();
     emit offsetChanged();
-    m_corona->requestApplicationConfigSync();
-    emit m_corona->availableScreenRegionChanged();
 }
 
 int PanelView::thickness() const
@@ -246,9 +283,7 @@ void PanelView::setThickness(int value)
     m_thickness = value;
     emit thicknessChanged();
 
-    config().writeEntry("thickness", value);
-    configDefaults().writeEntry("thickness", value);
-    m_corona->requestApplicationConfigSync();
+    scheduleConfigWrite(QStringLiteral("thickness"), value);
     resizePanel();
 }
 
@@ -283,11 +318,9 @@ void PanelView::setMaximumLength(int length)
         setMinimumLength(length);
     }
 
-    config().writeEntry("maxLength", length);
-    configDefaults().writeEntry("maxLength", length);
+    scheduleConfigWrite(QStringLiteral("maxLength"), length);
     m_maxLength = length;
     emit maximumLengthChanged();
-    m_corona->requestApplicationConfigSync();
 
     resizePanel();
 }
@@ -307,11 +340,9 @@ void PanelView::setMinimumLength(int length)
         setMaximumLength(length);
     }
 
-    config().writeEntry("minLength", length);
-    configDefaults().writeEntry("minLength", length);
+    scheduleConfigWrite(QStringLiteral("minLength"), length);
     m_minLength = length;
     emit minimumLengthChanged();
-    m_corona->requestApplicationConfigSync();
 
     resizePanel();
 }
@@ -566,6 +597,9 @@ void PanelView::restore()
         return;
     }
 
+    //values still waiting to be written are read back below
+    writePendingConfig();
+
     // All the defaults are based on whatever are the current values
     // so won't be weirdly reset after screen resolution change
 
@@ -765,7 +799,7 @@ void PanelView::resizeEvent(QResizeEvent *ev)
         m_shellSurface->setPosition(pos);
     }
     m_strutsTimer.start(STRUTSTIMERDELAY);
-    emit m_corona->availableScreenRegionChanged();
+    m_corona->updateAvailableScreenGeometry();
 
     PlasmaQuick::ContainmentView::resizeEvent(ev);
 
@@ -19,6 +19,7 @@
 #ifndef PANELVIEW_H
 #define PANELVIEW_H
 
+#include <QHash>
 #include <QPointer>
 #include <Plasma/Theme>
 #include <QTimer>
@@ -209,6 +210,8 @@ private Q_SLOTS:
 
 private:
     int readConfigValueWithFallBack(const QString &key, int defaultValue);
+    void scheduleConfigWrite(const QString &key, int value);
+    void writePendingConfig();
     void resizePanel();
     void integrateScreen();
     bool containmentContainsPosition(const QPointF &point) const;
@@ -234,6 +237,11 @@ private:
     Plasma::Theme m_theme;
     QTimer m_positionPaneltimer;
     QTimer m_unhideTimer;
+    //geometry entries changed since they were last written, written out together once the panel settled
+    QHash<QString, int> m_pendingConfig;
+    KConfigGroup m_pendingConfigGroup;
+    KConfigGroup m_pendingConfigDefaults;
+    QTimer m_configWriteTimer;
     Plasma::Types::BackgroundHints m_backgroundHints;
     Plasma::FrameSvg::EnabledBorders m_enabledBorders = Plasma::FrameSvg::AllBorders;
     KWayland::Client::PlasmaShellSurface *m_shellSurface;
@@ -242,6 +250,7 @@ private:
     QMetaObject::Connection m_transientWindowVisibleWatcher;
 
     static const int STRUTSTIMERDELAY = 200;
+    static const int CONFIGWRITEDELAY = 250;
 };
 
 #endif // PANELVIEW_H
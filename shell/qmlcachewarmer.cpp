@@ -0,0 +1,179 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "qmlcachewarmer.h"
+#include "debug.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QStandardPaths>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KPackage/Package>
+#include <KPackage/PackageLoader>
+
+static KConfigGroup warmedPackages(KConfig &config)
+{
+    return KConfigGroup(&config, "Packages");
+}
+
+QmlCacheWarmer::QmlCacheWarmer(QObject *parent)
+    : QObject(parent)
+{
+    m_warmingTimer.setSingleShot(true);
+    connect(&m_warmingTimer, &QTimer::timeout, this, &QmlCacheWarmer::warmPackages);
+}
+
+QmlCacheWarmer::~QmlCacheWarmer()
+{
+}
+
+void QmlCacheWarmer::scheduleWarming(const QStringList &pluginIds, int delay)
+{
+    //the engine would not look at the cache anyway
+    if (qEnvironmentVariableIsSet("QML_DISABLE_DISK_CACHE")) {
+        return;
+    }
+
+    m_pluginIds = pluginIds;
+    m_warmingTimer.start(delay);
+}
+
+void QmlCacheWarmer::warmFiles(const QStringList &files)
+{
+    for (const QString &file : files) {
+        m_jobs << Job{file, QString(), QString()};
+    }
+
+    if (!m_warming) {
+        compileNext();
+    }
+}
+
+bool QmlCacheWarmer::isWarming() const
+{
+    return m_warming;
+}
+
+void QmlCacheWarmer::warmPackages()
+{
+    //still busy with the previous round, the packages it skipped are looked at again afterwards
+    if (isWarming()) {
+        connect(this, &QmlCacheWarmer::finished, this, &QmlCacheWarmer::warmPackages, Qt::UniqueConnection);
+        return;
+    }
+    disconnect(this, &QmlCacheWarmer::finished, this, &QmlCacheWarmer::warmPackages);
+
+    KConfig config(QStringLiteral("plasmashellqmlcacherc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation);
+    const KConfigGroup group = warmedPackages(config);
+
+    KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("Plasma/Applet"));
+    for (const QString &pluginId : qAsConst(m_pluginIds)) {
+        package.setPath(pluginId);
+        if (!package.isValid()) {
+            continue;
+        }
+
+        const QString packagePath = QDir::cleanPath(package.path());
+        const QString mainScript = package.filePath("mainscript");
+        if (mainScript.isEmpty()) {
+            continue;
+        }
+
+        //the main script pulls in the other files of the package, any of them changing means compiling again
+        QDateTime lastModified;
+        QDirIterator it(packagePath + QStringLiteral("/contents"), {QStringLiteral("*.qml"), QStringLiteral("*.js")},
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            lastModified = qMax(lastModified, it.fileInfo().lastModified());
+        }
+
+        const QString cacheKey = QString::number(lastModified.toMSecsSinceEpoch()) + QLatin1Char('@') + QLatin1String(qVersion());
+        if (group.readEntry(packagePath, QString()) != cacheKey) {
+            m_jobs << Job{mainScript, packagePath, cacheKey};
+        }
+    }
+
+    if (m_jobs.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    qCDebug(PLASMASHELL) << "Compiling the QML of" << m_jobs.count() << "changed applet packages";
+    compileNext();
+}
+
+void QmlCacheWarmer::compileNext()
+{
+    if (m_jobs.isEmpty()) {
+        //after the last component, which is deleted later as well
+        if (m_engine) {
+            m_engine->deleteLater();
+            m_engine = nullptr;
+        }
+        m_warming = false;
+        emit finished();
+        return;
+    }
+
+    m_warming = true;
+
+    if (!m_engine) {
+        m_engine = new QQmlEngine(this);
+    }
+
+    m_currentJob = m_jobs.takeFirst();
+
+    //asynchronous components are compiled on the engine's loader thread, which also writes the cache
+    m_component = new QQmlComponent(m_engine, QUrl::fromLocalFile(m_currentJob.file), QQmlComponent::Asynchronous, this);
+    if (m_component->isLoading()) {
+        connect(m_component, &QQmlComponent::statusChanged, this, &QmlCacheWarmer::componentDone);
+    } else {
+        componentDone();
+    }
+}
+
+void QmlCacheWarmer::componentDone()
+{
+    if (m_component->isLoading()) {
+        return;
+    }
+
+    if (m_component->isReady()) {
+        if (!m_currentJob.packagePath.isEmpty()) {
+            KConfig config(QStringLiteral("plasmashellqmlcacherc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation);
+            KConfigGroup group = warmedPackages(config);
+            group.writeEntry(m_currentJob.packagePath, m_currentJob.cacheKey);
+        }
+    } else {
+        qCDebug(PLASMASHELL) << "Could not compile" << m_currentJob.file << m_component->errorString();
+    }
+
+    m_component->deleteLater();
+    m_component = nullptr;
+
+    //one file per event loop pass, the shell stays responsive in between
+    QTimer::singleShot(0, this, &QmlCacheWarmer::compileNext);
+}
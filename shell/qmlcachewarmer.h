@@ -0,0 +1,84 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QMLCACHEWARMER_H
+#define QMLCACHEWARMER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+class QQmlComponent;
+class QQmlEngine;
+
+/**
+ * Compiles the QML of the applet packages the shell uses in the background,
+ * so the QML engine finds them in its disk cache next time they are loaded,
+ * e.g. after they were updated while the shell was running.
+ *
+ * Only the packages it is told about are looked at, never everything that
+ * is installed. A package is compiled again when its path, the
+ * modification time of its QML files or the Qt version changed since it
+ * was last warmed.
+ */
+class QmlCacheWarmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QmlCacheWarmer(QObject *parent = nullptr);
+    ~QmlCacheWarmer() override;
+
+    /**
+     * Looks at the packages of the applets and containments @p pluginIds
+     * after @p delay ms and compiles those that changed
+     */
+    void scheduleWarming(const QStringList &pluginIds, int delay);
+
+    /**
+     * Compiles @p files one after the other without instantiating them
+     */
+    void warmFiles(const QStringList &files);
+
+    bool isWarming() const;
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    struct Job {
+        QString file;
+        QString packagePath;
+        QString cacheKey;
+    };
+
+    void warmPackages();
+    void compileNext();
+    void componentDone();
+
+    QStringList m_pluginIds;
+    QVector<Job> m_jobs;
+    Job m_currentJob;
+    QQmlEngine *m_engine = nullptr;
+    QQmlComponent *m_component = nullptr;
+    bool m_warming = false;
+    QTimer m_warmingTimer;
+};
+
+#endif
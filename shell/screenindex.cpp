@@ -0,0 +1,83 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "screenindex.h"
+#include "screenpool.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+ScreenIndex::~ScreenIndex()
+{
+    QObject::disconnect(m_poolConnection);
+}
+
+void ScreenIndex::setScreenPool(ScreenPool *pool)
+{
+    QObject::disconnect(m_poolConnection);
+    m_pool = pool;
+    m_poolConnection = QObject::connect(pool, &ScreenPool::screenMappingChanged, pool, [this]() {
+        invalidate();
+    });
+    invalidate();
+}
+
+bool ScreenIndex::isValid() const
+{
+    return m_valid;
+}
+
+void ScreenIndex::invalidate()
+{
+    m_valid = false;
+}
+
+void ScreenIndex::reset()
+{
+    Q_ASSERT(m_pool);
+
+    m_screenForDesktop.clear();
+    m_panelsForScreen.clear();
+    m_screenForId.clear();
+
+    const auto screens = qGuiApp->screens();
+    for (QScreen *screen : screens) {
+        const int id = m_pool->id(screen->name());
+        if (id >= 0) {
+            m_screenForId.insert(id, screen);
+        }
+    }
+
+    m_valid = true;
+}
+
+int ScreenIndex::screenForDesktop(const Plasma::Containment *containment) const
+{
+    return m_screenForDesktop.value(containment, -1);
+}
+
+QList<PanelView *> ScreenIndex::panelsForScreen(const QScreen *screen) const
+{
+    return m_panelsForScreen.value(screen);
+}
+
+QScreen *ScreenIndex::screen(int id) const
+{
+    return m_screenForId.value(id);
+}
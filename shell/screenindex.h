@@ -0,0 +1,104 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SCREENINDEX_H
+#define SCREENINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMetaObject>
+
+class PanelView;
+class QScreen;
+class ScreenPool;
+
+namespace Plasma
+{
+    class Containment;
+} // namespace Plasma
+
+/**
+ * Lookups from desktop containments, screens and screen ids to what
+ * ShellCorona shows on them.
+ *
+ * The index only holds pointers and never dereferences the views or
+ * containments, it has to be invalidated whenever one of them is removed and
+ * is rebuilt by update() before the next lookup. Changes of the screen pool
+ * mapping invalidate it on their own.
+ */
+class ScreenIndex
+{
+public:
+    ScreenIndex() = default;
+    ~ScreenIndex();
+
+    /** Maps connected screens to ids with @p pool and follows its changes */
+    void setScreenPool(ScreenPool *pool);
+
+    bool isValid() const;
+    void invalidate();
+
+    /**
+     * Rebuilds an invalidated index from @p desktopViews, a map from screen
+     * id to desktop view, and @p panelViews. Desktop views need a
+     * containment() and panel views a screenToFollow().
+     */
+    template <typename DesktopViews, typename PanelViews>
+    void update(const DesktopViews &desktopViews, const PanelViews &panelViews);
+
+    /** The screen id of the desktop view showing @p containment, or -1 */
+    int screenForDesktop(const Plasma::Containment *containment) const;
+    QList<PanelView *> panelsForScreen(const QScreen *screen) const;
+    /** The connected screen with @p id, or nullptr */
+    QScreen *screen(int id) const;
+
+private:
+    Q_DISABLE_COPY(ScreenIndex)
+
+    void reset();
+
+    ScreenPool *m_pool = nullptr;
+    QMetaObject::Connection m_poolConnection;
+    QHash<const Plasma::Containment *, int> m_screenForDesktop;
+    QHash<const QScreen *, QList<PanelView *>> m_panelsForScreen;
+    QHash<int, QScreen *> m_screenForId;
+    bool m_valid = false;
+};
+
+template <typename DesktopViews, typename PanelViews>
+void ScreenIndex::update(const DesktopViews &desktopViews, const PanelViews &panelViews)
+{
+    if (m_valid) {
+        return;
+    }
+
+    reset();
+
+    for (auto it = desktopViews.constBegin(), end = desktopViews.constEnd(); it != end; ++it) {
+        if (it.value()->containment()) {
+            m_screenForDesktop.insert(it.value()->containment(), it.key());
+        }
+    }
+
+    for (PanelView *v : panelViews) {
+        m_panelsForScreen[v->screenToFollow()] << v;
+    }
+}
+
+#endif // SCREENINDEX_H
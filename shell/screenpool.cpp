@@ -89,6 +89,8 @@ void ScreenPool::load()
             insertScreenMapping(firstAvailableId(), screen->name());
         }
     }
+
+    emit screenMappingChanged();
 }
 
 ScreenPool::~ScreenPool()
@@ -124,6 +126,7 @@ void ScreenPool::setPrimaryConnector(const QString &primary)
     m_connectorForId[oldIdForPrimary] = m_primaryConnector;
     m_primaryConnector = primary;
     save();
+    emit screenMappingChanged();
 }
 
 void ScreenPool::save()
@@ -132,8 +135,10 @@ void ScreenPool::save()
     for (i = m_connectorForId.constBegin(); i != m_connectorForId.constEnd(); ++i) {
         m_configGroup.writeEntry(QString::number(i.key()), i.value());
     }
-    //write to disck every 30 seconds at most
-    m_configSaveTimer.start(30000);
+    //write to disck every 30 seconds at most, a burst of changes doesn't postpone it further
+    if (!m_configSaveTimer.isActive()) {
+        m_configSaveTimer.start(30000);
+    }
 }
 
 void ScreenPool::insertScreenMapping(int id, const QString &connector)
@@ -148,6 +153,7 @@ void ScreenPool::insertScreenMapping(int id, const QString &connector)
     m_connectorForId[id] = connector;
     m_idForConnector[connector] = id;
     save();
+    emit screenMappingChanged();
 }
 
 int ScreenPool::id(const QString &connector) const
@@ -52,6 +52,12 @@ public:
     //all ids that are known, included screens not enabled at the moment
     QList <int> knownIds() const;
 
+Q_SIGNALS:
+    /**
+     * Emitted whenever a screen id got a different connector
+     */
+    void screenMappingChanged();
+
 protected:
     bool nativeEventFilter(const QByteArray & eventType, void * message, long * result) override;
 
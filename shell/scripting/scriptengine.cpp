@@ -20,13 +20,21 @@
 #include "scriptengine.h"
 #include "scriptengine_v1.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QJSValueIterator>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QQuickItem>
+#include <QSet>
 #include <QStandardPaths>
 #include <QFutureWatcher>
+#include <QGuiApplication>
+#include <QPointer>
+#include <QUrl>
 
 #include <QDebug>
 #include <klocalizedstring.h>
@@ -34,6 +42,8 @@
 #include <kservicetypetrader.h>
 #include <kshell.h>
 #include <KLocalizedContext>
+#include <kconfigloader.h>
+#include <kdeclarative/configpropertymap.h>
 
 // KIO
 //#include <kemailsettings.h> // no camelcase include
@@ -62,12 +72,8 @@ ScriptEngine::ScriptEngine(Plasma::Corona *corona, QObject *parent)
       m_corona(corona)
 {
     Q_ASSERT(m_corona);
-    m_appInterface = new AppInterface(this);
-    connect(m_appInterface, &AppInterface::print, this, &ScriptEngine::print);
     m_scriptSelf = globalObject();
-    m_globalScriptEngineObject = new ScriptEngine::V1(this);
-    m_localizedContext = new KLocalizedContext(this);
-    setupEngine();
+    //the API is created and bound to the global object on the first script, some engines never run one
 }
 
 ScriptEngine::~ScriptEngine()
@@ -101,6 +107,176 @@ QJSValue ScriptEngine::newError(const QString &message)
     return evaluate(QString("new Error('%1');").arg(message));
 }
 
+bool ScriptEngine::loadSerializedLayout(const QJsonObject &layout)
+{
+    const QString error = applySerializedLayout(layout);
+    if (!error.isEmpty()) {
+        m_errorString = error;
+        emit printError(m_errorString);
+        return false;
+    }
+
+    return true;
+}
+
+int ScriptEngine::gridUnit()
+{
+    int gridUnit = QFontMetrics(QGuiApplication::font()).boundingRect(QStringLiteral("M")).height();
+    if (gridUnit % 2 != 0) {
+        gridUnit++;
+    }
+
+    return gridUnit;
+}
+
+// Writes all the config groups of a serialized applet or containment,
+// without saving or reloading anything in between
+static void writeSerializedConfigs(Plasma::Applet *applet, const QJsonObject &configs)
+{
+    const KConfigGroup rootGroup = applet->config();
+
+    for (auto it = configs.constBegin(), end = configs.constEnd(); it != end; ++it) {
+        KConfigGroup group = rootGroup;
+        const QStringList escapedGroups = it.key().split(QLatin1Char('/'), QString::SkipEmptyParts);
+        for (const QString &escapedGroup : escapedGroups) {
+            group = KConfigGroup(&group, QUrl::fromPercentEncoding(escapedGroup.toUtf8()));
+        }
+
+        // the wallpaper only reacts immediately when its configuration is set as well
+        KDeclarative::ConfigPropertyMap *wallpaperConfig = nullptr;
+        if (!escapedGroups.isEmpty() && escapedGroups.first() == QLatin1String("Wallpaper")) {
+            QObject *wallpaperGraphicsObject = applet->property("wallpaperGraphicsObject").value<QObject *>();
+            if (wallpaperGraphicsObject) {
+                wallpaperConfig = static_cast<KDeclarative::ConfigPropertyMap *>(wallpaperGraphicsObject->property("configuration").value<QObject *>());
+            }
+        }
+
+        const QJsonObject entries = it.value().toObject();
+        for (auto entry = entries.constBegin(), entriesEnd = entries.constEnd(); entry != entriesEnd; ++entry) {
+            const QVariant value = entry.value().toVariant();
+            group.writeEntry(entry.key(), value);
+            if (wallpaperConfig) {
+                wallpaperConfig->setProperty(entry.key().toLatin1(), value);
+            }
+        }
+    }
+}
+
+// Makes an applet pick up everything writeSerializedConfigs() wrote, once
+static void reloadSerializedConfigs(Plasma::Applet *applet)
+{
+    if (KConfigLoader *configScheme = applet->configScheme()) {
+        configScheme->blockSignals(true);
+        configScheme->read();
+        configScheme->blockSignals(false);
+        emit configScheme->configChanged();
+    }
+
+    if (!applet->isContainment()) {
+        KConfigGroup cg = applet->config();
+        applet->restore(cg);
+    }
+
+    applet->configChanged();
+}
+
+QString ScriptEngine::applySerializedLayout(const QJsonObject &layout)
+{
+    if (layout.value(QStringLiteral("serializationFormatVersion")).toVariant().toInt() != 1) {
+        return i18n("loadSerializedLayout: invalid version of the serialized object");
+    }
+
+    const auto desktops = desktopContainmentsForActivity(KActivities::Consumer().currentActivity());
+    Q_ASSERT_X(desktops.size() != 0, "ScriptEngine::applySerializedLayout", "We need desktops");
+
+    const int unit = gridUnit();
+    // everything gets created and written first, then each applet reloads its config once
+    QList<QPointer<Plasma::Applet>> written;
+
+    const QJsonArray desktopsData = layout.value(QStringLiteral("desktops")).toArray();
+    // If the template has more desktops than we do, ignore them
+    const int desktopCount = qMin(desktopsData.count(), desktops.count());
+    for (int i = 0; i < desktopCount; ++i) {
+        const QJsonObject desktopData = desktopsData.at(i).toObject();
+        Plasma::Containment *desktop = desktops.at(i);
+
+        writeSerializedConfigs(desktop, desktopData.value(QStringLiteral("config")).toObject());
+        written << desktop;
+
+        // Setting the wallpaper plugin because it is special, after its config is in place
+        const QString wallpaperPlugin = desktopData.value(QStringLiteral("wallpaperPlugin")).toString();
+        if (desktop->wallpaper() != wallpaperPlugin) {
+            desktop->setWallpaper(wallpaperPlugin);
+        }
+
+        QQuickItem *containmentItem = desktop->property("_plasma_graphicObject").value<QQuickItem *>();
+        const QJsonArray appletsData = desktopData.value(QStringLiteral("applets")).toArray();
+        for (const QJsonValue &appletValue : appletsData) {
+            const QJsonObject appletData = appletValue.toObject();
+            const QString plugin = appletData.value(QStringLiteral("plugin")).toString();
+            const QRectF geometry(appletData.value(QStringLiteral("geometry.x")).toDouble() * unit,
+                                  appletData.value(QStringLiteral("geometry.y")).toDouble() * unit,
+                                  appletData.value(QStringLiteral("geometry.width")).toDouble() * unit,
+                                  appletData.value(QStringLiteral("geometry.height")).toDouble() * unit);
+
+            // like Containment::addWidget() with a position
+            Plasma::Applet *applet = nullptr;
+            if (containmentItem && geometry.x() >= 0 && geometry.y() >= 0) {
+                QMetaObject::invokeMethod(containmentItem, "createApplet", Qt::DirectConnection, Q_RETURN_ARG(Plasma::Applet *, applet), Q_ARG(QString, plugin), Q_ARG(QVariantList, QVariantList()), Q_ARG(QRectF, geometry));
+            } else {
+                applet = desktop->createApplet(plugin);
+            }
+
+            if (applet) {
+                writeSerializedConfigs(applet, appletData.value(QStringLiteral("config")).toObject());
+                written << applet;
+            }
+        }
+    }
+
+    const QJsonArray panelsData = layout.value(QStringLiteral("panels")).toArray();
+    for (const QJsonValue &panelValue : panelsData) {
+        const QJsonObject panelData = panelValue.toObject();
+        Plasma::Containment *containment = createContainment(QStringLiteral("Panel"), QStringLiteral("org.kde.panel"));
+        if (!containment) {
+            continue;
+        }
+
+        {
+            // the panel geometry lives in the view or its defaults, which the wrapper knows about
+            Panel panel(containment, this);
+            panel.setLocation(panelData.value(QStringLiteral("location")).toString());
+            panel.setHeight(panelData.value(QStringLiteral("height")).toDouble() * unit);
+            panel.setMaximumLength(panelData.value(QStringLiteral("maximumLength")).toDouble() * unit);
+            panel.setMinimumLength(panelData.value(QStringLiteral("minimumLength")).toDouble() * unit);
+            panel.setOffset(panelData.value(QStringLiteral("offset")).toDouble() * unit);
+            panel.setAlignment(panelData.value(QStringLiteral("alignment")).toString());
+            panel.setHiding(panelData.value(QStringLiteral("hiding")).toString());
+        }
+
+        writeSerializedConfigs(containment, panelData.value(QStringLiteral("config")).toObject());
+        written << containment;
+
+        const QJsonArray appletsData = panelData.value(QStringLiteral("applets")).toArray();
+        for (const QJsonValue &appletValue : appletsData) {
+            const QJsonObject appletData = appletValue.toObject();
+            if (Plasma::Applet *applet = containment->createApplet(appletData.value(QStringLiteral("plugin")).toString())) {
+                writeSerializedConfigs(applet, appletData.value(QStringLiteral("config")).toObject());
+                written << applet;
+            }
+        }
+    }
+
+    for (const QPointer<Plasma::Applet> &applet : qAsConst(written)) {
+        if (applet) {
+            reloadSerializedConfigs(applet);
+        }
+    }
+    m_corona->requestConfigSync();
+
+    return QString();
+}
+
 QString ScriptEngine::onlyExec(const QString &commandLine)
 {
     if (commandLine.isEmpty()) {
@@ -112,6 +288,15 @@ QString ScriptEngine::onlyExec(const QString &commandLine)
 
 void ScriptEngine::setupEngine()
 {
+    if (m_globalScriptEngineObject) {
+        return;
+    }
+
+    m_appInterface = new AppInterface(this);
+    connect(m_appInterface, &AppInterface::print, this, &ScriptEngine::print);
+    m_globalScriptEngineObject = new ScriptEngine::V1(this);
+    m_localizedContext = new KLocalizedContext(this);
+
     QJSValue globalScriptEngineObject = newQObject(m_globalScriptEngineObject);
     QJSValue localizedContext = newQObject(m_localizedContext);
     QJSValue appInterface = newQObject(m_appInterface);
@@ -260,7 +445,8 @@ Plasma::Corona *ScriptEngine::corona() const
 bool ScriptEngine::evaluateScript(const QString &script, const QString &path)
 {
     m_errorString = QString();
-    
+    setupEngine();
+
     QJSValue result = evaluate(script, path);
     if (result.isError()) {
         //qDebug() << "catch the exception!";
@@ -291,10 +477,22 @@ QStringList ScriptEngine::pendingUpdateScripts(Plasma::Corona *corona)
     }
 
     const QString appName = corona->package().metadata().pluginName();
+    KConfigGroup cg(KSharedConfig::openConfig(), "Updates");
+    //modification time of every updates directory when it was last listed:
+    //a script added or removed changes it, anything found back then is either performed or skipped for good
+    KConfigGroup scannedCg(&cg, "ScannedDirectories");
     QStringList scripts;
+    bool rescanned = false;
 
     const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, "plasma/shells/" + appName + QStringLiteral("/contents/updates"), QStandardPaths::LocateDirectory);
     for (const QString& dir : dirs) {
+        const qint64 lastModified = QFileInfo(dir).lastModified().toMSecsSinceEpoch();
+        if (scannedCg.readEntry(dir, qint64(-1)) == lastModified) {
+            continue;
+        }
+        scannedCg.writeEntry(dir, lastModified);
+        rescanned = true;
+
         QDirIterator it(dir, QStringList() << QStringLiteral("*.js"));
         while (it.hasNext()) {
             scripts.append(it.next());
@@ -304,15 +502,18 @@ QStringList ScriptEngine::pendingUpdateScripts(Plasma::Corona *corona)
 
     if (scripts.isEmpty()) {
         //qDebug() << "no update scripts";
+        if (rescanned) {
+            KSharedConfig::openConfig()->sync();
+        }
         return scriptPaths;
     }
 
-    KConfigGroup cg(KSharedConfig::openConfig(), "Updates");
     QStringList performed = cg.readEntry("performed", QStringList());
+    QSet<QString> performedSet(performed.constBegin(), performed.constEnd());
     const QString localXdgDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation);
 
     foreach (const QString &script, scripts) {
-        if (performed.contains(script)) {
+        if (performedSet.contains(script)) {
             continue;
         }
 
@@ -323,6 +524,7 @@ QStringList ScriptEngine::pendingUpdateScripts(Plasma::Corona *corona)
 
         scriptPaths.append(script);
         performed.append(script);
+        performedSet.insert(script);
     }
 
     cg.writeEntry("performed", performed);
@@ -343,9 +545,9 @@ QStringList ScriptEngine::availableActivities() const
     return QStringList();
 }
 
-QList<Containment*> ScriptEngine::desktopsForActivity(const QString &id)
+QList<Plasma::Containment *> ScriptEngine::desktopContainmentsForActivity(const QString &id)
 {
-    QList<Containment*> result;
+    QList<Plasma::Containment *> result;
 
     // confirm this activity actually exists
     bool found = false;
@@ -362,7 +564,7 @@ QList<Containment*> ScriptEngine::desktopsForActivity(const QString &id)
 
     foreach (Plasma::Containment *c, m_corona->containments()) {
         if (c->activity() == id && !isPanel(c)) {
-            result << new Containment(c, this);
+            result << c;
         }
     }
 
@@ -375,12 +577,12 @@ QList<Containment*> ScriptEngine::desktopsForActivity(const QString &id)
         StandaloneAppCorona *ac = qobject_cast<StandaloneAppCorona *>(m_corona);
         if (sc) {
             foreach (int i, sc->screenIds()) {
-                result << new Containment(sc->createContainmentForActivity(id, i), this);
+                result << sc->createContainmentForActivity(id, i);
             }
         } else if (ac) {
             const int numScreens = m_corona->numScreens();
             for (int i = 0; i < numScreens; ++i) {
-                result << new Containment(ac->createContainmentForActivity(id, i), this);
+                result << ac->createContainmentForActivity(id, i);
             }
         }
     }
@@ -388,6 +590,18 @@ QList<Containment*> ScriptEngine::desktopsForActivity(const QString &id)
     return result;
 }
 
+QList<Containment*> ScriptEngine::desktopsForActivity(const QString &id)
+{
+    QList<Containment*> result;
+
+    const auto containments = desktopContainmentsForActivity(id);
+    for (Plasma::Containment *c : containments) {
+        result << new Containment(c, this);
+    }
+
+    return result;
+}
+
 Plasma::Containment *ScriptEngine::createContainment(const QString &type, const QString &plugin)
 {
     bool exists = false;
@@ -36,6 +36,7 @@ namespace Plasma
 } // namespace Plasma
 
 class KLocalizedContext;
+class QJsonObject;
 
 namespace WorkspaceScripting
 {
@@ -66,6 +67,12 @@ public:
 
     Plasma::Containment *createContainment(const QString &type, const QString &plugin);
 
+    /**
+     * Same as the loadSerializedLayout() function of the scripting API,
+     * without going through the evaluation of a script
+     */
+    bool loadSerializedLayout(const QJsonObject &layout);
+
 public Q_SLOTS:
     bool evaluateScript(const QString &script, const QString &path = QString());
 
@@ -82,7 +89,10 @@ private:
 
     // helpers
     QStringList availableActivities() const;
+    QList<Plasma::Containment *> desktopContainmentsForActivity(const QString &id);
     QList<Containment*> desktopsForActivity(const QString &id);
+    QString applySerializedLayout(const QJsonObject &layout);
+    static int gridUnit();
     Containment *createContainmentWrapper(const QString &type, const QString &plugin);
 
 private Q_SLOTS:
@@ -90,9 +100,10 @@ private Q_SLOTS:
 
 private:
     Plasma::Corona *m_corona;
-    ScriptEngine::V1 *m_globalScriptEngineObject;
-    KLocalizedContext *m_localizedContext;
-    AppInterface *m_appInterface;
+    //created by setupEngine()
+    ScriptEngine::V1 *m_globalScriptEngineObject = nullptr;
+    KLocalizedContext *m_localizedContext = nullptr;
+    AppInterface *m_appInterface = nullptr;
     QJSValue m_scriptSelf;
     QString m_errorString;
 };
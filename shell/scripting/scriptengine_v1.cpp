@@ -23,7 +23,7 @@
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
-#include <QJSValueIterator>
+#include <QJsonObject>
 #include <QStandardPaths>
 #include <QFutureWatcher>
 
@@ -61,59 +61,6 @@ namespace {
         }
     }
 
-    class ScriptArray_forEach_Helper {
-    public:
-        ScriptArray_forEach_Helper(const QJSValue &array)
-            : array(array)
-        {
-        }
-
-        // operator + is commonly used for these things
-        // to avoid having the lambda inside the parenthesis
-        template <typename Function>
-        void operator+ (Function function) const
-        {
-            if (!array.isArray()) return;
-
-            int length = array.property("length").toInt();
-            for (int i = 0; i < length; ++i) {
-                function(array.property(i));
-            }
-        }
-
-    private:
-        const QJSValue &array;
-    };
-
-    #define SCRIPT_ARRAY_FOREACH(Variable, Array) \
-        ScriptArray_forEach_Helper(Array) + [&] (const QJSValue &Variable)
-
-    class ScriptObject_forEach_Helper {
-    public:
-        ScriptObject_forEach_Helper(const QJSValue &object)
-            : object(object)
-        {
-        }
-
-        // operator + is commonly used for these things
-        // to avoid having the lambda inside the parenthesis
-        template <typename Function>
-        void operator+ (Function function) const
-        {
-            QJSValueIterator it(object);
-            while (it.hasNext()) {
-                it.next();
-                function(it.name(), it.value());
-            }
-        }
-
-    private:
-        const QJSValue &object;
-    };
-
-    #define SCRIPT_OBJECT_FOREACH(Key, Value, Array) \
-        ScriptObject_forEach_Helper(Array) + [&] (const QString &Key, const QJSValue &Value)
-
     // Case insensitive comparison of two strings
     template <typename StringType>
     inline bool matches(const QString &object, const StringType &string)
@@ -143,12 +90,7 @@ QJSValue ScriptEngine::V1::getApiVersion(const QJSValue &param)
 
 int ScriptEngine::V1::gridUnit() const
 {
-    int gridUnit = QFontMetrics(QGuiApplication::font()).boundingRect(QStringLiteral("M")).height();
-    if (gridUnit % 2 != 0) {
-        gridUnit++;
-    }
-
-    return gridUnit;
+    return ScriptEngine::gridUnit();
 }
 
 QJSValue ScriptEngine::V1::desktopById(const QJSValue &param) const
@@ -308,111 +250,17 @@ QJSValue ScriptEngine::V1::activities() const
     return acts;
 }
 
-// Utility function to process configs and config groups
-template <typename Object>
-void loadSerializedConfigs(Object *object, const QJSValue &configs)
-{
-    SCRIPT_OBJECT_FOREACH(escapedGroup, config, configs) {
-        // If the config group is set, pass it on to the containment
-        QStringList groups = escapedGroup.split('/', QString::SkipEmptyParts);
-        for (QString &group: groups) {
-            group = QUrl::fromPercentEncoding(group.toUtf8());
-        }
-        qDebug() << "Config group" << groups;
-        object->setCurrentConfigGroup(groups);
-
-        // Read other properties and set the configuration
-        SCRIPT_OBJECT_FOREACH(key, value, config) {
-            object->writeConfig(key, value);
-        };
-    };
-}
-
 QJSValue ScriptEngine::V1::loadSerializedLayout(const QJSValue &data)
 {
     if (!data.isObject()) {
         return m_engine->newError(i18n("loadSerializedLayout requires the JSON object to deserialize from"));
     }
 
-    if (data.property("serializationFormatVersion").toInt() != 1) {
-        return m_engine->newError(i18n("loadSerializedLayout: invalid version of the serialized object"));
+    const QString error = m_engine->applySerializedLayout(QJsonObject::fromVariantMap(data.toVariant().toMap()));
+    if (!error.isEmpty()) {
+        return m_engine->newError(error);
     }
 
-    const auto desktops = m_engine->desktopsForActivity(KActivities::Consumer().currentActivity());
-    Q_ASSERT_X(desktops.size() != 0, "V1::loadSerializedLayout", "We need desktops");
-
-    // qDebug() << "DESKTOP DESERIALIZATION: Loading desktops...";
-
-    int count = 0;
-    SCRIPT_ARRAY_FOREACH(desktopData, data.property("desktops")) {
-        // If the template has more desktops than we do, ignore them
-        if (count >= desktops.size()) return;
-
-        auto desktop = desktops[count];
-        // qDebug() << "DESKTOP DESERIALIZATION: var cont = desktopsArray[...]; " << count << " -> " << desktop;
-
-        // Setting the wallpaper plugin because it is special
-        desktop->setWallpaperPlugin(desktopData.property("wallpaperPlugin").toString());
-        // qDebug() << "DESKTOP DESERIALIZATION: cont->setWallpaperPlugin(...) " << desktop->wallpaperPlugin();
-
-        // Now, lets go through the configs
-        loadSerializedConfigs(desktop, desktopData.property("config"));
-
-        // After the config, we want to load the applets
-        SCRIPT_ARRAY_FOREACH(appletData, desktopData.property("applets")) {
-            // qDebug() << "DESKTOP DESERIALIZATION: Applet: " << appletData.toString();
-
-            auto appletObject = desktop->addWidget( appletData.property("plugin"),
-                appletData.property("geometry.x").toInt()      * gridUnit(),
-                appletData.property("geometry.y").toInt()      * gridUnit(),
-                appletData.property("geometry.width").toInt()  * gridUnit(),
-                appletData.property("geometry.height").toInt() * gridUnit());
-
-            if (auto applet = qobject_cast<Widget*>(appletObject.toQObject())) {
-                // Now, lets go through the configs for the applet
-                loadSerializedConfigs(applet, appletData.property("config"));
-            }
-        };
-
-        count++;
-    };
-
-    // qDebug() << "PANEL DESERIALIZATION: Loading panels...";
-
-    SCRIPT_ARRAY_FOREACH(panelData, data.property("panels")) {
-        const auto panel = qobject_cast<Panel *>(m_engine->createContainmentWrapper(
-            QStringLiteral("Panel"), QStringLiteral("org.kde.panel")));
-
-        Q_ASSERT(panel);
-
-        // Basic panel setup
-        panel->setLocation(panelData.property("location").toString());
-        panel->setHeight(panelData.property("height").toNumber() * gridUnit());
-        panel->setMaximumLength(panelData.property("maximumLength").toNumber() * gridUnit());
-        panel->setMinimumLength(panelData.property("minimumLength").toNumber() * gridUnit());
-        panel->setOffset(panelData.property("offset").toNumber() * gridUnit());
-        panel->setAlignment(panelData.property("alignment").toString());
-        panel->setHiding(panelData.property("hiding").toString());
-
-        // Loading the config for the panel
-        loadSerializedConfigs(panel, panelData.property("config"));
-
-        // Now dealing with the applets
-        SCRIPT_ARRAY_FOREACH(appletData, panelData.property("applets")) {
-            // qDebug() << "PANEL DESERIALIZATION: Applet: " << appletData.toString();
-
-            auto appletObject = panel->addWidget(appletData.property("plugin"));
-            // qDebug() << "PANEL DESERIALIZATION: addWidget"
-            //      << appletData.property("plugin").toString()
-            //      ;
-
-            if (auto applet = qobject_cast<Widget*>(appletObject.toQObject())) {
-                // Now, lets go through the configs for the applet
-                loadSerializedConfigs(applet, appletData.property("config"));
-            }
-        };
-    };
-
     return QJSValue();
 }
 
@@ -79,6 +79,7 @@
 #include "panelview.h"
 #include "scripting/scriptengine.h"
 #include "osd.h"
+#include "qmlcachewarmer.h"
 #include "screenpool.h"
 
 #include "plasmashelladaptor.h"
@@ -98,6 +99,7 @@
 #endif
 
 static const int s_configSyncDelay = 10000; // 10 seconds
+static const int s_qmlCacheWarmingDelay = 30000; // 30 seconds, well after startup
 
 ShellCorona::ShellCorona(QObject *parent)
     : Plasma::Corona(parent),
@@ -109,11 +111,13 @@ ShellCorona::ShellCorona(QObject *parent)
       m_interactiveConsole(nullptr),
       m_waylandPlasmaShell(nullptr),
       m_closingDown(false),
-      m_strutManager(new StrutManager(this))
+      m_strutManager(new StrutManager(this)),
+      m_qmlCacheWarmer(new QmlCacheWarmer(this))
 #ifdef WITH_KUSERFEEDBACKCORE
       , m_feedbackProvider(new KUserFeedback::Provider(this))
 #endif
 {
+    m_screenIndex.setScreenPool(m_screenPool);
     setupWaylandIntegration();
     qmlRegisterUncreatableType<DesktopView>("org.kde.plasma.shell", 2, 0, "Desktop", QStringLiteral("It is not possible to create objects of type Desktop"));
     qmlRegisterUncreatableType<PanelView>("org.kde.plasma.shell", 2, 0, "Panel", QStringLiteral("It is not possible to create objects of type Panel"));
@@ -129,8 +133,6 @@ ShellCorona::ShellCorona(QObject *parent)
         executeSetupPlasmoidScript(c, c);
     });
 
-    connect(this, &Plasma::Corona::availableScreenRectChanged, this, &Plasma::Corona::availableScreenRegionChanged);
-
     m_appConfigSyncTimer.setSingleShot(true);
     m_appConfigSyncTimer.setInterval(s_configSyncDelay);
     connect(&m_appConfigSyncTimer, &QTimer::timeout, this, &ShellCorona::syncAppConfig);
@@ -251,6 +253,17 @@ ShellCorona::ShellCorona(QObject *parent)
     connect(KDirWatch::self(), &KDirWatch::dirty, this, &ShellCorona::configurationChanged);
     connect(KDirWatch::self(), &KDirWatch::created, this, &ShellCorona::configurationChanged);
 
+    // applets in use that get updated have their QML compiled ahead of the next start
+    const QString localPlasmoidsPath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/plasma/plasmoids");
+    KDirWatch::self()->addDir(localPlasmoidsPath);
+    auto warmPlasmoids = [this, localPlasmoidsPath](const QString &path) {
+        if (path.startsWith(localPlasmoidsPath)) {
+            scheduleQmlCacheWarming();
+        }
+    };
+    connect(KDirWatch::self(), &KDirWatch::dirty, this, warmPlasmoids);
+    connect(KDirWatch::self(), &KDirWatch::created, this, warmPlasmoids);
+
     connect(qApp, &QGuiApplication::focusWindowChanged,
             this, [this] (QWindow *focusWindow) {
             if (!focusWindow) {
@@ -451,7 +464,7 @@ QJsonObject dumpconfigGroupJS(const KConfigGroup &rootGroup)
     return result;
 }
 
-QByteArray ShellCorona::dumpCurrentLayoutJS() const
+QJsonObject ShellCorona::dumpCurrentLayout() const
 {
     QJsonObject root;
     root.insert("serializationFormatVersion", "1");
@@ -660,8 +673,13 @@ QByteArray ShellCorona::dumpCurrentLayoutJS() const
 
     root.insert("desktops", desktopsJson);
 
+    return root;
+}
+
+QByteArray ShellCorona::dumpCurrentLayoutJS() const
+{
     QJsonDocument json;
-    json.setObject(root);
+    json.setObject(dumpCurrentLayout());
 
     return
         "var plasma = getApiVersion(1);\n\n"
@@ -669,6 +687,37 @@ QByteArray ShellCorona::dumpCurrentLayoutJS() const
         "plasma.loadSerializedLayout(layout);\n";
 }
 
+QByteArray ShellCorona::dumpCurrentLayoutJSON() const
+{
+    QJsonDocument json;
+    json.setObject(dumpCurrentLayout());
+
+    return json.toJson(QJsonDocument::Compact);
+}
+
+void ShellCorona::loadSerializedLayout(const QByteArray &layout)
+{
+    QJsonParseError error;
+    const QJsonDocument json = QJsonDocument::fromJson(layout, &error);
+    if (!json.isObject()) {
+        qWarning() << "Invalid serialized layout:" << error.errorString();
+        return;
+    }
+
+    WorkspaceScripting::ScriptEngine scriptEngine(this);
+
+    connect(&scriptEngine, &WorkspaceScripting::ScriptEngine::printError, this,
+            [](const QString &msg) {
+                qWarning() << msg;
+            });
+    connect(&scriptEngine, &WorkspaceScripting::ScriptEngine::print, this,
+            [](const QString &msg) {
+                qDebug() << msg;
+            });
+
+    scriptEngine.loadSerializedLayout(json.object());
+}
+
 void ShellCorona::loadLookAndFeelDefaultLayout(const QString &packageName)
 {
     KPackage::Package newPack = m_lookAndFeelPackage;
@@ -715,6 +764,8 @@ void ShellCorona::load()
 
     disconnect(m_activityController, &KActivities::Controller::serviceStatusChanged, this, &ShellCorona::load);
 
+    m_startupTimer.start();
+
     m_screenPool->load();
 
     //TODO: a kconf_update script is needed
@@ -759,7 +810,13 @@ void ShellCorona::load()
     //NOTE: this is needed in case loadLayout() did *not* call loadDefaultLayout()
     //it needs to be after of loadLayout() as it would always create new
     //containments on each startup otherwise
-    for (QScreen* screen : qGuiApp->screens()) {
+    //the primary screen goes first, it's where the user is going to look at
+    QList<QScreen *> screens = qGuiApp->screens();
+    if (QScreen *primary = qGuiApp->primaryScreen()) {
+        screens.removeOne(primary);
+        screens.prepend(primary);
+    }
+    for (QScreen* screen : qAsConst(screens)) {
         //the containments may have been created already by the startup script
         //check their existence in order to not have duplicated desktopviews
         if (!m_desktopViewforId.contains(m_screenPool->id(screen->name()))) {
@@ -830,6 +887,9 @@ void ShellCorona::primaryOutputChanged()
         }
     }
 
+    //the desktops swapped ids, their cached geometry with them
+    updateAvailableScreenGeometry();
+
     //can't do the screen invariant here as reconsideroutputs wasn't executed yet
     //CHECK_SCREEN_INVARIANTS
 }
@@ -918,10 +978,13 @@ void ShellCorona::unload()
     if (m_shell.isEmpty()) {
         return;
     }
-    qDeleteAll(m_desktopViewforId);
+    const auto desktopViews = m_desktopViewforId;
+    const auto panelViews = m_panelViews;
     m_desktopViewforId.clear();
-    qDeleteAll(m_panelViews);
     m_panelViews.clear();
+    invalidateScreenIndex();
+    qDeleteAll(desktopViews);
+    qDeleteAll(panelViews);
     m_waitingPanels.clear();
     m_activityContainmentPlugins.clear();
 
@@ -942,6 +1005,9 @@ KSharedConfig::Ptr ShellCorona::applicationConfig()
 
 void ShellCorona::requestApplicationConfigSync()
 {
+    if (m_appConfigSyncTimer.isActive()) {
+        ++m_coalescedAppConfigSyncs;
+    }
     m_appConfigSyncTimer.start();
 }
 
@@ -980,6 +1046,10 @@ void ShellCorona::loadDefaultLayout()
 
     script = m_testModeLayout;
 
+    //a layout serialized by dumpCurrentLayoutJSON() is applied as is, without a script to evaluate
+    if (script.isEmpty()) {
+        script = m_lookAndFeelPackage.filePath("layouts", QString(shell() + "-layout.json").toLatin1());
+    }
     if (script.isEmpty()) {
         script = m_lookAndFeelPackage.filePath("layouts", QString(shell() + "-layout.js").toLatin1());
     }
@@ -989,7 +1059,7 @@ void ShellCorona::loadDefaultLayout()
 
     QFile file(script);
     if (file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
-        QString code = file.readAll();
+        const QByteArray code = file.readAll();
         qDebug() << "evaluating startup script:" << script;
 
         // We need to know which activities are here in order for
@@ -1010,7 +1080,15 @@ void ShellCorona::loadDefaultLayout()
                 [](const QString &msg) {
                     qDebug() << msg;
                 });
-        if (!scriptEngine.evaluateScript(code, script)) {
+        if (script.endsWith(QLatin1String(".json"))) {
+            QJsonParseError error;
+            const QJsonDocument json = QJsonDocument::fromJson(code, &error);
+            if (!json.isObject()) {
+                qWarning() << "Invalid serialized layout:" << script << error.errorString();
+            } else if (!scriptEngine.loadSerializedLayout(json.object())) {
+                qWarning() << "failed to initialize layout properly:" << script;
+            }
+        } else if (!scriptEngine.evaluateScript(QString::fromUtf8(code), script)) {
             qWarning() << "failed to initialize layout properly:" << script;
         }
     }
@@ -1078,6 +1156,15 @@ QRegion ShellCorona::_availableScreenRegion(int id) const
         return s ? s->availableGeometry() : QRegion();
     }
 
+    auto it = m_availableScreenRegions.constFind(id);
+    if (it != m_availableScreenRegions.constEnd()) {
+        return *it;
+    }
+    return computeAvailableScreenRegion(view);
+}
+
+QRegion ShellCorona::computeAvailableScreenRegion(DesktopView *view) const
+{
     QRegion r = view->geometry();
     for (const PanelView *v : m_panelViews) {
         if (v->isVisible() && view->screen() == v->screen() && v->visibilityMode() != PanelView::AutoHide) {
@@ -1103,6 +1190,15 @@ QRect ShellCorona::_availableScreenRect(int id) const
         return s ? s->availableGeometry() : QRect();
     }
 
+    auto it = m_availableScreenRects.constFind(id);
+    if (it != m_availableScreenRects.constEnd()) {
+        return *it;
+    }
+    return computeAvailableScreenRect(view);
+}
+
+QRect ShellCorona::computeAvailableScreenRect(DesktopView *view) const
+{
     QRect r = view->geometry();
     for (PanelView *v : m_panelViews) {
         if (v->isVisible() && v->screen() == view->screen() && v->visibilityMode() != PanelView::AutoHide) {
@@ -1126,6 +1222,29 @@ QRect ShellCorona::_availableScreenRect(int id) const
     return r;
 }
 
+void ShellCorona::updateAvailableScreenGeometry()
+{
+    QHash<int, QRegion> regions;
+    QHash<int, QRect> rects;
+    for (auto it = m_desktopViewforId.constBegin(); it != m_desktopViewforId.constEnd(); ++it) {
+        regions.insert(it.key(), computeAvailableScreenRegion(it.value()));
+        rects.insert(it.key(), computeAvailableScreenRect(it.value()));
+    }
+
+    //QML reacts to these by relayouting, so only tell when something moved
+    const bool regionsChanged = regions != m_availableScreenRegions;
+    const bool rectsChanged = rects != m_availableScreenRects;
+    m_availableScreenRegions = regions;
+    m_availableScreenRects = rects;
+
+    if (rectsChanged) {
+        emit availableScreenRectChanged();
+    }
+    if (regionsChanged) {
+        emit availableScreenRegionChanged();
+    }
+}
+
 QStringList ShellCorona::availableActivities() const
 {
     return m_activityContainmentPlugins.keys();
@@ -1141,6 +1260,10 @@ void ShellCorona::removeDesktop(DesktopView *desktopView)
     }
     Q_ASSERT(m_desktopViewforId.value(idx) == desktopView);
 
+    m_desktopViewforId.erase(itDesktop);
+    invalidateScreenIndex();
+
+    QList<PanelView *> removedPanels;
     QMutableHashIterator<const Plasma::Containment *, PanelView *> it(m_panelViews);
     while (it.hasNext()) {
         it.next();
@@ -1149,13 +1272,20 @@ void ShellCorona::removeDesktop(DesktopView *desktopView)
         if (panelView->containment()->screen() == idx) {
             m_waitingPanels << panelView->containment();
             it.remove();
-            delete panelView;
+            removedPanels << panelView;
         }
     }
 
-    m_desktopViewforId.erase(itDesktop);
+    //containment()->screen() above may have rebuilt the index with them
+    invalidateScreenIndex();
+
+    qDeleteAll(removedPanels);
     delete desktopView;
 
+    if (!m_closingDown) {
+        updateAvailableScreenGeometry();
+    }
+
     emit screenRemoved(idx);
 }
 
@@ -1166,15 +1296,20 @@ PanelView *ShellCorona::panelView(Plasma::Containment *containment) const
 
 ///// SLOTS
 
+void ShellCorona::invalidateScreenIndex()
+{
+    m_screenIndex.invalidate();
+}
+
+void ShellCorona::updateScreenIndex() const
+{
+    m_screenIndex.update(m_desktopViewforId, m_panelViews);
+}
+
 QList<PanelView *> ShellCorona::panelsForScreen(QScreen *screen) const
 {
-    QList<PanelView *> ret;
-    for (PanelView *v : m_panelViews) {
-        if (v->screenToFollow() == screen) {
-            ret += v;
-        }
-    }
-    return ret;
+    updateScreenIndex();
+    return m_screenIndex.panelsForScreen(screen);
 }
 
 DesktopView* ShellCorona::desktopForScreen(QScreen* screen) const
@@ -1184,6 +1319,8 @@ DesktopView* ShellCorona::desktopForScreen(QScreen* screen) const
 
 void ShellCorona::handleScreenRemoved(QScreen* screen)
 {
+    invalidateScreenIndex();
+
     if (DesktopView* v = desktopForScreen(screen)) {
         removeDesktop(v);
     }
@@ -1265,6 +1402,8 @@ void ShellCorona::reconsiderOutputs()
 void ShellCorona::addOutput(QScreen* screen)
 {
     Q_ASSERT(screen);
+    invalidateScreenIndex();
+
     connect(screen, &QScreen::geometryChanged,
             &m_reconsiderOutputsTimer, static_cast<void (QTimer::*)()>(&QTimer::start),
             Qt::UniqueConnection);
@@ -1286,14 +1425,21 @@ void ShellCorona::addOutput(QScreen* screen)
     if (view->rendererInterface()->graphicsApi() != QSGRendererInterface::Software) {
         connect(view, &QQuickWindow::sceneGraphError, this, &ShellCorona::glInitializationFailed);
     }
+    //desktop views change containment on activity switches
+    connect(view, &DesktopView::containmentChanged, this, &ShellCorona::invalidateScreenIndex);
     connect(view, &DesktopView::geometryChanged, this, [=]() {
         const int id = m_screenPool->id(view->screen()->name());
         if (id >= 0) {
             emit screenGeometryChanged(id);
-            emit availableScreenRegionChanged();
-            emit availableScreenRectChanged();
         }
     });
+    //the cached available geometry is cut from the view geometry
+    connect(view, &DesktopView::geometryChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+    connect(view, &QWindow::screenChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+    connect(view, &QWindow::xChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+    connect(view, &QWindow::yChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+    connect(view, &QWindow::widthChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+    connect(view, &QWindow::heightChanged, this, &ShellCorona::updateAvailableScreenGeometry);
 
     Plasma::Containment *containment = createContainmentForActivity(m_activityController->currentActivity(), insertPosition);
     Q_ASSERT(containment);
@@ -1307,7 +1453,11 @@ void ShellCorona::addOutput(QScreen* screen)
 
     m_screenPool->insertScreenMapping(insertPosition, screen->name());
     m_desktopViewforId[insertPosition] = view;
+    invalidateScreenIndex();
+    QElapsedTimer viewCreationTimer;
+    viewCreationTimer.start();
     view->setContainment(containment);
+    reportStartupTime(containment, viewCreationTimer.elapsed());
     view->show();
     Q_ASSERT(screen == view->screen());
 
@@ -1320,7 +1470,7 @@ void ShellCorona::addOutput(QScreen* screen)
         m_waitingPanelsTimer.start();
     }
 
-    emit availableScreenRectChanged();
+    updateAvailableScreenGeometry();
     emit screenAdded(m_screenPool->id(screen->name()));
 
     CHECK_SCREEN_INVARIANTS
@@ -1335,6 +1485,7 @@ void ShellCorona::checkAllDesktopsUiReady(bool ready)
             return;
 
         qDebug() << "Plasma Shell startup completed";
+        scheduleQmlCacheWarming();
         QDBusMessage ksplashProgressMessage = QDBusMessage::createMethodCall(QStringLiteral("org.kde.KSplash"),
                                         QStringLiteral("/KSplash"),
                                         QStringLiteral("org.kde.KSplash"),
@@ -1342,6 +1493,8 @@ void ShellCorona::checkAllDesktopsUiReady(bool ready)
         ksplashProgressMessage.setArguments(QList<QVariant>() << QStringLiteral("desktop"));
         QDBusConnection::sessionBus().asyncCall(ksplashProgressMessage);
     }
+
+    m_startupCompleted = true;
 }
 
 Plasma::Containment *ShellCorona::createContainmentForActivity(const QString& activity, int screenNum)
@@ -1377,6 +1530,18 @@ void ShellCorona::createWaitingPanels()
 {
     QList<Plasma::Containment *> stillWaitingPanels;
 
+    //panels are created one screen per event loop pass, the primary one first,
+    //so those are usable without waiting for the panels of all other screens
+    int screenOfThisPass = -1;
+    for (Plasma::Containment *cont : qAsConst(m_waitingPanels)) {
+        const int requestedScreen = qMax(cont->lastScreen(), 0);
+        if (m_desktopViewforId.contains(requestedScreen) && (screenOfThisPass < 0 || requestedScreen < screenOfThisPass)) {
+            screenOfThisPass = requestedScreen;
+        }
+    }
+
+    bool morePanelsReady = false;
+
     for (Plasma::Containment *cont : qAsConst(m_waitingPanels)) {
         //ignore non existing (yet?) screens
         int requestedScreen = cont->lastScreen();
@@ -1390,6 +1555,12 @@ void ShellCorona::createWaitingPanels()
             continue;
         }
 
+        if (requestedScreen != screenOfThisPass) {
+            stillWaitingPanels << cont;
+            morePanelsReady = true;
+            continue;
+        }
+
         //TODO: does a similar check make sense?
         //Q_ASSERT(qBound(0, requestedScreen, m_screenPool->count() - 1) == requestedScreen);
         QScreen *screen = desktopView->screenToFollow();
@@ -1397,30 +1568,92 @@ void ShellCorona::createWaitingPanels()
         if (panel->rendererInterface()->graphicsApi() != QSGRendererInterface::Software) {
             connect(panel, &QQuickWindow::sceneGraphError, this, &ShellCorona::glInitializationFailed);
         }
-        connect(panel, &QWindow::visibleChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &QWindow::screenChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::locationChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::visibilityModeChanged, this, &Plasma::Corona::availableScreenRectChanged);
-        connect(panel, &PanelView::thicknessChanged, this, &Plasma::Corona::availableScreenRectChanged);
+        connect(panel, &QWindow::visibleChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &QWindow::screenChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::locationChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::visibilityModeChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::thicknessChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::alignmentChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::offsetChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::lengthChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::minimumLengthChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::maximumLengthChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &QWindow::xChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &QWindow::yChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &QWindow::widthChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &QWindow::heightChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::screenGeometryChanged, this, &ShellCorona::updateAvailableScreenGeometry);
+        connect(panel, &PanelView::screenToFollowChanged, this, &ShellCorona::invalidateScreenIndex);
 
         m_panelViews[cont] = panel;
+        invalidateScreenIndex();
+        QElapsedTimer viewCreationTimer;
+        viewCreationTimer.start();
         panel->setContainment(cont);
+        reportStartupTime(cont, viewCreationTimer.elapsed());
         cont->reactToScreenChange();
 
         connect(cont, &QObject::destroyed, this, &ShellCorona::panelContainmentDestroyed);
     }
     m_waitingPanels = stillWaitingPanels;
-    emit availableScreenRectChanged();
+    updateAvailableScreenGeometry();
+
+    if (morePanelsReady) {
+        QMetaObject::invokeMethod(this, &ShellCorona::createWaitingPanels, Qt::QueuedConnection);
+    }
+}
+
+void ShellCorona::reportStartupTime(Plasma::Containment *containment, qint64 viewCreationTime)
+{
+    //screens and panels added later on are no part of the startup
+    if (m_startupCompleted) {
+        return;
+    }
+
+    if (containment->isUiReady()) {
+        qCDebug(PLASMASHELL) << "Containment" << containment->id() << containment->pluginMetaData().pluginId()
+                             << "view created in" << viewCreationTime << "ms, ready after" << m_startupTimer.elapsed() << "ms";
+        return;
+    }
+
+    qCDebug(PLASMASHELL) << "Containment" << containment->id() << containment->pluginMetaData().pluginId()
+                         << "view created in" << viewCreationTime << "ms";
+
+    auto connection = QSharedPointer<QMetaObject::Connection>::create();
+    *connection = connect(containment, &Plasma::Containment::uiReadyChanged, this, [this, containment, connection](bool ready) {
+        if (!ready) {
+            return;
+        }
+        qCDebug(PLASMASHELL) << "Containment" << containment->id() << "ready after" << m_startupTimer.elapsed() << "ms";
+        disconnect(*connection);
+    });
+}
+
+void ShellCorona::scheduleQmlCacheWarming()
+{
+    //only the packages the shell shows, never everything installed
+    QSet<QString> pluginIds;
+    for (const Plasma::Containment *containment : containments()) {
+        pluginIds.insert(containment->pluginMetaData().pluginId());
+        const auto applets = containment->applets();
+        for (const Plasma::Applet *applet : applets) {
+            pluginIds.insert(applet->pluginMetaData().pluginId());
+        }
+    }
+    pluginIds.remove(QString());
+
+    m_qmlCacheWarmer->scheduleWarming(pluginIds.values(), s_qmlCacheWarmingDelay);
 }
 
 void ShellCorona::panelContainmentDestroyed(QObject *cont)
 {
     auto view = m_panelViews.take(static_cast<Plasma::Containment*>(cont));
+    invalidateScreenIndex();
     view->deleteLater();
     //don't make things relayout when the application is quitting
     //NOTE: qApp->closingDown() is still false here
     if (!m_closingDown) {
-        emit availableScreenRectChanged();
+        updateAvailableScreenGeometry();
     }
 }
 
@@ -1501,7 +1734,15 @@ void ShellCorona::toggleActivityManager()
 
 void ShellCorona::syncAppConfig()
 {
+    //also called for every sync of the applets config, which may well have happened on its own
+    m_appConfigSyncTimer.stop();
+    if (!applicationConfig()->isDirty()) {
+        ++m_coalescedAppConfigSyncs;
+        return;
+    }
+
     applicationConfig()->sync();
+    qCDebug(PLASMASHELL) << "Synced the application config," << m_coalescedAppConfigSyncs << "sync requests coalesced so far";
 }
 
 void ShellCorona::setDashboardShown(bool show)
@@ -1805,7 +2046,7 @@ Plasma::Containment *ShellCorona::setContainmentTypeForScreen(int screen, const
     //Save now as we now have a screen, so lastScreen will not be -1
     newContainment->save(newCg);
     requestConfigSync();
-    emit availableScreenRectChanged();
+    updateAvailableScreenGeometry();
 
     return newContainment;
 }
@@ -1991,11 +2232,15 @@ int ShellCorona::screenForContainment(const Plasma::Containment *containment) co
         }
     }
 
+    updateScreenIndex();
+
     //if the desktop views already exist, base the decision upon them
-    for (auto it = m_desktopViewforId.constBegin(), end = m_desktopViewforId.constEnd(); it != end; ++it) {
-        if (it.value()->containment() == containment && containment->activity() == m_activityController->currentActivity()) {
-            return it.key();
-        }
+    //the view is checked again, a destroyed containment may have left its address behind
+    const int desktopScreen = m_screenIndex.screenForDesktop(containment);
+    if (desktopScreen >= 0
+        && m_desktopViewforId.value(desktopScreen)->containment() == containment
+        && containment->activity() == m_activityController->currentActivity()) {
+        return desktopScreen;
     }
 
     //if the panel views already exist, base upon them
@@ -2011,13 +2256,11 @@ int ShellCorona::screenForContainment(const Plasma::Containment *containment) co
     //won't be associated to a screen
 //     qDebug() << "ShellCorona screenForContainment: " << containment << " Last screen is " << containment->lastScreen();
 
-    for (auto screen : qGuiApp->screens()) {
-        // containment->lastScreen() == m_screenPool->id(screen->name()) to check if the lastScreen refers to a screen that exists/it's known
-        if (containment->lastScreen() == m_screenPool->id(screen->name()) &&
-            (containment->activity() == m_activityController->currentActivity() ||
-            containment->containmentType() == Plasma::Types::PanelContainment || containment->containmentType() == Plasma::Types::CustomPanelContainment)) {
-            return containment->lastScreen();
-        }
+    // the index only knows screens that exist and are in the pool
+    if (m_screenIndex.screen(containment->lastScreen()) &&
+        (containment->activity() == m_activityController->currentActivity() ||
+        containment->containmentType() == Plasma::Types::PanelContainment || containment->containmentType() == Plasma::Types::CustomPanelContainment)) {
+        return containment->lastScreen();
     }
 
     return -1;
@@ -25,6 +25,7 @@
 
 #include "plasma/corona.h"
 
+#include <QElapsedTimer>
 #include <QScopedPointer>
 #include <QSet>
 #include <QTimer>
@@ -33,10 +34,14 @@
 
 #include <KPackage/Package>
 
+#include "screenindex.h"
+
 class DesktopView;
 class PanelView;
+class QJsonObject;
 class QMenu;
 class QScreen;
+class QmlCacheWarmer;
 class ScreenPool;
 class StrutManager;
 
@@ -98,6 +103,12 @@ public:
     QRegion _availableScreenRegion(int id) const;
     QRect _availableScreenRect(int id) const;
 
+    /**
+     * Recomputes the available geometry of all screens after panels or
+     * desktops changed and notifies about the values that actually changed
+     */
+    void updateAvailableScreenGeometry();
+
     Q_INVOKABLE QStringList availableActivities() const;
 
     PanelView *panelView(Plasma::Containment *containment) const;
@@ -159,6 +170,18 @@ public Q_SLOTS:
 
     QByteArray dumpCurrentLayoutJS() const;
 
+    /**
+     * The current layout in the format understood by loadSerializedLayout(),
+     * as compact JSON
+     */
+    QByteArray dumpCurrentLayoutJSON() const;
+
+    /**
+     * Applies a layout dumped by dumpCurrentLayoutJSON() directly,
+     * without generating and evaluating a script for it
+     */
+    void loadSerializedLayout(const QByteArray &layout);
+
     /**
      * loads the shell layout from a look and feel package,
      * resetting it to the default layout exported in the
@@ -234,6 +257,13 @@ private:
     void setupWaylandIntegration();
     void executeSetupPlasmoidScript(Plasma::Containment *containment, Plasma::Applet *applet);
     void checkAllDesktopsUiReady(bool ready);
+    void reportStartupTime(Plasma::Containment *containment, qint64 viewCreationTime);
+    void scheduleQmlCacheWarming();
+    QRegion computeAvailableScreenRegion(DesktopView *view) const;
+    QRect computeAvailableScreenRect(DesktopView *view) const;
+    QJsonObject dumpCurrentLayout() const;
+    void invalidateScreenIndex();
+    void updateScreenIndex() const;
 
 #ifndef NDEBUG
     void screenInvariants() const;
@@ -250,6 +280,9 @@ private:
     //map from screen number to desktop view, qmap as order is important
     QMap<int, DesktopView *> m_desktopViewforId;
     QHash<const Plasma::Containment *, PanelView *> m_panelViews;
+    //available geometry of each screen with a desktop view, see updateAvailableScreenGeometry()
+    QHash<int, QRegion> m_availableScreenRegions;
+    QHash<int, QRect> m_availableScreenRects;
     KConfigGroup m_desktopDefaultsConfig;
     KConfigGroup m_lnfDefaultsConfig;
     QList<Plasma::Containment *> m_waitingPanels;
@@ -261,7 +294,14 @@ private:
     KDeclarative::QmlObjectSharedEngine *m_interactiveConsole;
 
     QTimer m_waitingPanelsTimer;
+    QElapsedTimer m_startupTimer;
+    //set once all desktops were ready for the first time
+    bool m_startupCompleted = false;
     QTimer m_appConfigSyncTimer;
+    int m_coalescedAppConfigSyncs = 0;
+    //lookups derived from m_desktopViewforId, m_panelViews and the screen pool,
+    //rebuilt on first use after any of them changed
+    mutable ScreenIndex m_screenIndex;
     QTimer m_reconsiderOutputsTimer;
 
     KWayland::Client::PlasmaShell *m_waylandPlasmaShell;
@@ -269,6 +309,7 @@ private:
     QString m_testModeLayout;
 
     StrutManager *m_strutManager;
+    QmlCacheWarmer *m_qmlCacheWarmer;
     KUserFeedback::Provider *m_feedbackProvider = nullptr;
 };
 
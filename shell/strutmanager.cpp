@@ -43,6 +43,7 @@ StrutManager::StrutManager(ShellCorona *plasmashellCorona) : QObject(plasmashell
         m_serviceWatcher->removeWatchedService(service);
 
         emit m_plasmashellCorona->availableScreenRectChanged();
+        emit m_plasmashellCorona->availableScreenRegionChanged();
     });
 }
 
@@ -145,10 +145,11 @@ bool FdoSelectionManager::nativeEventFilter(const QByteArray &eventType, void *m
             undock(destroyedWId);
         }
     } else if (responseType == m_damageEventBase + XCB_DAMAGE_NOTIFY) {
-        const auto damagedWId = reinterpret_cast<xcb_damage_notify_event_t *>(ev)->drawable;
+        const auto damageEvent = reinterpret_cast<xcb_damage_notify_event_t *>(ev);
+        const auto damagedWId = damageEvent->drawable;
         const auto sniProxy = m_proxies.value(damagedWId);
         if (sniProxy) {
-            sniProxy->update();
+            sniProxy->scheduleUpdate(QRect(damageEvent->area.x, damageEvent->area.y, damageEvent->area.width, damageEvent->area.height));
             xcb_damage_subtract(QX11Info::connection(), m_damageWatches[damagedWId], XCB_NONE, XCB_NONE);
         }
     } else if (responseType == XCB_CONFIGURE_REQUEST) {
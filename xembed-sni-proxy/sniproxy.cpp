@@ -52,6 +52,7 @@
 
 static uint16_t s_embedSize = 32; //max size of window to embed. We no longer resize the embedded window as Chromium acts stupidly.
 static unsigned int XEMBED_VERSION = 0;
+static const int s_minUpdateInterval = 100; //ms between two captures of an animated icon
 
 int SNIProxy::s_serviceCount = 0;
 
@@ -80,6 +81,7 @@ SNIProxy::SNIProxy(xcb_window_t wid, QObject* parent):
     //instead lets use one DBus connection per SNI
     m_dbus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy%1").arg(s_serviceCount++))),
     m_windowId(wid),
+    m_imageHash(0),
     sendingClickEvent(false),
     m_injectMode(Direct)
 {
@@ -186,6 +188,9 @@ SNIProxy::SNIProxy(xcb_window_t wid, QObject* parent):
         m_injectMode = XTest;
     }
 
+    m_updateTimer.setSingleShot(true);
+    connect(&m_updateTimer, &QTimer::timeout, this, &SNIProxy::update);
+
     //there's no damage event for the first paint, and sometimes it's not drawn immediately
     //not ideal, but it works better than nothing
     //test with xchat before changing
@@ -200,8 +205,25 @@ SNIProxy::~SNIProxy()
     QDBusConnection::disconnectFromBus(m_dbus.name());
 }
 
+void SNIProxy::scheduleUpdate(const QRect &damage)
+{
+    //until the first capture we don't know which area is shown
+    if (!m_captureSize.isEmpty() && !damage.intersects(QRect(QPoint(0, 0), m_captureSize))) {
+        return;
+    }
+
+    if (m_updateTimer.isActive()) {
+        return;
+    }
+    const qint64 sinceLastUpdate = m_lastUpdate.isValid() ? m_lastUpdate.elapsed() : s_minUpdateInterval;
+    m_updateTimer.start(qMax<qint64>(0, s_minUpdateInterval - sinceLastUpdate));
+}
+
 void SNIProxy::update()
 {
+    m_updateTimer.stop();
+    m_lastUpdate.start();
+
     const QImage image = getImageNonComposite();
     if (image.isNull()) {
         qCDebug(SNIPROXY) << "No xembed icon for" << m_windowId << Title();
@@ -210,6 +232,14 @@ void SNIProxy::update()
 
     int w = image.width();
     int h = image.height();
+    m_captureSize = image.size();
+
+    //animated icons often repaint without changing anything visible
+    const uint imageHash = qHashBits(image.constBits(), image.sizeInBytes(), qHash(w) ^ qHash(h << 16) ^ image.format());
+    if (!m_pixmap.isNull() && imageHash == m_imageHash) {
+        return;
+    }
+    m_imageHash = imageHash;
 
     m_pixmap = QPixmap::fromImage(image);
     if (w > s_embedSize || h > s_embedSize) {
@@ -283,15 +313,30 @@ bool SNIProxy::isTransparentImage(const QImage& image) const
     if (! (qAlpha(image.pixel(w >> 1, h >> 1)) + qAlpha(image.pixel(w >> 2, h >> 2)) == 0))
         return false;
 
-    // skip scan altogether if sub-center pixel found to be opaque
-    // and break out from the outer loop too on full scan
-    for (int x = 0; x < w; ++x) {
+    if (image.format() != QImage::Format_ARGB32 && image.format() != QImage::Format_ARGB32_Premultiplied) {
         for (int y = 0; y < h; ++y) {
-            if (qAlpha(image.pixel(x, y))) {
-                // Found an opaque pixel.
-                return false;
+            for (int x = 0; x < w; ++x) {
+                if (qAlpha(image.pixel(x, y))) {
+                    // Found an opaque pixel.
+                    return false;
+                }
             }
         }
+        return true;
+    }
+
+    // scan row by row, or-ing the pixels of a line together lets the
+    // compiler vectorize the inner loop
+    for (int y = 0; y < h; ++y) {
+        const quint32 *line = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        quint32 alpha = 0;
+        for (int x = 0; x < w; ++x) {
+            alpha |= line[x];
+        }
+        if (alpha & 0xff000000) {
+            // Found an opaque pixel.
+            return false;
+        }
     }
 
     return true;
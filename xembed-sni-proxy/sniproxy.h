@@ -26,8 +26,11 @@
 #include <QDBusArgument>
 #include <QDBusConnection>
 #include <QDBusObjectPath>
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <QPoint>
+#include <QRect>
+#include <QTimer>
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_image.h>
@@ -50,6 +53,12 @@ public:
     ~SNIProxy() override;
 
     void update();
+    /**
+     * Schedules an update for the damaged area of the embedded window.
+     * Damage outside of the captured area is ignored and updates are
+     * throttled to a few frames per second.
+     */
+    void scheduleUpdate(const QRect &damage);
     void resizeWindow(const uint16_t width, const uint16_t height) const;
     void hideContainerWindow(xcb_window_t windowId) const;
 
@@ -162,6 +171,10 @@ private:
     xcb_window_t m_containerWid;
     static int s_serviceCount;
     QPixmap m_pixmap;
+    QSize m_captureSize;
+    uint m_imageHash;
+    QTimer m_updateTimer;
+    QElapsedTimer m_lastUpdate;
     bool sendingClickEvent;
     InjectMode m_injectMode;
 };